@@ -39,6 +39,9 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
 
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/b2Distance.h>
@@ -48,8 +51,12 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
+#include <Box2D/Dynamics/b2ContactEvents.h>
+#include <Box2D/Dynamics/b2CommandBuffer.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2WorldPool.h>
+#include <Box2D/Dynamics/b2ForceField.h>
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 
@@ -65,4 +72,7 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Dynamics/Joints/b2WeldJoint.h>
 #include <Box2D/Dynamics/Joints/b2WheelJoint.h>
 
+#include <Box2D/Rope/b2Rope.h>
+#include <Box2D/Particle/b2ParticleSystem.h>
+
 #endif
@@ -0,0 +1,158 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <new>
+
+b2Shape* b2BoxShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2BoxShape));
+	b2BoxShape* clone = new (mem) b2BoxShape;
+	*clone = *this;
+	return clone;
+}
+
+int32 b2BoxShape::GetChildCount() const
+{
+	return 1;
+}
+
+void b2BoxShape::SetAsBox(float32 hx, float32 hy)
+{
+	m_center.SetZero();
+	m_extents.Set(hx, hy);
+}
+
+void b2BoxShape::SetAsBox(float32 hx, float32 hy, const b2Vec2& center)
+{
+	m_center = center;
+	m_extents.Set(hx, hy);
+}
+
+bool b2BoxShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	b2Vec2 d = b2MulT(xf, p) - m_center;
+	return b2Abs(d.x) <= m_extents.x && b2Abs(d.y) <= m_extents.y;
+}
+
+// Slab test in the frame of the box.
+bool b2BoxShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+								const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	b2Vec2 p1 = b2MulT(xf.q, input.p1 - xf.p) - m_center;
+	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p) - m_center;
+	b2Vec2 d = p2 - p1;
+
+	float32 lower = 0.0f, upper = input.maxFraction;
+
+	int32 index = -1;
+	float32 sign = 0.0f;
+
+	for (int32 i = 0; i < 2; ++i)
+	{
+		float32 extent = m_extents(i);
+
+		if (d(i) == 0.0f)
+		{
+			if (p1(i) < -extent || extent < p1(i))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			// t1 is where the ray enters the slab and t2 is where it leaves.
+			float32 inv_d = 1.0f / d(i);
+			float32 t1 = (-extent - p1(i)) * inv_d;
+			float32 t2 = (extent - p1(i)) * inv_d;
+			float32 s = -1.0f;
+
+			if (t1 > t2)
+			{
+				b2Swap(t1, t2);
+				s = 1.0f;
+			}
+
+			if (t1 > lower)
+			{
+				lower = t1;
+				index = i;
+				sign = s;
+			}
+
+			upper = b2Min(upper, t2);
+
+			if (upper < lower)
+			{
+				return false;
+			}
+		}
+	}
+
+	// A ray starting inside the box does not hit it.
+	if (index >= 0)
+	{
+		b2Vec2 normal(0.0f, 0.0f);
+		normal(index) = sign;
+		output->fraction = lower;
+		output->normal = b2Mul(xf.q, normal);
+		return true;
+	}
+
+	return false;
+}
+
+void b2BoxShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	b2Vec2 center = b2Mul(xf, m_center);
+	float32 c = b2Abs(xf.q.c), s = b2Abs(xf.q.s);
+	b2Vec2 r;
+	r.x = c * m_extents.x + s * m_extents.y + m_radius;
+	r.y = s * m_extents.x + c * m_extents.y + m_radius;
+
+	aabb->lowerBound = center - r;
+	aabb->upperBound = center + r;
+}
+
+void b2BoxShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	// Like b2PolygonShape, the skin radius does not contribute mass.
+	float32 hx = m_extents.x, hy = m_extents.y;
+	massData->mass = density * 4.0f * hx * hy;
+	massData->center = m_center;
+
+	// Inertia about the center is m * (w^2 + h^2) / 12. Shift it to the body origin.
+	massData->I = massData->mass * ((hx * hx + hy * hy) / 3.0f + b2Dot(m_center, m_center));
+}
+
+void b2BoxShape::ComputePolygon(b2PolygonShape* polygon) const
+{
+	polygon->m_radius = m_radius;
+	polygon->m_count = 4;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		polygon->m_vertices[i] = GetVertex(i);
+		polygon->m_normals[i] = GetNormal(i);
+	}
+	polygon->m_centroid = m_center;
+}
@@ -0,0 +1,114 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BOX_SHAPE_H
+#define B2_BOX_SHAPE_H
+
+#include <Box2D/Collision/Shapes/b2Shape.h>
+
+class b2PolygonShape;
+
+/// A box that is aligned with the body frame. Only the center and the
+/// half-extents are stored, so this is much smaller than a b2PolygonShape
+/// built with SetAsBox and it uses dedicated collision routines.
+/// Use b2PolygonShape if the box must be rotated relative to the body.
+class b2BoxShape : public b2Shape
+{
+public:
+	b2BoxShape();
+
+	/// Implement b2Shape.
+	b2Shape* Clone(b2BlockAllocator* allocator) const;
+
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const;
+
+	/// Build a box centered on the local origin.
+	/// @param hx the half-width.
+	/// @param hy the half-height.
+	void SetAsBox(float32 hx, float32 hy);
+
+	/// Build a box with an offset center.
+	/// @param hx the half-width.
+	/// @param hy the half-height.
+	/// @param center the center of the box in local coordinates.
+	void SetAsBox(float32 hx, float32 hy, const b2Vec2& center);
+
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const;
+
+	/// Implement b2Shape.
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// Get the vertex count.
+	int32 GetVertexCount() const { return 4; }
+
+	/// Get a vertex by index. The winding matches b2PolygonShape::SetAsBox.
+	b2Vec2 GetVertex(int32 index) const;
+
+	/// Get the normal of the face that starts at the given vertex.
+	b2Vec2 GetNormal(int32 index) const;
+
+	/// Build the equivalent polygon. This is used to collide against shapes
+	/// that have no dedicated box routine.
+	void ComputePolygon(b2PolygonShape* polygon) const;
+
+	b2Vec2 m_center;
+	b2Vec2 m_extents;
+};
+
+inline b2BoxShape::b2BoxShape()
+{
+	m_type = e_box;
+	m_radius = b2_polygonRadius;
+	m_center.SetZero();
+	m_extents.SetZero();
+}
+
+inline b2Vec2 b2BoxShape::GetVertex(int32 index) const
+{
+	b2Assert(0 <= index && index < 4);
+	float32 x = (index == 1 || index == 2) ? m_extents.x : -m_extents.x;
+	float32 y = index < 2 ? -m_extents.y : m_extents.y;
+	return b2Vec2(m_center.x + x, m_center.y + y);
+}
+
+inline b2Vec2 b2BoxShape::GetNormal(int32 index) const
+{
+	b2Assert(0 <= index && index < 4);
+	switch (index)
+	{
+	case 0:
+		return b2Vec2(0.0f, -1.0f);
+	case 1:
+		return b2Vec2(1.0f, 0.0f);
+	case 2:
+		return b2Vec2(0.0f, 1.0f);
+	default:
+		return b2Vec2(-1.0f, 0.0f);
+	}
+}
+
+#endif
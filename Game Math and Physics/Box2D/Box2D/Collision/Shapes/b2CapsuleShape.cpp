@@ -0,0 +1,213 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <new>
+
+void b2CapsuleShape::Set(const b2Vec2& v1, const b2Vec2& v2, float32 radius)
+{
+	m_vertex1 = v1;
+	m_vertex2 = v2;
+	m_radius = radius;
+}
+
+b2Shape* b2CapsuleShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CapsuleShape));
+	b2CapsuleShape* clone = new (mem) b2CapsuleShape;
+	*clone = *this;
+	return clone;
+}
+
+int32 b2CapsuleShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool b2CapsuleShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	b2Vec2 q = b2MulT(xf, p);
+	b2Vec2 e = m_vertex2 - m_vertex1;
+	b2Vec2 d = q - m_vertex1;
+
+	float32 ee = b2Dot(e, e);
+	if (ee > 0.0f)
+	{
+		float32 s = b2Clamp(b2Dot(d, e) / ee, 0.0f, 1.0f);
+		d -= s * e;
+	}
+
+	return b2Dot(d, d) <= m_radius * m_radius;
+}
+
+// Ray versus one of the end circles. Only hits where the ray enters the circle count.
+static bool b2RayCastCircle(float32* fraction, b2Vec2* normal,
+							const b2Vec2& p1, const b2Vec2& d, float32 maxFraction,
+							const b2Vec2& center, float32 radius)
+{
+	b2Vec2 s = p1 - center;
+	float32 b = b2Dot(s, s) - radius * radius;
+	float32 c = b2Dot(s, d);
+	float32 rr = b2Dot(d, d);
+	float32 sigma = c * c - rr * b;
+
+	if (sigma < 0.0f || rr < b2_epsilon)
+	{
+		return false;
+	}
+
+	float32 a = -(c + b2Sqrt(sigma));
+	if (0.0f <= a && a <= maxFraction * rr)
+	{
+		a /= rr;
+		*fraction = a;
+		*normal = s + a * d;
+		normal->Normalize();
+		return true;
+	}
+
+	return false;
+}
+
+// The capsule is the union of the two end circles and the rectangle swept by
+// the segment. A ray that starts outside first enters through a circle or
+// through one of the two long sides, so the closest of those hits is the answer.
+bool b2CapsuleShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							 const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Put the ray into the capsule's frame of reference.
+	b2Vec2 p1 = b2MulT(xf.q, input.p1 - xf.p);
+	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p);
+	b2Vec2 d = p2 - p1;
+
+	b2Vec2 v1 = m_vertex1;
+	b2Vec2 e = m_vertex2 - v1;
+	float32 length = e.Normalize();
+
+	// A ray starting inside the capsule does not hit it.
+	{
+		b2Vec2 q = p1 - v1;
+		float32 s = b2Clamp(b2Dot(q, e), 0.0f, length);
+		b2Vec2 r = q - s * e;
+		if (b2Dot(r, r) <= m_radius * m_radius)
+		{
+			return false;
+		}
+	}
+
+	bool hit = false;
+	float32 bestFraction = input.maxFraction;
+	b2Vec2 bestNormal;
+
+	float32 fraction;
+	b2Vec2 normal;
+	if (b2RayCastCircle(&fraction, &normal, p1, d, bestFraction, v1, m_radius))
+	{
+		hit = true;
+		bestFraction = fraction;
+		bestNormal = normal;
+	}
+
+	if (length > 0.0f)
+	{
+		if (b2RayCastCircle(&fraction, &normal, p1, d, bestFraction, m_vertex2, m_radius))
+		{
+			hit = true;
+			bestFraction = fraction;
+			bestNormal = normal;
+		}
+
+		// The two sides of the rectangle.
+		b2Vec2 n = b2Cross(e, 1.0f);
+		for (int32 i = 0; i < 2; ++i)
+		{
+			float32 numerator = m_radius - b2Dot(n, p1 - v1);
+			float32 denominator = b2Dot(n, d);
+
+			// The ray must start outside the side and move towards it.
+			if (numerator < 0.0f && denominator < 0.0f)
+			{
+				fraction = numerator / denominator;
+				if (fraction <= bestFraction)
+				{
+					float32 s = b2Dot(p1 + fraction * d - v1, e);
+					if (0.0f <= s && s <= length)
+					{
+						hit = true;
+						bestFraction = fraction;
+						bestNormal = n;
+					}
+				}
+			}
+
+			n = -n;
+		}
+	}
+
+	if (hit)
+	{
+		output->fraction = bestFraction;
+		output->normal = b2Mul(xf.q, bestNormal);
+		return true;
+	}
+
+	return false;
+}
+
+void b2CapsuleShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	b2Vec2 v1 = b2Mul(xf, m_vertex1);
+	b2Vec2 v2 = b2Mul(xf, m_vertex2);
+
+	b2Vec2 lower = b2Min(v1, v2);
+	b2Vec2 upper = b2Max(v1, v2);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = lower - r;
+	aabb->upperBound = upper + r;
+}
+
+// The capsule is a rectangle plus two half circles.
+void b2CapsuleShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	float32 radius = m_radius;
+	float32 rr = radius * radius;
+	float32 length = b2Distance(m_vertex1, m_vertex2);
+	float32 ll = length * length;
+
+	float32 circleMass = density * b2_pi * rr;
+	float32 boxMass = density * 2.0f * radius * length;
+
+	massData->mass = circleMass + boxMass;
+	massData->center = 0.5f * (m_vertex1 + m_vertex2);
+
+	// Each half circle has its centroid lc beyond the segment end. Its inertia
+	// about the capsule center follows from the parallel axis theorem.
+	float32 lc = 4.0f * radius / (3.0f * b2_pi);
+	float32 h = 0.5f * length;
+
+	float32 circleInertia = circleMass * (0.5f * rr + h * h + 2.0f * h * lc);
+	float32 boxInertia = boxMass * (4.0f * rr + ll) / 12.0f;
+
+	// Shift to the body origin.
+	massData->I = circleInertia + boxInertia + massData->mass * b2Dot(massData->center, massData->center);
+}
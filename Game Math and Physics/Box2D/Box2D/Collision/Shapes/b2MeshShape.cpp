@@ -0,0 +1,396 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <new>
+#include <memory.h>
+#include <algorithm>
+
+// Orders segments by the coordinate of their centers along one axis.
+struct b2MeshSegmentOrder
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		return centers[a](axis) < centers[b](axis);
+	}
+
+	const b2Vec2* centers;
+	int32 axis;
+};
+
+// Build the subtree over a range of segments and return its node. Nodes are
+// stored in pre-order so the root lands at index zero.
+static int32 b2BuildMeshNode(b2MeshNode* nodes, int32* nodeCount, int32* segments, int32 count,
+							const b2AABB* aabbs, const b2Vec2* centers)
+{
+	int32 nodeId = *nodeCount;
+	++(*nodeCount);
+
+	if (count == 1)
+	{
+		nodes[nodeId].aabb = aabbs[segments[0]];
+		nodes[nodeId].child1 = -1;
+		nodes[nodeId].child2 = segments[0];
+		return nodeId;
+	}
+
+	// Split at the median along the longest extent of the segment centers.
+	b2Vec2 lower = centers[segments[0]];
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		lower = b2Min(lower, centers[segments[i]]);
+		upper = b2Max(upper, centers[segments[i]]);
+	}
+
+	b2MeshSegmentOrder order;
+	order.centers = centers;
+	order.axis = upper.x - lower.x > upper.y - lower.y ? 0 : 1;
+
+	int32 half = count / 2;
+	std::nth_element(segments, segments + half, segments + count, order);
+
+	int32 child1 = b2BuildMeshNode(nodes, nodeCount, segments, half, aabbs, centers);
+	int32 child2 = b2BuildMeshNode(nodes, nodeCount, segments + half, count - half, aabbs, centers);
+
+	nodes[nodeId].aabb.Combine(nodes[child1].aabb, nodes[child2].aabb);
+	nodes[nodeId].child1 = child1;
+	nodes[nodeId].child2 = child2;
+	return nodeId;
+}
+
+b2MeshShape::~b2MeshShape()
+{
+	b2Free(m_vertices);
+	b2Free(m_indices);
+	b2Free(m_adjacency);
+	b2Free(m_nodes);
+	m_vertices = NULL;
+	m_indices = NULL;
+	m_adjacency = NULL;
+	m_nodes = NULL;
+	m_vertexCount = 0;
+	m_segmentCount = 0;
+	m_nodeCount = 0;
+}
+
+void b2MeshShape::Create(const b2Vec2* vertices, int32 vertexCount, const int32* indices, int32 segmentCount)
+{
+	b2Assert(m_vertices == NULL && m_segmentCount == 0);
+	b2Assert(vertexCount >= 2 && segmentCount >= 1);
+	for (int32 i = 0; i < segmentCount; ++i)
+	{
+		int32 i1 = indices[2 * i + 0];
+		int32 i2 = indices[2 * i + 1];
+		b2Assert(0 <= i1 && i1 < vertexCount && 0 <= i2 && i2 < vertexCount);
+		// If the code crashes here, it means your vertices are too close together.
+		b2Assert(b2DistanceSquared(vertices[i1], vertices[i2]) > b2_linearSlop * b2_linearSlop);
+	}
+
+	m_vertexCount = vertexCount;
+	m_vertices = (b2Vec2*)b2Alloc(vertexCount * sizeof(b2Vec2));
+	memcpy(m_vertices, vertices, vertexCount * sizeof(b2Vec2));
+
+	m_segmentCount = segmentCount;
+	m_indices = (int32*)b2Alloc(2 * segmentCount * sizeof(int32));
+	memcpy(m_indices, indices, 2 * segmentCount * sizeof(int32));
+
+	// Connect segments through vertices that are shared by exactly two segments.
+	int32* degree = (int32*)b2Alloc(3 * vertexCount * sizeof(int32));
+	int32* first = degree + vertexCount;
+	int32* second = first + vertexCount;
+	memset(degree, 0, vertexCount * sizeof(int32));
+	for (int32 i = 0; i < 2 * segmentCount; ++i)
+	{
+		int32 v = m_indices[i];
+		if (degree[v] == 0)
+		{
+			first[v] = i / 2;
+		}
+		else if (degree[v] == 1)
+		{
+			second[v] = i / 2;
+		}
+		++degree[v];
+	}
+
+	m_adjacency = (int32*)b2Alloc(2 * segmentCount * sizeof(int32));
+	for (int32 i = 0; i < 2 * segmentCount; ++i)
+	{
+		int32 v = m_indices[i];
+		if (degree[v] != 2)
+		{
+			m_adjacency[i] = -1;
+			continue;
+		}
+
+		int32 other = first[v] == i / 2 ? second[v] : first[v];
+		m_adjacency[i] = m_indices[2 * other] == v ? m_indices[2 * other + 1] : m_indices[2 * other];
+	}
+	b2Free(degree);
+
+	// Build the hierarchy over the segment bounds.
+	b2AABB* aabbs = (b2AABB*)b2Alloc(segmentCount * sizeof(b2AABB));
+	b2Vec2* centers = (b2Vec2*)b2Alloc(segmentCount * sizeof(b2Vec2));
+	int32* segments = (int32*)b2Alloc(segmentCount * sizeof(int32));
+
+	b2Transform identity;
+	identity.SetIdentity();
+	for (int32 i = 0; i < segmentCount; ++i)
+	{
+		ComputeSegmentAABB(aabbs + i, identity, i);
+		centers[i] = aabbs[i].GetCenter();
+		segments[i] = i;
+	}
+
+	m_nodes = (b2MeshNode*)b2Alloc((2 * segmentCount - 1) * sizeof(b2MeshNode));
+	m_nodeCount = 0;
+	b2BuildMeshNode(m_nodes, &m_nodeCount, segments, segmentCount, aabbs, centers);
+	b2Assert(m_nodeCount == 2 * segmentCount - 1);
+
+	b2Free(segments);
+	b2Free(centers);
+	b2Free(aabbs);
+}
+
+void b2MeshShape::CreateChain(const b2Vec2* vertices, int32 count)
+{
+	b2Assert(count >= 2);
+	int32* indices = (int32*)b2Alloc(2 * (count - 1) * sizeof(int32));
+	for (int32 i = 0; i < count - 1; ++i)
+	{
+		indices[2 * i + 0] = i;
+		indices[2 * i + 1] = i + 1;
+	}
+
+	Create(vertices, count, indices, count - 1);
+	b2Free(indices);
+}
+
+void b2MeshShape::CreateLoop(const b2Vec2* vertices, int32 count)
+{
+	b2Assert(count >= 3);
+	int32* indices = (int32*)b2Alloc(2 * count * sizeof(int32));
+	for (int32 i = 0; i < count; ++i)
+	{
+		indices[2 * i + 0] = i;
+		indices[2 * i + 1] = i + 1 < count ? i + 1 : 0;
+	}
+
+	Create(vertices, count, indices, count);
+	b2Free(indices);
+}
+
+b2Shape* b2MeshShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2MeshShape));
+	b2MeshShape* clone = new (mem) b2MeshShape;
+	clone->m_radius = m_radius;
+
+	// Copy the hierarchy rather than rebuilding it.
+	clone->m_vertexCount = m_vertexCount;
+	clone->m_vertices = (b2Vec2*)b2Alloc(m_vertexCount * sizeof(b2Vec2));
+	memcpy(clone->m_vertices, m_vertices, m_vertexCount * sizeof(b2Vec2));
+
+	clone->m_segmentCount = m_segmentCount;
+	clone->m_indices = (int32*)b2Alloc(2 * m_segmentCount * sizeof(int32));
+	memcpy(clone->m_indices, m_indices, 2 * m_segmentCount * sizeof(int32));
+	clone->m_adjacency = (int32*)b2Alloc(2 * m_segmentCount * sizeof(int32));
+	memcpy(clone->m_adjacency, m_adjacency, 2 * m_segmentCount * sizeof(int32));
+
+	clone->m_nodeCount = m_nodeCount;
+	clone->m_nodes = (b2MeshNode*)b2Alloc(m_nodeCount * sizeof(b2MeshNode));
+	memcpy(clone->m_nodes, m_nodes, m_nodeCount * sizeof(b2MeshNode));
+	return clone;
+}
+
+int32 b2MeshShape::GetChildCount() const
+{
+	return 1;
+}
+
+void b2MeshShape::GetChildEdge(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(0 <= index && index < m_segmentCount);
+	edge->m_type = b2Shape::e_edge;
+	edge->m_radius = m_radius;
+
+	edge->m_vertex1 = m_vertices[m_indices[2 * index + 0]];
+	edge->m_vertex2 = m_vertices[m_indices[2 * index + 1]];
+
+	int32 i0 = m_adjacency[2 * index + 0];
+	if (i0 != -1)
+	{
+		edge->m_vertex0 = m_vertices[i0];
+		edge->m_hasVertex0 = true;
+	}
+	else
+	{
+		edge->m_vertex0.SetZero();
+		edge->m_hasVertex0 = false;
+	}
+
+	int32 i3 = m_adjacency[2 * index + 1];
+	if (i3 != -1)
+	{
+		edge->m_vertex3 = m_vertices[i3];
+		edge->m_hasVertex3 = true;
+	}
+	else
+	{
+		edge->m_vertex3.SetZero();
+		edge->m_hasVertex3 = false;
+	}
+}
+
+void b2MeshShape::ComputeSegmentAABB(b2AABB* aabb, const b2Transform& xf, int32 index) const
+{
+	b2Assert(0 <= index && index < m_segmentCount);
+
+	b2Vec2 v1 = b2Mul(xf, m_vertices[m_indices[2 * index + 0]]);
+	b2Vec2 v2 = b2Mul(xf, m_vertices[m_indices[2 * index + 1]]);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = b2Min(v1, v2) - r;
+	aabb->upperBound = b2Max(v1, v2) + r;
+}
+
+bool b2MeshShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	B2_NOT_USED(xf);
+	B2_NOT_USED(p);
+	return false;
+}
+
+bool b2MeshShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	if (m_nodeCount == 0)
+	{
+		return false;
+	}
+
+	// Cast in the mesh frame.
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 p2 = b2MulT(xf, input.p2);
+	b2Vec2 r = p2 - p1;
+	if (r.LengthSquared() == 0.0f)
+	{
+		return false;
+	}
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	v.Normalize();
+	b2Vec2 abs_v = b2Abs(v);
+
+	b2Transform identity;
+	identity.SetIdentity();
+
+	b2RayCastInput subInput;
+	subInput.p1 = p1;
+	subInput.p2 = p2;
+	subInput.maxFraction = input.maxFraction;
+
+	b2AABB segmentAABB;
+	{
+		b2Vec2 t = p1 + subInput.maxFraction * r;
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+	}
+
+	bool hit = false;
+	b2EdgeShape edge;
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		const b2MeshNode* node = m_nodes + stack.Pop();
+
+		if (b2TestOverlap(node->aabb, segmentAABB) == false)
+		{
+			continue;
+		}
+
+		// Separating axis for segment (Gino, p80).
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents();
+		float32 separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf())
+		{
+			edge.m_vertex1 = m_vertices[m_indices[2 * node->child2 + 0]];
+			edge.m_vertex2 = m_vertices[m_indices[2 * node->child2 + 1]];
+
+			b2RayCastOutput subOutput;
+			if (edge.RayCast(&subOutput, subInput, identity, 0))
+			{
+				// Keep the closest hit and shrink the ray.
+				hit = true;
+				output->fraction = subOutput.fraction;
+				output->normal = b2Mul(xf.q, subOutput.normal);
+
+				subInput.maxFraction = subOutput.fraction;
+				b2Vec2 t = p1 + subInput.maxFraction * r;
+				segmentAABB.lowerBound = b2Min(p1, t);
+				segmentAABB.upperBound = b2Max(p1, t);
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+
+	return hit;
+}
+
+void b2MeshShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+	b2Assert(m_nodeCount > 0);
+
+	// Rotate the bounds of the root.
+	b2Vec2 center = b2Mul(xf, m_nodes[0].aabb.GetCenter());
+	b2Vec2 h = m_nodes[0].aabb.GetExtents();
+	b2Vec2 r;
+	r.x = b2Abs(xf.q.c) * h.x + b2Abs(xf.q.s) * h.y;
+	r.y = b2Abs(xf.q.s) * h.x + b2Abs(xf.q.c) * h.y;
+
+	aabb->lowerBound = center - r;
+	aabb->upperBound = center + r;
+}
+
+void b2MeshShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
@@ -0,0 +1,184 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_MESH_SHAPE_H
+#define B2_MESH_SHAPE_H
+
+#include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Common/b2GrowableStack.h>
+
+class b2EdgeShape;
+
+/// A node in the bounding volume hierarchy of a mesh. Leaves hold one segment.
+struct b2MeshNode
+{
+	bool IsLeaf() const
+	{
+		return child1 == -1;
+	}
+
+	/// The bounds of all segments below this node, in the mesh frame.
+	b2AABB aabb;
+
+	/// The first child, or -1 for a leaf.
+	int32 child1;
+
+	/// The second child, or the segment index for a leaf.
+	int32 child2;
+};
+
+/// A mesh is a static soup of line segments for large terrains. Unlike a chain,
+/// the whole mesh uses a single broad-phase proxy. The contact manager queries
+/// the internal bounding volume hierarchy to create contacts only for the
+/// segments that touch other fixtures, so the proxy count does not grow with
+/// terrain detail.
+/// Segments that share a vertex index with exactly one other segment are
+/// connected for smooth collision, like the vertices of a chain.
+/// Since there may be many segments, memory is allocated using b2Alloc.
+/// WARNING: meshes are meant for static bodies and have zero mass.
+class b2MeshShape : public b2Shape
+{
+public:
+	b2MeshShape();
+
+	/// The destructor frees the mesh using b2Free.
+	~b2MeshShape();
+
+	/// Create a mesh from indexed segments.
+	/// @param vertices an array of vertices, these are copied
+	/// @param vertexCount the vertex count
+	/// @param indices two vertex indices per segment, these are copied
+	/// @param segmentCount the segment count
+	void Create(const b2Vec2* vertices, int32 vertexCount, const int32* indices, int32 segmentCount);
+
+	/// Create a mesh from an open polyline.
+	/// @param vertices an array of vertices, these are copied
+	/// @param count the vertex count
+	void CreateChain(const b2Vec2* vertices, int32 count);
+
+	/// Create a mesh from a closed polyline. This automatically adjusts connectivity.
+	/// @param vertices an array of vertices, these are copied
+	/// @param count the vertex count
+	void CreateLoop(const b2Vec2* vertices, int32 count);
+
+	/// Implement b2Shape. The mesh is cloned using b2Alloc.
+	b2Shape* Clone(b2BlockAllocator* allocator) const;
+
+	/// A mesh has one child that covers all segments.
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const;
+
+	/// Get the number of segments.
+	int32 GetSegmentCount() const;
+
+	/// Get a segment as an edge with its connectivity.
+	void GetChildEdge(b2EdgeShape* edge, int32 index) const;
+
+	/// Compute the bounding box of a single segment.
+	void ComputeSegmentAABB(b2AABB* aabb, const b2Transform& transform, int32 index) const;
+
+	/// Query the segments that potentially overlap the provided AABB, given in the mesh frame.
+	/// The callback receives the segment index.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// This always return false.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const;
+
+	/// Cast a ray against the whole mesh and report the closest segment hit.
+	/// @see b2Shape::RayCast
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const;
+
+	/// Meshes have zero mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// The vertices. Owned by this class.
+	b2Vec2* m_vertices;
+	int32 m_vertexCount;
+
+	/// Two vertex indices per segment. Owned by this class.
+	int32* m_indices;
+
+	/// The vertex preceding and the vertex following each segment, or -1. Owned by this class.
+	int32* m_adjacency;
+	int32 m_segmentCount;
+
+	/// The hierarchy with the root at index zero. Owned by this class.
+	b2MeshNode* m_nodes;
+	int32 m_nodeCount;
+};
+
+inline b2MeshShape::b2MeshShape()
+{
+	m_type = e_mesh;
+	m_radius = b2_polygonRadius;
+	m_vertices = NULL;
+	m_vertexCount = 0;
+	m_indices = NULL;
+	m_adjacency = NULL;
+	m_segmentCount = 0;
+	m_nodes = NULL;
+	m_nodeCount = 0;
+}
+
+inline int32 b2MeshShape::GetSegmentCount() const
+{
+	return m_segmentCount;
+}
+
+template <typename T>
+inline void b2MeshShape::Query(T* callback, const b2AABB& aabb) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		const b2MeshNode* node = m_nodes + stack.Pop();
+
+		if (b2TestOverlap(node->aabb, aabb))
+		{
+			if (node->IsLeaf())
+			{
+				bool proceed = callback->QueryCallback(node->child2);
+				if (proceed == false)
+				{
+					return;
+				}
+			}
+			else
+			{
+				stack.Push(node->child1);
+				stack.Push(node->child2);
+			}
+		}
+	}
+}
+
+#endif
@@ -49,7 +49,10 @@ public:
 		e_edge = 1,
 		e_polygon = 2,
 		e_chain = 3,
-		e_typeCount = 4
+		e_box = 4,
+		e_capsule = 5,
+		e_mesh = 6,
+		e_typeCount = 7
 	};
 
 	virtual ~b2Shape() {}
@@ -17,10 +17,15 @@
 */
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <algorithm>
 
 b2BroadPhase::b2BroadPhase()
 {
 	m_proxyCount = 0;
+	m_staticProxyCount = 0;
+	m_staticInsertCount = 0;
+
+	m_pairFiltering = true;
 
 	m_pairCapacity = 16;
 	m_pairCount = 0;
@@ -37,9 +42,20 @@ b2BroadPhase::~b2BroadPhase()
 	b2Free(m_pairBuffer);
 }
 
-int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
+int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData, bool staticProxy, const b2Filter& filter)
 {
-	int32 proxyId = m_tree.CreateProxy(aabb, userData);
+	int32 proxyId;
+	if (staticProxy)
+	{
+		proxyId = GetProxyId(m_staticTree.CreateProxy(aabb, userData, filter), true);
+		++m_staticProxyCount;
+		++m_staticInsertCount;
+	}
+	else
+	{
+		proxyId = GetProxyId(m_tree.CreateProxy(aabb, userData, filter), false);
+	}
+
 	++m_proxyCount;
 	BufferMove(proxyId);
 	return proxyId;
@@ -49,18 +65,195 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
 	--m_proxyCount;
-	m_tree.DestroyProxy(proxyId);
+	if (IsStaticProxy(proxyId))
+	{
+		--m_staticProxyCount;
+		m_staticTree.DestroyProxy(GetNodeId(proxyId));
+	}
+	else
+	{
+		m_tree.DestroyProxy(GetNodeId(proxyId));
+	}
+}
+
+void b2BroadPhase::CreateProxies(const b2AABB* aabbs, void* const* userData, const b2Filter* filters,
+								 int32 count, bool staticProxies, int32* proxyIds)
+{
+	if (staticProxies)
+	{
+		// The static tree is already rebuilt after a batch of insertions.
+		for (int32 i = 0; i < count; ++i)
+		{
+			proxyIds[i] = m_staticTree.CreateProxy(aabbs[i], userData[i], filters[i]);
+		}
+		m_staticProxyCount += count;
+		m_staticInsertCount += count;
+	}
+	else
+	{
+		m_tree.CreateProxies(aabbs, userData, filters, count, proxyIds);
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		proxyIds[i] = GetProxyId(proxyIds[i], staticProxies);
+		BufferMove(proxyIds[i]);
+	}
+
+	m_proxyCount += count;
+}
+
+void b2BroadPhase::DestroyProxies(const int32* proxyIds, int32 count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Sort the ids so the move buffer can be cleaned in one pass.
+	int32* ids = (int32*)b2Alloc(count * sizeof(int32));
+	int32 staticCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		ids[i] = proxyIds[i];
+		if (IsStaticProxy(ids[i]))
+		{
+			++staticCount;
+		}
+	}
+	std::sort(ids, ids + count);
+
+	for (int32 i = 0; i < m_moveCount; ++i)
+	{
+		if (m_moveBuffer[i] != e_nullProxy && std::binary_search(ids, ids + count, m_moveBuffer[i]))
+		{
+			m_moveBuffer[i] = e_nullProxy;
+		}
+	}
+
+	// Split the node ids by tree.
+	int32* nodeIds = (int32*)b2Alloc(count * sizeof(int32));
+	int32 staticIndex = 0;
+	int32 dynamicIndex = staticCount;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (IsStaticProxy(ids[i]))
+		{
+			nodeIds[staticIndex++] = GetNodeId(ids[i]);
+		}
+		else
+		{
+			nodeIds[dynamicIndex++] = GetNodeId(ids[i]);
+		}
+	}
+
+	m_staticTree.DestroyProxies(nodeIds, staticCount);
+	m_tree.DestroyProxies(nodeIds + staticCount, count - staticCount);
+	m_staticProxyCount -= staticCount;
+	m_proxyCount -= count;
+
+	b2Free(nodeIds);
+	b2Free(ids);
+}
+
+void b2BroadPhase::Clear()
+{
+	m_tree.Clear();
+	m_staticTree.Clear();
+	m_proxyCount = 0;
+	m_staticProxyCount = 0;
+	m_staticInsertCount = 0;
+	m_moveCount = 0;
+	m_pairCount = 0;
+}
+
+void b2BroadPhase::Copy(const b2BroadPhase& broadPhase)
+{
+	m_tree.Copy(broadPhase.m_tree);
+	m_staticTree.Copy(broadPhase.m_staticTree);
+	m_proxyCount = broadPhase.m_proxyCount;
+	m_staticProxyCount = broadPhase.m_staticProxyCount;
+	m_staticInsertCount = broadPhase.m_staticInsertCount;
+
+	if (m_moveCapacity < broadPhase.m_moveCount)
+	{
+		b2Free(m_moveBuffer);
+		m_moveCapacity = broadPhase.m_moveCapacity;
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	}
+	memcpy(m_moveBuffer, broadPhase.m_moveBuffer, broadPhase.m_moveCount * sizeof(int32));
+	m_moveCount = broadPhase.m_moveCount;
+
+	// The pair buffer is scratch space of UpdatePairs.
+	m_pairCount = 0;
 }
 
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
-	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
+	bool buffer;
+	if (IsStaticProxy(proxyId))
+	{
+		buffer = m_staticTree.MoveProxy(GetNodeId(proxyId), aabb, displacement);
+		if (buffer)
+		{
+			++m_staticInsertCount;
+		}
+	}
+	else
+	{
+		buffer = m_tree.MoveProxy(GetNodeId(proxyId), aabb, displacement);
+	}
+
 	if (buffer)
 	{
 		BufferMove(proxyId);
 	}
 }
 
+void b2BroadPhase::MoveProxies(const int32* proxyIds, const b2AABB* aabbs, int32 count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Static proxies rarely move and the static tree already rebuilds
+	// after a batch of insertions.
+	int32* nodeIds = (int32*)b2Alloc(count * sizeof(int32));
+	b2AABB* nodeAABBs = (b2AABB*)b2Alloc(count * sizeof(b2AABB));
+	int32* dynamicIds = (int32*)b2Alloc(count * sizeof(int32));
+	int32 dynamicCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (IsStaticProxy(proxyIds[i]))
+		{
+			MoveProxy(proxyIds[i], aabbs[i], b2Vec2_zero);
+		}
+		else
+		{
+			nodeIds[dynamicCount] = GetNodeId(proxyIds[i]);
+			nodeAABBs[dynamicCount] = aabbs[i];
+			dynamicIds[dynamicCount] = proxyIds[i];
+			++dynamicCount;
+		}
+	}
+
+	bool* moved = (bool*)b2Alloc(dynamicCount * sizeof(bool));
+	m_tree.MoveProxies(nodeIds, nodeAABBs, dynamicCount, moved);
+	for (int32 i = 0; i < dynamicCount; ++i)
+	{
+		if (moved[i])
+		{
+			BufferMove(dynamicIds[i]);
+		}
+	}
+
+	b2Free(moved);
+	b2Free(dynamicIds);
+	b2Free(nodeAABBs);
+	b2Free(nodeIds);
+}
+
 void b2BroadPhase::TouchProxy(int32 proxyId)
 {
 	BufferMove(proxyId);
@@ -93,14 +286,24 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 }
 
 // This is called from b2DynamicTree::Query when we are gathering pairs.
-bool b2BroadPhase::QueryCallback(int32 proxyId)
+bool b2BroadPhase::QueryCallback(int32 nodeId)
 {
+	int32 proxyId = GetProxyId(nodeId, m_queryStaticTree);
+
 	// A proxy cannot form a pair with itself.
 	if (proxyId == m_queryProxyId)
 	{
 		return true;
 	}
 
+	// Both proxies are moving. Only the one with the larger id reports the
+	// pair, which avoids duplicates.
+	const b2DynamicTree& tree = m_queryStaticTree ? m_staticTree : m_tree;
+	if (tree.WasMoved(nodeId) && proxyId > m_queryProxyId)
+	{
+		return true;
+	}
+
 	// Grow the pair buffer as needed.
 	if (m_pairCount == m_pairCapacity)
 	{
@@ -22,7 +22,6 @@
 #include <Box2D/Common/b2Settings.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/b2DynamicTree.h>
-#include <algorithm>
 
 struct b2Pair
 {
@@ -33,6 +32,9 @@ struct b2Pair
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
+/// Static proxies are kept in a separate tree that is rebuilt top down after
+/// insertions, so moving proxies never walk static geometry to find each other
+/// and static proxies never look for pairs among themselves.
 class b2BroadPhase
 {
 public:
@@ -46,31 +48,67 @@ public:
 	~b2BroadPhase();
 
 	/// Create a proxy with an initial AABB. Pairs are not reported until
-	/// UpdatePairs is called.
-	int32 CreateProxy(const b2AABB& aabb, void* userData);
+	/// UpdatePairs is called. Static proxies never pair with each other.
+	int32 CreateProxy(const b2AABB& aabb, void* userData, bool staticProxy = false,
+						const b2Filter& filter = b2Filter());
 
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
 
+	/// Create proxies in bulk. This is faster than calling CreateProxy
+	/// in a loop when a level is loaded.
+	void CreateProxies(const b2AABB* aabbs, void* const* userData, const b2Filter* filters,
+						int32 count, bool staticProxies, int32* proxyIds);
+
+	/// Destroy proxies in bulk. The move buffer is cleaned in a single pass.
+	void DestroyProxies(const int32* proxyIds, int32 count);
+
+	/// Destroy all proxies. Buffers and node pools are kept.
+	void Clear();
+
+	/// Make this broad-phase a copy of another one, including the proxy ids and
+	/// the buffered moves. User data is copied as is. Pair filtering is kept.
+	void Copy(const b2BroadPhase& broadPhase);
+
 	/// Call MoveProxy as many times as you like, then when you are done
 	/// call UpdatePairs to finalized the proxy pairs (for your time step).
 	void MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement);
 
+	/// Move proxies in bulk without displacement, for example after teleports.
+	/// This is faster than calling MoveProxy in a loop when many proxies move.
+	void MoveProxies(const int32* proxyIds, const b2AABB* aabbs, int32 count);
+
 	/// Call to trigger a re-processing of it's pairs on the next call to UpdatePairs.
 	void TouchProxy(int32 proxyId);
 
+	/// Change the collision filter of a proxy. Call TouchProxy to find
+	/// pairs that the new filter allows.
+	void SetProxyFilter(int32 proxyId, const b2Filter& filter);
+
+	/// Enable or disable pair filtering. When enabled, UpdatePairs applies
+	/// the default filtering rules (see b2ShouldCollide) to the proxy filters
+	/// and skips subtrees that cannot collide. Disable this if the client
+	/// filters pairs with other rules. Enabled by default.
+	void SetPairFiltering(bool flag);
+
 	/// Get the fat AABB for a proxy.
 	const b2AABB& GetFatAABB(int32 proxyId) const;
 
 	/// Get user data from a proxy. Returns NULL if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
 
+	/// Set user data of a proxy.
+	void SetUserData(int32 proxyId, void* userData);
+
 	/// Test overlap of fat AABBs.
 	bool TestOverlap(int32 proxyIdA, int32 proxyIdB) const;
 
 	/// Get the number of proxies.
 	int32 GetProxyCount() const;
 
+	/// Is this a static proxy?
+	bool IsStaticProxy(int32 proxyId) const;
+
 	/// Update the pairs. This results in pair callbacks. This can only add pairs.
 	template <typename T>
 	void UpdatePairs(T* callback);
@@ -80,6 +118,16 @@ public:
 	template <typename T>
 	void Query(T* callback, const b2AABB& aabb) const;
 
+	/// Query an AABB for overlapping proxies that pass the filter.
+	/// Subtrees that can't collide with the filter are skipped.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb, const b2Filter& filter) const;
+
+	/// Query an AABB for overlapping proxies that pass the filter, skipping
+	/// the static tree. Use this when only moving proxies are wanted.
+	template <typename T>
+	void QueryMovable(T* callback, const b2AABB& aabb, const b2Filter& filter) const;
+
 	/// Ray-cast against the proxies in the tree. This relies on the callback
 	/// to perform a exact ray-cast in the case were the proxy contains a shape.
 	/// The callback also performs the any collision filtering. This has performance
@@ -90,15 +138,18 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
-	/// Get the height of the embedded tree.
+	/// Get the height of the taller embedded tree.
 	int32 GetTreeHeight() const;
 
-	/// Get the balance of the embedded tree.
+	/// Get the balance of the embedded trees.
 	int32 GetTreeBalance() const;
 
-	/// Get the quality metric of the embedded tree.
+	/// Get the quality metric of the dynamic tree.
 	float32 GetTreeQuality() const;
 
+	/// Get the quality metric of the static tree.
+	float32 GetStaticTreeQuality() const;
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -108,14 +159,66 @@ private:
 
 	friend class b2DynamicTree;
 
+	// Forwards tree queries to a client callback with broad-phase proxy ids.
+	template <typename T>
+	struct QueryWrapper
+	{
+		bool QueryCallback(int32 nodeId)
+		{
+			bool proceed = callback->QueryCallback(GetProxyId(nodeId, staticTree));
+			terminated = proceed == false;
+			return proceed;
+		}
+
+		T* callback;
+		bool staticTree;
+		bool terminated;
+	};
+
+	// Forwards tree ray casts and remembers the clipped fraction so the
+	// second tree continues from where the first left off.
+	template <typename T>
+	struct RayCastWrapper
+	{
+		float32 RayCastCallback(const b2RayCastInput& input, int32 nodeId)
+		{
+			float32 value = callback->RayCastCallback(input, GetProxyId(nodeId, staticTree));
+			if (value == 0.0f)
+			{
+				terminated = true;
+			}
+			else if (value > 0.0f)
+			{
+				maxFraction = value;
+			}
+			return value;
+		}
+
+		T* callback;
+		bool staticTree;
+		bool terminated;
+		float32 maxFraction;
+	};
+
+	// Proxy ids store the tree in the lowest bit.
+	static int32 GetProxyId(int32 nodeId, bool staticTree) { return (nodeId << 1) | (staticTree ? 1 : 0); }
+	static int32 GetNodeId(int32 proxyId) { return proxyId >> 1; }
+	const b2DynamicTree& GetTree(int32 proxyId) const { return (proxyId & 1) ? m_staticTree : m_tree; }
+	b2DynamicTree& GetTree(int32 proxyId) { return (proxyId & 1) ? m_staticTree : m_tree; }
+
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
-	bool QueryCallback(int32 proxyId);
+	bool QueryCallback(int32 nodeId);
 
 	b2DynamicTree m_tree;
+	b2DynamicTree m_staticTree;
 
 	int32 m_proxyCount;
+	int32 m_staticProxyCount;
+
+	// Static proxies inserted since the last static tree rebuild.
+	int32 m_staticInsertCount;
 
 	int32* m_moveBuffer;
 	int32 m_moveCapacity;
@@ -126,39 +229,41 @@ private:
 	int32 m_pairCount;
 
 	int32 m_queryProxyId;
+	bool m_queryStaticTree;
+
+	bool m_pairFiltering;
 };
 
-/// This is used to sort pairs.
-inline bool b2PairLessThan(const b2Pair& pair1, const b2Pair& pair2)
+inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 {
-	if (pair1.proxyIdA < pair2.proxyIdA)
-	{
-		return true;
-	}
+	return GetTree(proxyId).GetUserData(GetNodeId(proxyId));
+}
 
-	if (pair1.proxyIdA == pair2.proxyIdA)
-	{
-		return pair1.proxyIdB < pair2.proxyIdB;
-	}
+inline void b2BroadPhase::SetUserData(int32 proxyId, void* userData)
+{
+	GetTree(proxyId).SetUserData(GetNodeId(proxyId), userData);
+}
 
-	return false;
+inline void b2BroadPhase::SetProxyFilter(int32 proxyId, const b2Filter& filter)
+{
+	GetTree(proxyId).SetFilter(GetNodeId(proxyId), filter);
 }
 
-inline void* b2BroadPhase::GetUserData(int32 proxyId) const
+inline void b2BroadPhase::SetPairFiltering(bool flag)
 {
-	return m_tree.GetUserData(proxyId);
+	m_pairFiltering = flag;
 }
 
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
-	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
-	const b2AABB& aabbB = m_tree.GetFatAABB(proxyIdB);
+	const b2AABB& aabbA = GetFatAABB(proxyIdA);
+	const b2AABB& aabbB = GetFatAABB(proxyIdB);
 	return b2TestOverlap(aabbA, aabbB);
 }
 
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
-	return m_tree.GetFatAABB(proxyId);
+	return GetTree(proxyId).GetFatAABB(GetNodeId(proxyId));
 }
 
 inline int32 b2BroadPhase::GetProxyCount() const
@@ -166,14 +271,19 @@ inline int32 b2BroadPhase::GetProxyCount() const
 	return m_proxyCount;
 }
 
+inline bool b2BroadPhase::IsStaticProxy(int32 proxyId) const
+{
+	return (proxyId & 1) != 0;
+}
+
 inline int32 b2BroadPhase::GetTreeHeight() const
 {
-	return m_tree.GetHeight();
+	return b2Max(m_tree.GetHeight(), m_staticTree.GetHeight());
 }
 
 inline int32 b2BroadPhase::GetTreeBalance() const
 {
-	return m_tree.GetMaxBalance();
+	return b2Max(m_tree.GetMaxBalance(), m_staticTree.GetMaxBalance());
 }
 
 inline float32 b2BroadPhase::GetTreeQuality() const
@@ -181,9 +291,22 @@ inline float32 b2BroadPhase::GetTreeQuality() const
 	return m_tree.GetAreaRatio();
 }
 
+inline float32 b2BroadPhase::GetStaticTreeQuality() const
+{
+	return m_staticTree.GetAreaRatio();
+}
+
 template <typename T>
 void b2BroadPhase::UpdatePairs(T* callback)
 {
+	// Rebuild the static tree after a batch of insertions, typically once
+	// after a level is loaded. Single insertions later on are amortized.
+	if (m_staticInsertCount > 0 && 8 * m_staticInsertCount >= m_staticProxyCount)
+	{
+		m_staticTree.RebuildTopDown();
+		m_staticInsertCount = 0;
+	}
+
 	// Reset pair buffer
 	m_pairCount = 0;
 
@@ -198,41 +321,61 @@ void b2BroadPhase::UpdatePairs(T* callback)
 
 		// We have to query the tree with the fat AABB so that
 		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+		const b2AABB& fatAABB = GetFatAABB(m_queryProxyId);
 
-		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
-	}
+		// Query trees, create pairs and add them pair buffer.
+		if (m_pairFiltering)
+		{
+			// Filtered out pairs are never reported.
+			const b2Filter& filter = GetTree(m_queryProxyId).GetFilter(GetNodeId(m_queryProxyId));
 
-	// Reset move buffer
-	m_moveCount = 0;
+			m_queryStaticTree = false;
+			m_tree.Query(this, fatAABB, filter);
 
-	// Sort the pair buffer to expose duplicates.
-	std::sort(m_pairBuffer, m_pairBuffer + m_pairCount, b2PairLessThan);
+			if (IsStaticProxy(m_queryProxyId) == false)
+			{
+				m_queryStaticTree = true;
+				m_staticTree.Query(this, fatAABB, filter);
+			}
+		}
+		else
+		{
+			m_queryStaticTree = false;
+			m_tree.Query(this, fatAABB);
 
-	// Send the pairs back to the client.
-	int32 i = 0;
-	while (i < m_pairCount)
+			if (IsStaticProxy(m_queryProxyId) == false)
+			{
+				m_queryStaticTree = true;
+				m_staticTree.Query(this, fatAABB);
+			}
+		}
+	}
+
+	// Send the pairs back to the client. Pairs of two moved proxies are only
+	// reported by one side, so there is nothing to sort. A proxy that is
+	// buffered twice can still repeat a pair; the client ignores pairs it
+	// already has.
+	for (int32 i = 0; i < m_pairCount; ++i)
 	{
-		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		b2Pair* pair = m_pairBuffer + i;
+		void* userDataA = GetUserData(pair->proxyIdA);
+		void* userDataB = GetUserData(pair->proxyIdB);
 
 		callback->AddPair(userDataA, userDataB);
-		++i;
+	}
 
-		// Skip any duplicate pairs.
-		while (i < m_pairCount)
+	// Clear the moved flags and reset the move buffer.
+	for (int32 i = 0; i < m_moveCount; ++i)
+	{
+		int32 proxyId = m_moveBuffer[i];
+		if (proxyId != e_nullProxy)
 		{
-			b2Pair* pair = m_pairBuffer + i;
-			if (pair->proxyIdA != primaryPair->proxyIdA || pair->proxyIdB != primaryPair->proxyIdB)
-			{
-				break;
-			}
-			++i;
+			GetTree(proxyId).ClearMoved(GetNodeId(proxyId));
 		}
 	}
 
+	m_moveCount = 0;
+
 	// Try to keep the tree balanced.
 	//m_tree.Rebalance(4);
 }
@@ -240,18 +383,74 @@ void b2BroadPhase::UpdatePairs(T* callback)
 template <typename T>
 inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb) const
 {
-	m_tree.Query(callback, aabb);
+	QueryWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.staticTree = false;
+	wrapper.terminated = false;
+	m_tree.Query(&wrapper, aabb);
+
+	if (wrapper.terminated)
+	{
+		return;
+	}
+
+	wrapper.staticTree = true;
+	m_staticTree.Query(&wrapper, aabb);
+}
+
+template <typename T>
+inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb, const b2Filter& filter) const
+{
+	QueryWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.staticTree = false;
+	wrapper.terminated = false;
+	m_tree.Query(&wrapper, aabb, filter);
+
+	if (wrapper.terminated)
+	{
+		return;
+	}
+
+	wrapper.staticTree = true;
+	m_staticTree.Query(&wrapper, aabb, filter);
+}
+
+template <typename T>
+inline void b2BroadPhase::QueryMovable(T* callback, const b2AABB& aabb, const b2Filter& filter) const
+{
+	QueryWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.staticTree = false;
+	wrapper.terminated = false;
+	m_tree.Query(&wrapper, aabb, filter);
 }
 
 template <typename T>
 inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
 {
-	m_tree.RayCast(callback, input);
+	RayCastWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.staticTree = false;
+	wrapper.terminated = false;
+	wrapper.maxFraction = input.maxFraction;
+	m_tree.RayCast(&wrapper, input);
+
+	if (wrapper.terminated)
+	{
+		return;
+	}
+
+	b2RayCastInput staticInput = input;
+	staticInput.maxFraction = wrapper.maxFraction;
+	wrapper.staticTree = true;
+	m_staticTree.RayCast(&wrapper, staticInput);
 }
 
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_tree.ShiftOrigin(newOrigin);
+	m_staticTree.ShiftOrigin(newOrigin);
 }
 
 #endif
@@ -0,0 +1,286 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+
+// Find the max separation between box1 and box2 using the face normals of box1.
+// Only the face pointing towards box2 can be the best on each axis, and the
+// depth of box2 along that axis is given by its projected extents.
+static float32 b2FindMaxBoxSeparation(int32* edgeIndex,
+									  const b2BoxShape* box1, const b2Transform& xf1,
+									  const b2BoxShape* box2, const b2Transform& xf2)
+{
+	// Box2 expressed in the frame of box1, relative to the box1 center.
+	b2Transform xf = b2MulT(xf1, xf2);
+	b2Vec2 d = b2Mul(xf, box2->m_center) - box1->m_center;
+
+	float32 c = b2Abs(xf.q.c), s = b2Abs(xf.q.s);
+	float32 rx = c * box2->m_extents.x + s * box2->m_extents.y;
+	float32 ry = s * box2->m_extents.x + c * box2->m_extents.y;
+
+	float32 separationX = b2Abs(d.x) - box1->m_extents.x - rx;
+	float32 separationY = b2Abs(d.y) - box1->m_extents.y - ry;
+
+	if (separationX > separationY)
+	{
+		*edgeIndex = d.x >= 0.0f ? 1 : 3;
+		return separationX;
+	}
+
+	*edgeIndex = d.y >= 0.0f ? 2 : 0;
+	return separationY;
+}
+
+static void b2FindIncidentBoxEdge(b2ClipVertex c[2],
+								  const b2BoxShape* box1, const b2Transform& xf1, int32 edge1,
+								  const b2BoxShape* box2, const b2Transform& xf2)
+{
+	b2Assert(0 <= edge1 && edge1 < 4);
+
+	// Get the normal of the reference edge in box2's frame.
+	b2Vec2 normal1 = b2MulT(xf2.q, b2Mul(xf1.q, box1->GetNormal(edge1)));
+
+	// The incident edge is the one whose normal is most anti-parallel.
+	int32 i1;
+	if (b2Abs(normal1.x) > b2Abs(normal1.y))
+	{
+		i1 = normal1.x > 0.0f ? 3 : 1;
+	}
+	else
+	{
+		i1 = normal1.y > 0.0f ? 0 : 2;
+	}
+	int32 i2 = i1 + 1 < 4 ? i1 + 1 : 0;
+
+	c[0].v = b2Mul(xf2, box2->GetVertex(i1));
+	c[0].id.cf.indexA = (uint8)edge1;
+	c[0].id.cf.indexB = (uint8)i1;
+	c[0].id.cf.typeA = b2ContactFeature::e_face;
+	c[0].id.cf.typeB = b2ContactFeature::e_vertex;
+
+	c[1].v = b2Mul(xf2, box2->GetVertex(i2));
+	c[1].id.cf.indexA = (uint8)edge1;
+	c[1].id.cf.indexB = (uint8)i2;
+	c[1].id.cf.typeA = b2ContactFeature::e_face;
+	c[1].id.cf.typeB = b2ContactFeature::e_vertex;
+}
+
+// Same as b2CollidePolygons, but the separating axis search and the incident
+// edge lookup are constant time. The normal points from A to B.
+void b2CollideBoxes(b2Manifold* manifold,
+					const b2BoxShape* boxA, const b2Transform& xfA,
+					const b2BoxShape* boxB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+	float32 totalRadius = boxA->m_radius + boxB->m_radius;
+
+	int32 edgeA = 0;
+	float32 separationA = b2FindMaxBoxSeparation(&edgeA, boxA, xfA, boxB, xfB);
+	if (separationA > totalRadius)
+		return;
+
+	int32 edgeB = 0;
+	float32 separationB = b2FindMaxBoxSeparation(&edgeB, boxB, xfB, boxA, xfA);
+	if (separationB > totalRadius)
+		return;
+
+	const b2BoxShape* box1;	// reference box
+	const b2BoxShape* box2;	// incident box
+	b2Transform xf1, xf2;
+	int32 edge1;			// reference edge
+	uint8 flip;
+	const float32 k_tol = 0.1f * b2_linearSlop;
+
+	if (separationB > separationA + k_tol)
+	{
+		box1 = boxB;
+		box2 = boxA;
+		xf1 = xfB;
+		xf2 = xfA;
+		edge1 = edgeB;
+		manifold->type = b2Manifold::e_faceB;
+		flip = 1;
+	}
+	else
+	{
+		box1 = boxA;
+		box2 = boxB;
+		xf1 = xfA;
+		xf2 = xfB;
+		edge1 = edgeA;
+		manifold->type = b2Manifold::e_faceA;
+		flip = 0;
+	}
+
+	b2ClipVertex incidentEdge[2];
+	b2FindIncidentBoxEdge(incidentEdge, box1, xf1, edge1, box2, xf2);
+
+	int32 iv1 = edge1;
+	int32 iv2 = edge1 + 1 < 4 ? edge1 + 1 : 0;
+
+	b2Vec2 v11 = box1->GetVertex(iv1);
+	b2Vec2 v12 = box1->GetVertex(iv2);
+
+	b2Vec2 localNormal = box1->GetNormal(edge1);
+	b2Vec2 localTangent = b2Cross(1.0f, localNormal);
+	b2Vec2 planePoint = 0.5f * (v11 + v12);
+
+	b2Vec2 tangent = b2Mul(xf1.q, localTangent);
+	b2Vec2 normal = b2Cross(tangent, 1.0f);
+
+	v11 = b2Mul(xf1, v11);
+	v12 = b2Mul(xf1, v12);
+
+	// Face offset.
+	float32 frontOffset = b2Dot(normal, v11);
+
+	// Side offsets, extended by polytope skin thickness.
+	float32 sideOffset1 = -b2Dot(tangent, v11) + totalRadius;
+	float32 sideOffset2 = b2Dot(tangent, v12) + totalRadius;
+
+	// Clip incident edge against extruded edge1 side edges.
+	b2ClipVertex clipPoints1[2];
+	b2ClipVertex clipPoints2[2];
+	int np;
+
+	// Clip to box side 1
+	np = b2ClipSegmentToLine(clipPoints1, incidentEdge, -tangent, sideOffset1, iv1);
+
+	if (np < 2)
+		return;
+
+	// Clip to negative box side 1
+	np = b2ClipSegmentToLine(clipPoints2, clipPoints1,  tangent, sideOffset2, iv2);
+
+	if (np < 2)
+	{
+		return;
+	}
+
+	// Now clipPoints2 contains the clipped points.
+	manifold->localNormal = localNormal;
+	manifold->localPoint = planePoint;
+
+	int32 pointCount = 0;
+	for (int32 i = 0; i < b2_maxManifoldPoints; ++i)
+	{
+		float32 separation = b2Dot(normal, clipPoints2[i].v) - frontOffset;
+
+		if (separation <= totalRadius)
+		{
+			b2ManifoldPoint* cp = manifold->points + pointCount;
+			cp->localPoint = b2MulT(xf2, clipPoints2[i].v);
+			cp->id = clipPoints2[i].id;
+			if (flip)
+			{
+				// Swap features
+				b2ContactFeature cf = cp->id.cf;
+				cp->id.cf.indexA = cf.indexB;
+				cp->id.cf.indexB = cf.indexA;
+				cp->id.cf.typeA = cf.typeB;
+				cp->id.cf.typeB = cf.typeA;
+			}
+			++pointCount;
+		}
+	}
+
+	manifold->pointCount = pointCount;
+}
+
+// Same result as b2CollidePolygonAndCircle. The face of max separation and the
+// vertex regions follow directly from clamping the circle center to the box.
+void b2CollideBoxAndCircle(b2Manifold* manifold,
+						   const b2BoxShape* boxA, const b2Transform& xfA,
+						   const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Compute circle position in the frame of the box, relative to the box center.
+	b2Vec2 c = b2Mul(xfB, circleB->m_p);
+	b2Vec2 d = b2MulT(xfA, c) - boxA->m_center;
+
+	float32 radius = boxA->m_radius + circleB->m_radius;
+	b2Vec2 e = boxA->m_extents;
+
+	float32 separationX = b2Abs(d.x) - e.x;
+	float32 separationY = b2Abs(d.y) - e.y;
+	if (separationX > radius || separationY > radius)
+	{
+		// Early out.
+		return;
+	}
+
+	b2Vec2 sign(d.x >= 0.0f ? 1.0f : -1.0f, d.y >= 0.0f ? 1.0f : -1.0f);
+
+	manifold->type = b2Manifold::e_faceA;
+	manifold->points[0].localPoint = circleB->m_p;
+	manifold->points[0].id.key = 0;
+
+	if (separationX > 0.0f && separationY > 0.0f)
+	{
+		// The center is in a vertex region.
+		b2Vec2 v(sign.x * e.x, sign.y * e.y);
+		if (b2DistanceSquared(d, v) > radius * radius)
+		{
+			return;
+		}
+
+		manifold->pointCount = 1;
+		manifold->localNormal = d - v;
+		manifold->localNormal.Normalize();
+		manifold->localPoint = boxA->m_center + v;
+	}
+	else if (separationX > separationY)
+	{
+		// The center is in the region of a vertical face or inside.
+		manifold->pointCount = 1;
+		manifold->localNormal.Set(sign.x, 0.0f);
+		manifold->localPoint = boxA->m_center + b2Vec2(sign.x * e.x, 0.0f);
+	}
+	else
+	{
+		// The center is in the region of a horizontal face or inside.
+		manifold->pointCount = 1;
+		manifold->localNormal.Set(0.0f, sign.y);
+		manifold->localPoint = boxA->m_center + b2Vec2(0.0f, sign.y * e.y);
+	}
+}
+
+// Boxes against polygons and edges reuse the general routines. The polygon is
+// built on the stack so no extra storage is kept per fixture.
+void b2CollidePolygonAndBox(b2Manifold* manifold,
+							const b2PolygonShape* polygonA, const b2Transform& xfA,
+							const b2BoxShape* boxB, const b2Transform& xfB)
+{
+	b2PolygonShape polygonB;
+	boxB->ComputePolygon(&polygonB);
+	b2CollidePolygons(manifold, polygonA, xfA, &polygonB, xfB);
+}
+
+void b2CollideEdgeAndBox(b2Manifold* manifold,
+						 const b2EdgeShape* edgeA, const b2Transform& xfA,
+						 const b2BoxShape* boxB, const b2Transform& xfB)
+{
+	b2PolygonShape polygonB;
+	boxB->ComputePolygon(&polygonB);
+	b2CollideEdgeAndPolygon(manifold, edgeA, xfA, &polygonB, xfB);
+}
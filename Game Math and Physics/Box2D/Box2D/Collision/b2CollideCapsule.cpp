@@ -0,0 +1,623 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+
+// Closest points between segments p1-q1 and p2-q2. The fractions locate the
+// points on each segment. From Real-Time Collision Detection by Christer
+// Ericson, Section 5.1.9.
+static void b2SegmentDistance(b2Vec2* c1, float32* f1, b2Vec2* c2, float32* f2,
+							  const b2Vec2& p1, const b2Vec2& q1,
+							  const b2Vec2& p2, const b2Vec2& q2)
+{
+	b2Vec2 d1 = q1 - p1;
+	b2Vec2 d2 = q2 - p2;
+	b2Vec2 r = p1 - p2;
+	float32 a = b2Dot(d1, d1);
+	float32 e = b2Dot(d2, d2);
+	float32 f = b2Dot(d2, r);
+
+	float32 s, t;
+	if (a <= b2_epsilon && e <= b2_epsilon)
+	{
+		s = 0.0f;
+		t = 0.0f;
+	}
+	else if (a <= b2_epsilon)
+	{
+		s = 0.0f;
+		t = b2Clamp(f / e, 0.0f, 1.0f);
+	}
+	else
+	{
+		float32 c = b2Dot(d1, r);
+		if (e <= b2_epsilon)
+		{
+			t = 0.0f;
+			s = b2Clamp(-c / a, 0.0f, 1.0f);
+		}
+		else
+		{
+			// Parallel segments have a zero denominator. Any s works then.
+			float32 b = b2Dot(d1, d2);
+			float32 denominator = a * e - b * b;
+			s = denominator != 0.0f ? b2Clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+			t = (b * s + f) / e;
+
+			if (t < 0.0f)
+			{
+				t = 0.0f;
+				s = b2Clamp(-c / a, 0.0f, 1.0f);
+			}
+			else if (t > 1.0f)
+			{
+				t = 1.0f;
+				s = b2Clamp((b - c) / a, 0.0f, 1.0f);
+			}
+		}
+	}
+
+	*f1 = s;
+	*f2 = t;
+	*c1 = p1 + s * d1;
+	*c2 = p2 + t * d2;
+}
+
+// Capsules within this angle (sine) of each other get a two point manifold so they can rest on each other.
+const float32 b2_capsuleParallelTolerance = 0.1f;
+
+// Segment A against segment B, both rounded. Nearly parallel overlapping
+// segments are clipped like polygon faces. Otherwise the closest points give
+// one contact point whose normal is fixed to the feature that owns it.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Work in the frame of A.
+	b2Transform xf = b2MulT(xfA, xfB);
+
+	b2Vec2 p1 = capsuleA->m_vertex1, q1 = capsuleA->m_vertex2;
+	b2Vec2 p2 = b2Mul(xf, capsuleB->m_vertex1), q2 = b2Mul(xf, capsuleB->m_vertex2);
+
+	float32 totalRadius = capsuleA->m_radius + capsuleB->m_radius;
+
+	b2Vec2 c1, c2;
+	float32 s, t;
+	b2SegmentDistance(&c1, &s, &c2, &t, p1, q1, p2, q2);
+
+	float32 distSqr = b2DistanceSquared(c1, c2);
+	if (distSqr > totalRadius * totalRadius)
+	{
+		return;
+	}
+	float32 distance = b2Sqrt(distSqr);
+
+	b2Vec2 d1 = q1 - p1, d2 = q2 - p2;
+	float32 length1 = d1.Normalize();
+	float32 length2 = d2.Normalize();
+
+	if (length1 > b2_linearSlop && length2 > b2_linearSlop && b2Abs(b2Cross(d1, d2)) < b2_capsuleParallelTolerance)
+	{
+		b2Vec2 normal = b2Cross(d1, 1.0f);
+		if (b2Dot(normal, 0.5f * (p2 + q2) - p1) < 0.0f)
+		{
+			normal = -normal;
+		}
+
+		b2ClipVertex incidentEdge[2];
+		incidentEdge[0].v = p2;
+		incidentEdge[0].id.cf.indexA = 0;
+		incidentEdge[0].id.cf.indexB = 0;
+		incidentEdge[0].id.cf.typeA = b2ContactFeature::e_face;
+		incidentEdge[0].id.cf.typeB = b2ContactFeature::e_vertex;
+		incidentEdge[1].v = q2;
+		incidentEdge[1].id.cf.indexA = 0;
+		incidentEdge[1].id.cf.indexB = 1;
+		incidentEdge[1].id.cf.typeA = b2ContactFeature::e_face;
+		incidentEdge[1].id.cf.typeB = b2ContactFeature::e_vertex;
+
+		// Clip segment B to the extent of segment A, extended by the polygon
+		// skin so that aligned stacks keep their feature ids for warm starting.
+		b2ClipVertex clipPoints1[2];
+		b2ClipVertex clipPoints2[2];
+		int32 np = b2ClipSegmentToLine(clipPoints1, incidentEdge, -d1, -b2Dot(d1, p1) + b2_polygonRadius, 0);
+		if (np == 2)
+		{
+			np = b2ClipSegmentToLine(clipPoints2, clipPoints1, d1, b2Dot(d1, q1) + b2_polygonRadius, 1);
+		}
+
+		if (np == 2)
+		{
+			int32 pointCount = 0;
+			for (int32 i = 0; i < 2; ++i)
+			{
+				float32 separation = b2Dot(normal, clipPoints2[i].v - p1);
+				if (separation <= totalRadius)
+				{
+					b2ManifoldPoint* cp = manifold->points + pointCount;
+					cp->localPoint = b2MulT(xf, clipPoints2[i].v);
+					cp->id = clipPoints2[i].id;
+					++pointCount;
+				}
+			}
+
+			if (pointCount > 0)
+			{
+				manifold->type = b2Manifold::e_faceA;
+				manifold->localNormal = normal;
+				manifold->localPoint = 0.5f * (p1 + q1);
+				manifold->pointCount = pointCount;
+				return;
+			}
+		}
+	}
+
+	// The feature ids match the two point manifold where possible so that
+	// warm starting survives the switch between the two.
+	manifold->pointCount = 1;
+	b2ContactFeature* cf = &manifold->points[0].id.cf;
+
+	if (distance < b2_epsilon)
+	{
+		// The segments cross. Push the deepest end of B out along the normal of A.
+		b2Vec2 normal = length1 > b2_epsilon ? b2Cross(d1, 1.0f) : b2Cross(d2, 1.0f);
+		if (b2Dot(normal, 0.5f * (p2 + q2) - c1) < 0.0f)
+		{
+			normal = -normal;
+		}
+
+		uint8 indexB = b2Dot(normal, p2) < b2Dot(normal, q2) ? 0 : 1;
+
+		manifold->type = b2Manifold::e_faceA;
+		manifold->localNormal = normal;
+		manifold->localPoint = c1;
+		manifold->points[0].localPoint = indexB == 0 ? capsuleB->m_vertex1 : capsuleB->m_vertex2;
+		cf->indexA = 0;
+		cf->indexB = indexB;
+		cf->typeA = b2ContactFeature::e_face;
+		cf->typeB = b2ContactFeature::e_vertex;
+		return;
+	}
+
+	b2Vec2 normal = (1.0f / distance) * (c2 - c1);
+
+	if (0.0f < s && s < 1.0f)
+	{
+		// Side of A against the end of B.
+		manifold->type = b2Manifold::e_faceA;
+		manifold->localNormal = normal;
+		manifold->localPoint = c1;
+		manifold->points[0].localPoint = b2MulT(xf, c2);
+		cf->indexA = 0;
+		cf->indexB = t < 0.5f ? 0 : 1;
+		cf->typeA = b2ContactFeature::e_face;
+		cf->typeB = b2ContactFeature::e_vertex;
+	}
+	else if (0.0f < t && t < 1.0f)
+	{
+		// End of A against the side of B.
+		manifold->type = b2Manifold::e_faceB;
+		manifold->localNormal = b2MulT(xf.q, -normal);
+		manifold->localPoint = b2MulT(xf, c2);
+		manifold->points[0].localPoint = c1;
+		cf->indexA = s < 0.5f ? 0 : 1;
+		cf->indexB = 0;
+		cf->typeA = b2ContactFeature::e_vertex;
+		cf->typeB = b2ContactFeature::e_face;
+	}
+	else
+	{
+		// End against end.
+		manifold->type = b2Manifold::e_circles;
+		manifold->localNormal.SetZero();
+		manifold->localPoint = c1;
+		manifold->points[0].localPoint = b2MulT(xf, c2);
+		cf->indexA = s < 0.5f ? 0 : 1;
+		cf->indexB = t < 0.5f ? 0 : 1;
+		cf->typeA = b2ContactFeature::e_vertex;
+		cf->typeB = b2ContactFeature::e_vertex;
+	}
+}
+
+// Same regions as b2CollideEdgeAndCircle without the edge adjacency.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Compute circle in frame of capsule
+	b2Vec2 Q = b2MulT(xfA, b2Mul(xfB, circleB->m_p));
+
+	b2Vec2 A = capsuleA->m_vertex1, B = capsuleA->m_vertex2;
+	b2Vec2 e = B - A;
+
+	// Barycentric coordinates
+	float32 u = b2Dot(e, B - Q);
+	float32 v = b2Dot(e, Q - A);
+
+	float32 radius = capsuleA->m_radius + circleB->m_radius;
+
+	manifold->points[0].id.key = 0;
+	manifold->points[0].localPoint = circleB->m_p;
+
+	// Region A, or a capsule without length
+	if (v <= 0.0f)
+	{
+		if (b2DistanceSquared(Q, A) > radius * radius)
+		{
+			return;
+		}
+
+		manifold->pointCount = 1;
+		manifold->type = b2Manifold::e_circles;
+		manifold->localNormal.SetZero();
+		manifold->localPoint = A;
+		return;
+	}
+
+	// Region B
+	if (u <= 0.0f)
+	{
+		if (b2DistanceSquared(Q, B) > radius * radius)
+		{
+			return;
+		}
+
+		manifold->pointCount = 1;
+		manifold->type = b2Manifold::e_circles;
+		manifold->localNormal.SetZero();
+		manifold->localPoint = B;
+		return;
+	}
+
+	// Region AB
+	float32 den = b2Dot(e, e);
+	b2Assert(den > 0.0f);
+	b2Vec2 P = (1.0f / den) * (u * A + v * B);
+	if (b2DistanceSquared(Q, P) > radius * radius)
+	{
+		return;
+	}
+
+	b2Vec2 n(-e.y, e.x);
+	if (b2Dot(n, Q - A) < 0.0f)
+	{
+		n.Set(-n.x, -n.y);
+	}
+	n.Normalize();
+
+	manifold->pointCount = 1;
+	manifold->type = b2Manifold::e_faceA;
+	manifold->localNormal = n;
+	manifold->localPoint = A;
+}
+
+// Polygon faces and both capsule sides are the candidate axes. A capsule is
+// a two vertex polygon with a large radius, so when the cores are apart the
+// closest features decide between a single rounded contact and face clipping.
+// Clipping only extends past the reference face by the polygon skin, which
+// keeps the capsule ends from generating contacts off polygon corners.
+void b2CollidePolygonAndCapsule(b2Manifold* manifold,
+								const b2PolygonShape* polygonA, const b2Transform& xfA,
+								const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	// A capsule without length is a circle.
+	if (b2DistanceSquared(capsuleB->m_vertex1, capsuleB->m_vertex2) <= b2_linearSlop * b2_linearSlop)
+	{
+		b2CircleShape circleB;
+		circleB.m_p = 0.5f * (capsuleB->m_vertex1 + capsuleB->m_vertex2);
+		circleB.m_radius = capsuleB->m_radius;
+		b2CollidePolygonAndCircle(manifold, polygonA, xfA, &circleB, xfB);
+		return;
+	}
+
+	// Capsule in the frame of the polygon.
+	b2Transform xf = b2MulT(xfA, xfB);
+	b2Vec2 v1 = b2Mul(xf, capsuleB->m_vertex1);
+	b2Vec2 v2 = b2Mul(xf, capsuleB->m_vertex2);
+
+	float32 totalRadius = polygonA->m_radius + capsuleB->m_radius;
+
+	int32 count = polygonA->m_count;
+	const b2Vec2* vertices = polygonA->m_vertices;
+	const b2Vec2* normals = polygonA->m_normals;
+
+	// Find the polygon face of max separation.
+	int32 edgeA = 0;
+	float32 separationA = -b2_maxFloat;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 s = b2Min(b2Dot(normals[i], v1 - vertices[i]), b2Dot(normals[i], v2 - vertices[i]));
+		if (s > separationA)
+		{
+			separationA = s;
+			edgeA = i;
+		}
+	}
+
+	if (separationA > totalRadius)
+	{
+		return;
+	}
+
+	// Find the capsule side of max separation.
+	b2Vec2 axis = v2 - v1;
+	axis.Normalize();
+	b2Vec2 normalB = b2Cross(axis, 1.0f);
+	float32 s1 = b2_maxFloat, s2 = b2_maxFloat;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 s = b2Dot(normalB, vertices[i] - v1);
+		s1 = b2Min(s1, s);
+		s2 = b2Min(s2, -s);
+	}
+
+	float32 separationB = s1;
+	if (s2 > s1)
+	{
+		normalB = -normalB;
+		separationB = s2;
+	}
+
+	if (separationB > totalRadius)
+	{
+		return;
+	}
+
+	b2Vec2 v11, v12;			// reference edge
+	b2ClipVertex incidentEdge[2];
+	int32 iv1, iv2;
+	uint8 flip;
+	const float32 k_tol = 0.1f * b2_linearSlop;
+
+	if (separationB > separationA + k_tol)
+	{
+		// Reference face on the capsule, wound so that its normal is normalB.
+		if (b2Dot(b2Cross(axis, 1.0f), normalB) > 0.0f)
+		{
+			v11 = v1;
+			v12 = v2;
+			iv1 = 0;
+			iv2 = 1;
+		}
+		else
+		{
+			v11 = v2;
+			v12 = v1;
+			iv1 = 1;
+			iv2 = 0;
+		}
+
+		// The incident polygon edge is the most anti-parallel.
+		int32 index = 0;
+		float32 minDot = b2_maxFloat;
+		for (int32 i = 0; i < count; ++i)
+		{
+			float32 dot = b2Dot(normalB, normals[i]);
+			if (dot < minDot)
+			{
+				minDot = dot;
+				index = i;
+			}
+		}
+
+		int32 i1 = index;
+		int32 i2 = i1 + 1 < count ? i1 + 1 : 0;
+
+		incidentEdge[0].v = vertices[i1];
+		incidentEdge[0].id.cf.indexA = (uint8)iv1;
+		incidentEdge[0].id.cf.indexB = (uint8)i1;
+		incidentEdge[0].id.cf.typeA = b2ContactFeature::e_face;
+		incidentEdge[0].id.cf.typeB = b2ContactFeature::e_vertex;
+
+		incidentEdge[1].v = vertices[i2];
+		incidentEdge[1].id.cf.indexA = (uint8)iv1;
+		incidentEdge[1].id.cf.indexB = (uint8)i2;
+		incidentEdge[1].id.cf.typeA = b2ContactFeature::e_face;
+		incidentEdge[1].id.cf.typeB = b2ContactFeature::e_vertex;
+
+		flip = 1;
+	}
+	else
+	{
+		iv1 = edgeA;
+		iv2 = edgeA + 1 < count ? edgeA + 1 : 0;
+		v11 = vertices[iv1];
+		v12 = vertices[iv2];
+
+		incidentEdge[0].v = v1;
+		incidentEdge[0].id.cf.indexA = (uint8)edgeA;
+		incidentEdge[0].id.cf.indexB = 0;
+		incidentEdge[0].id.cf.typeA = b2ContactFeature::e_face;
+		incidentEdge[0].id.cf.typeB = b2ContactFeature::e_vertex;
+
+		incidentEdge[1].v = v2;
+		incidentEdge[1].id.cf.indexA = (uint8)edgeA;
+		incidentEdge[1].id.cf.indexB = 1;
+		incidentEdge[1].id.cf.typeA = b2ContactFeature::e_face;
+		incidentEdge[1].id.cf.typeB = b2ContactFeature::e_vertex;
+
+		flip = 0;
+	}
+
+	if (b2Max(separationA, separationB) > 0.1f * b2_linearSlop)
+	{
+		// The cores are apart. If the closest features are two vertices the
+		// contact is rounded and has a single point.
+		b2Vec2 c1, c2;
+		float32 f1, f2;
+		b2SegmentDistance(&c1, &f1, &c2, &f2, v11, v12, incidentEdge[0].v, incidentEdge[1].v);
+
+		if ((f1 == 0.0f || f1 == 1.0f) && (f2 == 0.0f || f2 == 1.0f))
+		{
+			if (b2DistanceSquared(c1, c2) > totalRadius * totalRadius)
+			{
+				return;
+			}
+
+			// c1 is on the reference shape and c2 on the incident shape.
+			b2Vec2 pointA = flip ? c2 : c1;
+			b2Vec2 pointB = flip ? c1 : c2;
+
+			manifold->pointCount = 1;
+			manifold->type = b2Manifold::e_circles;
+			manifold->localNormal.SetZero();
+			manifold->localPoint = pointA;
+			manifold->points[0].localPoint = b2MulT(xf, pointB);
+
+			uint8 referenceIndex = (uint8)(f1 == 0.0f ? iv1 : iv2);
+			uint8 incidentIndex = f2 == 0.0f ? incidentEdge[0].id.cf.indexB : incidentEdge[1].id.cf.indexB;
+			b2ContactFeature* cf = &manifold->points[0].id.cf;
+			cf->indexA = flip ? incidentIndex : referenceIndex;
+			cf->indexB = flip ? referenceIndex : incidentIndex;
+			cf->typeA = b2ContactFeature::e_vertex;
+			cf->typeB = b2ContactFeature::e_vertex;
+			return;
+		}
+	}
+
+	b2Vec2 tangent = v12 - v11;
+	tangent.Normalize();
+	b2Vec2 normal = b2Cross(tangent, 1.0f);
+	b2Vec2 planePoint = 0.5f * (v11 + v12);
+
+	// Face offset.
+	float32 frontOffset = b2Dot(normal, v11);
+
+	// Side offsets, extended by the polygon skin only.
+	float32 sideOffset1 = -b2Dot(tangent, v11) + polygonA->m_radius;
+	float32 sideOffset2 = b2Dot(tangent, v12) + polygonA->m_radius;
+
+	b2ClipVertex clipPoints1[2];
+	b2ClipVertex clipPoints2[2];
+	int32 np;
+
+	np = b2ClipSegmentToLine(clipPoints1, incidentEdge, -tangent, sideOffset1, iv1);
+
+	if (np < 2)
+		return;
+
+	np = b2ClipSegmentToLine(clipPoints2, clipPoints1,  tangent, sideOffset2, iv2);
+
+	if (np < 2)
+	{
+		return;
+	}
+
+	if (flip)
+	{
+		manifold->type = b2Manifold::e_faceB;
+		manifold->localNormal = b2MulT(xf.q, normal);
+		manifold->localPoint = b2MulT(xf, planePoint);
+	}
+	else
+	{
+		manifold->type = b2Manifold::e_faceA;
+		manifold->localNormal = normal;
+		manifold->localPoint = planePoint;
+	}
+
+	int32 pointCount = 0;
+	for (int32 i = 0; i < b2_maxManifoldPoints; ++i)
+	{
+		float32 separation = b2Dot(normal, clipPoints2[i].v) - frontOffset;
+
+		if (separation <= totalRadius)
+		{
+			b2ManifoldPoint* cp = manifold->points + pointCount;
+			cp->id = clipPoints2[i].id;
+			if (flip)
+			{
+				// The clip point is on the polygon, which is already in frame A.
+				cp->localPoint = clipPoints2[i].v;
+
+				// Swap features
+				b2ContactFeature cf = cp->id.cf;
+				cp->id.cf.indexA = cf.indexB;
+				cp->id.cf.indexB = cf.indexA;
+				cp->id.cf.typeA = cf.typeB;
+				cp->id.cf.typeB = cf.typeA;
+			}
+			else
+			{
+				cp->localPoint = b2MulT(xf, clipPoints2[i].v);
+			}
+			++pointCount;
+		}
+	}
+
+	manifold->pointCount = pointCount;
+}
+
+void b2CollideBoxAndCapsule(b2Manifold* manifold,
+							const b2BoxShape* boxA, const b2Transform& xfA,
+							const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2PolygonShape polygonA;
+	boxA->ComputePolygon(&polygonA);
+	b2CollidePolygonAndCapsule(manifold, &polygonA, xfA, capsuleB, xfB);
+}
+
+// A lone edge is a capsule with the skin radius. An edge with neighbors uses
+// the adjacency of the edge-polygon collider, with the capsule as a rounded
+// two sided polygon, so capsules slide over the inner vertices of chains
+// without catching on them.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							 const b2EdgeShape* edgeA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	if (edgeA->m_hasVertex0 == false && edgeA->m_hasVertex3 == false)
+	{
+		b2CapsuleShape capsuleA;
+		capsuleA.Set(edgeA->m_vertex1, edgeA->m_vertex2, edgeA->m_radius);
+		b2CollideCapsules(manifold, &capsuleA, xfA, capsuleB, xfB);
+		return;
+	}
+
+	// A capsule without length is a circle.
+	b2Vec2 axis = capsuleB->m_vertex2 - capsuleB->m_vertex1;
+	if (axis.LengthSquared() <= b2_linearSlop * b2_linearSlop)
+	{
+		b2CircleShape circleB;
+		circleB.m_p = 0.5f * (capsuleB->m_vertex1 + capsuleB->m_vertex2);
+		circleB.m_radius = capsuleB->m_radius;
+		b2CollideEdgeAndCircle(manifold, edgeA, xfA, &circleB, xfB);
+		return;
+	}
+
+	axis.Normalize();
+	b2PolygonShape polygonB;
+	polygonB.m_count = 2;
+	polygonB.m_vertices[0] = capsuleB->m_vertex1;
+	polygonB.m_vertices[1] = capsuleB->m_vertex2;
+	polygonB.m_normals[0] = b2Cross(axis, 1.0f);
+	polygonB.m_normals[1] = -polygonB.m_normals[0];
+	polygonB.m_centroid = 0.5f * (capsuleB->m_vertex1 + capsuleB->m_vertex2);
+	polygonB.m_radius = capsuleB->m_radius;
+	b2CollideEdgeAndPolygon(manifold, edgeA, xfA, &polygonB, xfB);
+}
@@ -106,6 +106,37 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 	c[1].id.cf.typeB = b2ContactFeature::e_vertex;
 }
 
+// Find the separation between poly1 and poly2 along the normal of edge1.
+static float32 b2EdgeSeparation(const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
+								const b2PolygonShape* poly2, const b2Transform& xf2)
+{
+	b2Transform xf = b2MulT(xf2, xf1);
+	b2Vec2 n = b2Mul(xf.q, poly1->m_normals[edge1]);
+	b2Vec2 v1 = b2Mul(xf, poly1->m_vertices[edge1]);
+
+	int32 count2 = poly2->m_count;
+	const b2Vec2* v2s = poly2->m_vertices;
+	float32 separation = b2_maxFloat;
+	for (int32 j = 0; j < count2; ++j)
+	{
+		separation = b2Min(separation, b2Dot(n, v2s[j] - v1));
+	}
+
+	return separation;
+}
+
+void b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB)
+{
+	b2SeparationCache cache;
+	cache.type = b2SeparationCache::e_empty;
+	b2CollidePolygons(manifold, polyA, xfA, polyB, xfB, &cache);
+}
+
+// Check the cached edge:
+//   reference edge and a similar pose - reuse it
+//   separating edge - return if it still separates
 // Find edge normal of max separation on A - return if separating axis is found
 // Find edge normal of max separation on B - return if separation axis is found
 // Choose reference edge as min(minA, minB)
@@ -115,29 +146,88 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // The normal points from 1 to 2
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2Transform& xfA,
-					  const b2PolygonShape* polyB, const b2Transform& xfB)
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  b2SeparationCache* cache)
 {
 	manifold->pointCount = 0;
 	float32 totalRadius = polyA->m_radius + polyB->m_radius;
 
-	int32 edgeA = 0;
-	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-	if (separationA > totalRadius)
-		return;
+	b2Transform xf = b2MulT(xfA, xfB);
 
+	// The polygons may have been changed since the edge was cached.
+	if (cache->type != b2SeparationCache::e_empty)
+	{
+		int32 count = cache->type == b2SeparationCache::e_faceA ? polyA->m_count : polyB->m_count;
+		if (cache->edge >= count)
+		{
+			cache->type = b2SeparationCache::e_empty;
+		}
+	}
+
+	int32 edgeA = 0;
 	int32 edgeB = 0;
-	float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-	if (separationB > totalRadius)
-		return;
+	bool useEdgeB;
+
+	if (cache->IsReusable(xf))
+	{
+		useEdgeB = cache->type == b2SeparationCache::e_faceB;
+		edgeA = cache->edge;
+		edgeB = cache->edge;
+	}
+	else
+	{
+		if (cache->type != b2SeparationCache::e_empty && cache->touching == false)
+		{
+			float32 separation;
+			if (cache->type == b2SeparationCache::e_faceA)
+			{
+				separation = b2EdgeSeparation(polyA, xfA, cache->edge, polyB, xfB);
+			}
+			else
+			{
+				separation = b2EdgeSeparation(polyB, xfB, cache->edge, polyA, xfA);
+			}
+
+			if (separation > totalRadius)
+			{
+				return;
+			}
+		}
+
+		cache->transform = xf;
+		cache->touching = false;
+
+		float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
+		if (separationA > totalRadius)
+		{
+			cache->type = b2SeparationCache::e_faceA;
+			cache->edge = edgeA;
+			return;
+		}
+
+		float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
+		if (separationB > totalRadius)
+		{
+			cache->type = b2SeparationCache::e_faceB;
+			cache->edge = edgeB;
+			return;
+		}
+
+		const float32 k_tol = 0.1f * b2_linearSlop;
+		useEdgeB = separationB > separationA + k_tol;
+
+		cache->type = useEdgeB ? b2SeparationCache::e_faceB : b2SeparationCache::e_faceA;
+		cache->edge = useEdgeB ? edgeB : edgeA;
+		cache->touching = true;
+	}
 
 	const b2PolygonShape* poly1;	// reference polygon
 	const b2PolygonShape* poly2;	// incident polygon
 	b2Transform xf1, xf2;
 	int32 edge1;					// reference edge
 	uint8 flip;
-	const float32 k_tol = 0.1f * b2_linearSlop;
 
-	if (separationB > separationA + k_tol)
+	if (useEdgeB)
 	{
 		poly1 = polyB;
 		poly2 = polyA;
@@ -27,6 +27,8 @@
 /// queries, and TOI queries.
 
 class b2Shape;
+class b2BoxShape;
+class b2CapsuleShape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
@@ -143,6 +145,30 @@ struct b2ClipVertex
 	b2ContactID id;
 };
 
+/// Used to warm start b2CollidePolygons. Holds the edge found by the last full
+/// separating axis search. A separating edge is tested first and ends the
+/// search if the polygons are still apart. A reference edge is reused while
+/// the relative pose stays close to the one it was found at.
+/// Set type to e_empty on the first call.
+struct b2SeparationCache
+{
+	enum Type
+	{
+		e_empty,
+		e_faceA,
+		e_faceB
+	};
+
+	/// Can the reference edge be reused with polygon B at this pose in the
+	/// frame of polygon A?
+	bool IsReusable(const b2Transform& xf) const;
+
+	b2Transform transform;	///< pose of polygon B in the frame of polygon A
+	int32 edge;				///< separating or reference edge
+	uint8 type;
+	bool touching;			///< is the edge a reference edge?
+};
+
 /// Ray-cast input data. The ray extends from p1 to p1 + maxFraction * (p2 - p1).
 struct b2RayCastInput
 {
@@ -158,6 +184,29 @@ struct b2RayCastOutput
 	float32 fraction;
 };
 
+/// This holds contact filtering data.
+struct b2Filter
+{
+	b2Filter()
+	{
+		categoryBits = 0x0001;
+		maskBits = 0xFFFF;
+		groupIndex = 0;
+	}
+
+	/// The collision category bits. Normally you would just set one bit.
+	uint16 categoryBits;
+
+	/// The collision mask bits. This states the categories that this
+	/// shape would accept for collision.
+	uint16 maskBits;
+
+	/// Collision groups allow a certain group of objects to never collide (negative)
+	/// or always collide (positive). Zero means no collision group. Non-zero group
+	/// filtering always wins against the mask bits.
+	int16 groupIndex;
+};
+
 /// An axis aligned bounding box.
 struct b2AABB
 {
@@ -230,6 +279,13 @@ void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
 					   const b2PolygonShape* polygonB, const b2Transform& xfB);
 
+/// Compute the collision manifold between two polygons, starting from the
+/// edge found by the previous call.
+void b2CollidePolygons(b2Manifold* manifold,
+					   const b2PolygonShape* polygonA, const b2Transform& xfA,
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   b2SeparationCache* cache);
+
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							   const b2EdgeShape* polygonA, const b2Transform& xfA,
@@ -240,10 +296,59 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
 							   const b2PolygonShape* circleB, const b2Transform& xfB);
 
+/// Compute the collision manifold between two boxes.
+void b2CollideBoxes(b2Manifold* manifold,
+					const b2BoxShape* boxA, const b2Transform& xfA,
+					const b2BoxShape* boxB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a box and a circle.
+void b2CollideBoxAndCircle(b2Manifold* manifold,
+						   const b2BoxShape* boxA, const b2Transform& xfA,
+						   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a polygon and a box.
+void b2CollidePolygonAndBox(b2Manifold* manifold,
+							const b2PolygonShape* polygonA, const b2Transform& xfA,
+							const b2BoxShape* boxB, const b2Transform& xfB);
+
+/// Compute the collision manifold between an edge and a box.
+void b2CollideEdgeAndBox(b2Manifold* manifold,
+						 const b2EdgeShape* edgeA, const b2Transform& xfA,
+						 const b2BoxShape* boxB, const b2Transform& xfB);
+
+/// Compute the collision manifold between two capsules.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a capsule and a circle.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a polygon and a capsule.
+void b2CollidePolygonAndCapsule(b2Manifold* manifold,
+								const b2PolygonShape* polygonA, const b2Transform& xfA,
+								const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a box and a capsule.
+void b2CollideBoxAndCapsule(b2Manifold* manifold,
+							const b2BoxShape* boxA, const b2Transform& xfA,
+							const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between an edge and a capsule.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							 const b2EdgeShape* edgeA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float32 offset, int32 vertexIndexA);
 
+/// Apply the default filtering rules: a shared non-zero group wins,
+/// otherwise the category and mask bits must accept each other.
+bool b2ShouldCollide(const b2Filter& filterA, const b2Filter& filterB);
+
 /// Determine if two generic shapes overlap.
 bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
@@ -274,4 +379,37 @@ inline bool b2TestOverlap(const b2AABB& a, const b2AABB& b)
 	return true;
 }
 
+inline bool b2SeparationCache::IsReusable(const b2Transform& xf) const
+{
+	if (type == e_empty || touching == false)
+	{
+		return false;
+	}
+
+	// Stay within the hysteresis used to pick the reference edge.
+	const float32 linearTolerance = 0.1f * b2_linearSlop;
+	const float32 angularTolerance = 0.1f * b2_angularSlop;
+
+	b2Vec2 d = xf.p - transform.p;
+	if (b2Dot(d, d) > linearTolerance * linearTolerance)
+	{
+		return false;
+	}
+
+	// Sine of the rotation since the edge was found.
+	float32 s = transform.q.c * xf.q.s - transform.q.s * xf.q.c;
+	return b2Abs(s) <= angularTolerance;
+}
+
+inline bool b2ShouldCollide(const b2Filter& filterA, const b2Filter& filterB)
+{
+	if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+	{
+		return filterA.groupIndex > 0;
+	}
+
+	bool collide = (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+	return collide;
+}
+
 #endif
@@ -17,13 +17,16 @@
 */
 
 #include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
-int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+b2ThreadLocal int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
 
 void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 {
@@ -47,6 +50,28 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		}
 		break;
 
+	case b2Shape::e_box:
+		{
+			const b2BoxShape* box = static_cast<const b2BoxShape*>(shape);
+			for (int32 i = 0; i < 4; ++i)
+			{
+				m_buffer[i] = box->GetVertex(i);
+			}
+			m_vertices = m_buffer;
+			m_count = 4;
+			m_radius = box->m_radius;
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			const b2CapsuleShape* capsule = static_cast<const b2CapsuleShape*>(shape);
+			m_vertices = &capsule->m_vertex1;
+			m_count = 2;
+			m_radius = capsule->m_radius;
+		}
+		break;
+
 	case b2Shape::e_chain:
 		{
 			const b2ChainShape* chain = static_cast<const b2ChainShape*>(shape);
@@ -68,6 +93,20 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		}
 		break;
 
+	case b2Shape::e_mesh:
+		{
+			const b2MeshShape* mesh = static_cast<const b2MeshShape*>(shape);
+			b2Assert(0 <= index && index < mesh->m_segmentCount);
+
+			m_buffer[0] = mesh->m_vertices[mesh->m_indices[2 * index + 0]];
+			m_buffer[1] = mesh->m_vertices[mesh->m_indices[2 * index + 1]];
+
+			m_vertices = m_buffer;
+			m_count = 2;
+			m_radius = mesh->m_radius;
+		}
+		break;
+
 	case b2Shape::e_edge:
 		{
 			const b2EdgeShape* edge = static_cast<const b2EdgeShape*>(shape);
@@ -46,7 +46,7 @@ struct b2DistanceProxy
 	/// Get a vertex by index. Used by b2Distance.
 	const b2Vec2& GetVertex(int32 index) const;
 
-	b2Vec2 m_buffer[2];
+	b2Vec2 m_buffer[4];
 	const b2Vec2* m_vertices;
 	int32 m_count;
 	float32 m_radius;
@@ -18,29 +18,36 @@
 
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <memory.h>
+#include <new>
+#include <algorithm>
 
-b2DynamicTree::b2DynamicTree()
+// Internal nodes store the union of the filters below them so queries can
+// skip whole subtrees. A leaf in a positive group may collide with anything
+// in its group regardless of the bits, so it contributes every bit.
+static inline b2Filter b2CombineFilters(const b2Filter& filter1, const b2Filter& filter2)
 {
-	m_root = b2_nullNode;
+	uint16 categoryBits1 = filter1.groupIndex > 0 ? 0xFFFF : filter1.categoryBits;
+	uint16 maskBits1 = filter1.groupIndex > 0 ? 0xFFFF : filter1.maskBits;
+	uint16 categoryBits2 = filter2.groupIndex > 0 ? 0xFFFF : filter2.categoryBits;
+	uint16 maskBits2 = filter2.groupIndex > 0 ? 0xFFFF : filter2.maskBits;
+
+	b2Filter filter;
+	filter.categoryBits = categoryBits1 | categoryBits2;
+	filter.maskBits = maskBits1 | maskBits2;
+	filter.groupIndex = 0;
+	return filter;
+}
 
+b2DynamicTree::b2DynamicTree()
+{
 	m_nodeCapacity = 16;
-	m_nodeCount = 0;
 	m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
-	memset(m_nodes, 0, m_nodeCapacity * sizeof(b2TreeNode));
-
-	// Build a linked list for the free list.
-	for (int32 i = 0; i < m_nodeCapacity - 1; ++i)
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
 	{
-		m_nodes[i].next = i + 1;
-		m_nodes[i].height = -1;
+		new (m_nodes + i) b2TreeNode();
 	}
-	m_nodes[m_nodeCapacity-1].next = b2_nullNode;
-	m_nodes[m_nodeCapacity-1].height = -1;
-	m_freeList = 0;
-
-	m_path = 0;
 
-	m_insertionCount = 0;
+	Clear();
 }
 
 b2DynamicTree::~b2DynamicTree()
@@ -84,6 +91,7 @@ int32 b2DynamicTree::AllocateNode()
 	m_nodes[nodeId].child2 = b2_nullNode;
 	m_nodes[nodeId].height = 0;
 	m_nodes[nodeId].userData = NULL;
+	m_nodes[nodeId].moved = false;
 	++m_nodeCount;
 	return nodeId;
 }
@@ -99,10 +107,48 @@ void b2DynamicTree::FreeNode(int32 nodeId)
 	--m_nodeCount;
 }
 
+void b2DynamicTree::Clear()
+{
+	m_root = b2_nullNode;
+	m_nodeCount = 0;
+
+	// Build a linked list for the free list.
+	for (int32 i = 0; i < m_nodeCapacity - 1; ++i)
+	{
+		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
+	}
+	m_nodes[m_nodeCapacity-1].next = b2_nullNode;
+	m_nodes[m_nodeCapacity-1].height = -1;
+	m_freeList = 0;
+
+	m_path = 0;
+
+	m_insertionCount = 0;
+}
+
+void b2DynamicTree::Copy(const b2DynamicTree& tree)
+{
+	if (m_nodeCapacity != tree.m_nodeCapacity)
+	{
+		b2Free(m_nodes);
+		m_nodeCapacity = tree.m_nodeCapacity;
+		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	}
+
+	memcpy(m_nodes, tree.m_nodes, m_nodeCapacity * sizeof(b2TreeNode));
+
+	m_root = tree.m_root;
+	m_nodeCount = tree.m_nodeCount;
+	m_freeList = tree.m_freeList;
+	m_path = tree.m_path;
+	m_insertionCount = tree.m_insertionCount;
+}
+
 // Create a proxy in the tree as a leaf node. We return the index
 // of the node instead of a pointer so that we can grow
 // the node pool.
-int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
+int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData, const b2Filter& filter)
 {
 	int32 proxyId = AllocateNode();
 
@@ -111,7 +157,9 @@ int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
 	m_nodes[proxyId].aabb.lowerBound = aabb.lowerBound - r;
 	m_nodes[proxyId].aabb.upperBound = aabb.upperBound + r;
 	m_nodes[proxyId].userData = userData;
+	m_nodes[proxyId].filter = filter;
 	m_nodes[proxyId].height = 0;
+	m_nodes[proxyId].moved = true;
 
 	InsertLeaf(proxyId);
 
@@ -127,6 +175,60 @@ void b2DynamicTree::DestroyProxy(int32 proxyId)
 	FreeNode(proxyId);
 }
 
+void b2DynamicTree::CreateProxies(const b2AABB* aabbs, void* const* userData, const b2Filter* filters,
+								  int32 count, int32* proxyIds)
+{
+	int32 leafCount = (m_nodeCount + 1) / 2;
+	if (count < leafCount)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			proxyIds[i] = CreateProxy(aabbs[i], userData[i], filters[i]);
+		}
+		return;
+	}
+
+	// Allocate unlinked leaves. The rebuild collects them with the others.
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = AllocateNode();
+		m_nodes[proxyId].aabb.lowerBound = aabbs[i].lowerBound - r;
+		m_nodes[proxyId].aabb.upperBound = aabbs[i].upperBound + r;
+		m_nodes[proxyId].userData = userData[i];
+		m_nodes[proxyId].filter = filters[i];
+		m_nodes[proxyId].height = 0;
+		m_nodes[proxyId].moved = true;
+		proxyIds[i] = proxyId;
+	}
+
+	RebuildTopDown();
+}
+
+void b2DynamicTree::DestroyProxies(const int32* proxyIds, int32 count)
+{
+	int32 leafCount = (m_nodeCount + 1) / 2;
+	if (2 * count < leafCount)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			DestroyProxy(proxyIds[i]);
+		}
+		return;
+	}
+
+	// Free the leaves without unlinking them. The rebuild skips free nodes.
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = proxyIds[i];
+		b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+		b2Assert(m_nodes[proxyId].IsLeaf());
+		FreeNode(proxyId);
+	}
+
+	RebuildTopDown();
+}
+
 bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -170,9 +272,78 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 	m_nodes[proxyId].aabb = b;
 
 	InsertLeaf(proxyId);
+
+	m_nodes[proxyId].moved = true;
+
 	return true;
 }
 
+void b2DynamicTree::MoveProxies(const int32* proxyIds, const b2AABB* aabbs, int32 count, bool* moved)
+{
+	int32 moveCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Assert(0 <= proxyIds[i] && proxyIds[i] < m_nodeCapacity);
+		b2Assert(m_nodes[proxyIds[i]].IsLeaf());
+		moved[i] = m_nodes[proxyIds[i]].aabb.Contains(aabbs[i]) == false;
+		if (moved[i])
+		{
+			++moveCount;
+		}
+	}
+
+	int32 leafCount = (m_nodeCount + 1) / 2;
+	if (2 * moveCount < leafCount)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (moved[i])
+			{
+				MoveProxy(proxyIds[i], aabbs[i], b2Vec2_zero);
+			}
+		}
+		return;
+	}
+
+	// Refit the leaves in place. The rebuild discards the old hierarchy.
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (moved[i])
+		{
+			b2TreeNode* node = m_nodes + proxyIds[i];
+			node->aabb.lowerBound = aabbs[i].lowerBound - r;
+			node->aabb.upperBound = aabbs[i].upperBound + r;
+			node->moved = true;
+		}
+	}
+
+	RebuildTopDown();
+}
+
+void b2DynamicTree::SetFilter(int32 proxyId, const b2Filter& filter)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	b2Assert(m_nodes[proxyId].IsLeaf());
+
+	m_nodes[proxyId].filter = filter;
+
+	// Refresh the ancestor filters. Stop early once nothing changes.
+	int32 index = m_nodes[proxyId].parent;
+	while (index != b2_nullNode)
+	{
+		b2TreeNode* node = m_nodes + index;
+		b2Filter combined = b2CombineFilters(m_nodes[node->child1].filter, m_nodes[node->child2].filter);
+		if (combined.categoryBits == node->filter.categoryBits && combined.maskBits == node->filter.maskBits)
+		{
+			break;
+		}
+
+		node->filter = combined;
+		index = node->parent;
+	}
+}
+
 void b2DynamicTree::InsertLeaf(int32 leaf)
 {
 	++m_insertionCount;
@@ -306,6 +477,7 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 
 		m_nodes[index].height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
 		m_nodes[index].aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+		m_nodes[index].filter = b2CombineFilters(m_nodes[child1].filter, m_nodes[child2].filter);
 
 		index = m_nodes[index].parent;
 	}
@@ -357,6 +529,8 @@ void b2DynamicTree::RemoveLeaf(int32 leaf)
 			int32 child2 = m_nodes[index].child2;
 
 			m_nodes[index].aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+
+			m_nodes[index].filter = b2CombineFilters(m_nodes[child1].filter, m_nodes[child2].filter);
 			m_nodes[index].height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
 
 			index = m_nodes[index].parent;
@@ -434,7 +608,9 @@ int32 b2DynamicTree::Balance(int32 iA)
 			A->child2 = iG;
 			G->parent = iA;
 			A->aabb.Combine(B->aabb, G->aabb);
+			A->filter = b2CombineFilters(B->filter, G->filter);
 			C->aabb.Combine(A->aabb, F->aabb);
+			C->filter = b2CombineFilters(A->filter, F->filter);
 
 			A->height = 1 + b2Max(B->height, G->height);
 			C->height = 1 + b2Max(A->height, F->height);
@@ -445,7 +621,9 @@ int32 b2DynamicTree::Balance(int32 iA)
 			A->child2 = iF;
 			F->parent = iA;
 			A->aabb.Combine(B->aabb, F->aabb);
+			A->filter = b2CombineFilters(B->filter, F->filter);
 			C->aabb.Combine(A->aabb, G->aabb);
+			C->filter = b2CombineFilters(A->filter, G->filter);
 
 			A->height = 1 + b2Max(B->height, F->height);
 			C->height = 1 + b2Max(A->height, G->height);
@@ -494,7 +672,9 @@ int32 b2DynamicTree::Balance(int32 iA)
 			A->child1 = iE;
 			E->parent = iA;
 			A->aabb.Combine(C->aabb, E->aabb);
+			A->filter = b2CombineFilters(C->filter, E->filter);
 			B->aabb.Combine(A->aabb, D->aabb);
+			B->filter = b2CombineFilters(A->filter, D->filter);
 
 			A->height = 1 + b2Max(C->height, E->height);
 			B->height = 1 + b2Max(A->height, D->height);
@@ -505,7 +685,9 @@ int32 b2DynamicTree::Balance(int32 iA)
 			A->child1 = iD;
 			D->parent = iA;
 			A->aabb.Combine(C->aabb, D->aabb);
+			A->filter = b2CombineFilters(C->filter, D->filter);
 			B->aabb.Combine(A->aabb, E->aabb);
+			B->filter = b2CombineFilters(A->filter, E->filter);
 
 			A->height = 1 + b2Max(C->height, D->height);
 			B->height = 1 + b2Max(A->height, E->height);
@@ -646,6 +828,10 @@ void b2DynamicTree::ValidateMetrics(int32 index) const
 	b2Assert(aabb.lowerBound == node->aabb.lowerBound);
 	b2Assert(aabb.upperBound == node->aabb.upperBound);
 
+	b2Filter filter = b2CombineFilters(m_nodes[child1].filter, m_nodes[child2].filter);
+	b2Assert(filter.categoryBits == node->filter.categoryBits);
+	b2Assert(filter.maskBits == node->filter.maskBits);
+
 	ValidateMetrics(child1);
 	ValidateMetrics(child2);
 }
@@ -751,6 +937,7 @@ void b2DynamicTree::RebuildBottomUp()
 		parent->child2 = index2;
 		parent->height = 1 + b2Max(child1->height, child2->height);
 		parent->aabb.Combine(child1->aabb, child2->aabb);
+		parent->filter = b2CombineFilters(child1->filter, child2->filter);
 		parent->parent = b2_nullNode;
 
 		child1->parent = parentIndex;
@@ -767,6 +954,208 @@ void b2DynamicTree::RebuildBottomUp()
 	Validate();
 }
 
+// Orders leaves by the center of their AABB along one axis.
+struct b2TreeCenterLessThan
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		return nodes[a].aabb.GetCenter()(axis) < nodes[b].aabb.GetCenter()(axis);
+	}
+
+	const b2TreeNode* nodes;
+	int32 axis;
+};
+
+void b2DynamicTree::RebuildTopDown()
+{
+	if (m_nodeCount == 0)
+	{
+		m_root = b2_nullNode;
+		return;
+	}
+
+	int32* leaves = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 count = 0;
+
+	// Build array of leaves. Free the rest.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// free node in pool
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			m_nodes[i].parent = b2_nullNode;
+			leaves[count] = i;
+			++count;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	if (count == 0)
+	{
+		m_root = b2_nullNode;
+		b2Free(leaves);
+		return;
+	}
+
+	m_root = BuildTopDown(leaves, count, 0);
+	m_nodes[m_root].parent = b2_nullNode;
+
+	b2Free(leaves);
+
+	Validate();
+}
+
+// Split the leaves using binned SAH on the widest axis of the leaf centers.
+// Deep or degenerate splits fall back to the median so the recursion stays
+// logarithmic.
+int32 b2DynamicTree::BuildTopDown(int32* leaves, int32 count, int32 depth)
+{
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 c = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, c);
+		upper = b2Max(upper, c);
+	}
+
+	b2Vec2 extent = upper - lower;
+	int32 axis = extent.x >= extent.y ? 0 : 1;
+	float32 minCenter = lower(axis);
+	float32 range = extent(axis);
+
+	int32 split = 0;
+
+	const int32 maxSAHDepth = 32;
+	if (range > 0.0f && depth < maxSAHDepth)
+	{
+		const int32 binCount = 16;
+		// Bounds start out inverted so the first combine assigns them.
+		b2AABB empty;
+		empty.lowerBound.Set(b2_maxFloat, b2_maxFloat);
+		empty.upperBound.Set(-b2_maxFloat, -b2_maxFloat);
+
+		b2AABB binAABBs[binCount];
+		int32 binCounts[binCount];
+		for (int32 i = 0; i < binCount; ++i)
+		{
+			binAABBs[i] = empty;
+			binCounts[i] = 0;
+		}
+
+		float32 binScale = binCount / range;
+		for (int32 i = 0; i < count; ++i)
+		{
+			const b2AABB& aabb = m_nodes[leaves[i]].aabb;
+			int32 bin = b2Min(int32(binScale * (aabb.GetCenter()(axis) - minCenter)), binCount - 1);
+			binAABBs[bin].Combine(aabb);
+			++binCounts[bin];
+		}
+
+		// Sweep from the right to get the cost of every right side.
+		float32 rightCosts[binCount];
+		b2AABB right = empty;
+		int32 rightCount = 0;
+		for (int32 i = binCount - 1; i > 0; --i)
+		{
+			if (binCounts[i] > 0)
+			{
+				right.Combine(binAABBs[i]);
+				rightCount += binCounts[i];
+			}
+			rightCosts[i] = rightCount > 0 ? rightCount * right.GetPerimeter() : 0.0f;
+		}
+
+		// Sweep from the left and pick the cheapest plane.
+		float32 bestCost = b2_maxFloat;
+		int32 bestBin = -1;
+		b2AABB left = empty;
+		int32 leftCount = 0;
+		for (int32 i = 0; i < binCount - 1; ++i)
+		{
+			if (binCounts[i] > 0)
+			{
+				left.Combine(binAABBs[i]);
+				leftCount += binCounts[i];
+			}
+
+			if (leftCount == 0 || leftCount == count)
+			{
+				continue;
+			}
+
+			float32 cost = leftCount * left.GetPerimeter() + rightCosts[i + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestBin = i;
+			}
+		}
+
+		if (bestBin != -1)
+		{
+			// Partition in place.
+			int32 i = 0, j = count - 1;
+			while (i <= j)
+			{
+				const b2AABB& aabb = m_nodes[leaves[i]].aabb;
+				int32 bin = b2Min(int32(binScale * (aabb.GetCenter()(axis) - minCenter)), binCount - 1);
+				if (bin <= bestBin)
+				{
+					++i;
+				}
+				else
+				{
+					b2Swap(leaves[i], leaves[j]);
+					--j;
+				}
+			}
+			split = i;
+		}
+	}
+
+	if (split == 0 || split == count)
+	{
+		split = count / 2;
+		b2TreeCenterLessThan lessThan;
+		lessThan.nodes = m_nodes;
+		lessThan.axis = axis;
+		std::nth_element(leaves, leaves + split, leaves + count, lessThan);
+	}
+
+	int32 index1 = BuildTopDown(leaves, split, depth + 1);
+	int32 index2 = BuildTopDown(leaves + split, count - split, depth + 1);
+
+	int32 parentIndex = AllocateNode();
+	b2TreeNode* parent = m_nodes + parentIndex;
+	b2TreeNode* child1 = m_nodes + index1;
+	b2TreeNode* child2 = m_nodes + index2;
+	parent->child1 = index1;
+	parent->child2 = index2;
+	parent->height = 1 + b2Max(child1->height, child2->height);
+	parent->aabb.Combine(child1->aabb, child2->aabb);
+	parent->filter = b2CombineFilters(child1->filter, child2->filter);
+	parent->parent = b2_nullNode;
+
+	child1->parent = parentIndex;
+	child2->parent = parentIndex;
+
+	return parentIndex;
+}
+
 void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	// Build array of leaves. Free the rest.
@@ -48,6 +48,12 @@ struct b2TreeNode
 
 	// leaf = 0, free node = -1
 	int32 height;
+
+	/// Collision filter. Internal nodes hold the union of their leaves.
+	b2Filter filter;
+
+	// The proxy was created or re-inserted since the last pair update.
+	bool moved;
 };
 
 /// A dynamic AABB tree broad-phase, inspired by Nathanael Presson's btDbvt.
@@ -68,29 +74,72 @@ public:
 	~b2DynamicTree();
 
 	/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
-	int32 CreateProxy(const b2AABB& aabb, void* userData);
+	/// The filter is only used by filtered queries.
+	int32 CreateProxy(const b2AABB& aabb, void* userData, const b2Filter& filter = b2Filter());
 
 	/// Destroy a proxy. This asserts if the id is invalid.
 	void DestroyProxy(int32 proxyId);
 
+	/// Create proxies in bulk. When the batch is at least as large as the tree,
+	/// the tree is rebuilt top down once instead of inserting each leaf.
+	void CreateProxies(const b2AABB* aabbs, void* const* userData, const b2Filter* filters,
+						int32 count, int32* proxyIds);
+
+	/// Destroy proxies in bulk. When at least half of the leaves go away, the
+	/// remaining leaves are rebuilt top down instead of removing each leaf.
+	void DestroyProxies(const int32* proxyIds, int32 count);
+
+	/// Destroy all proxies. The node pool is kept.
+	void Clear();
+
+	/// Make this tree an exact copy of another tree. The node pool is copied
+	/// as one block, so proxy ids are preserved. User data is copied as is.
+	void Copy(const b2DynamicTree& tree);
+
 	/// Move a proxy with a swepted AABB. If the proxy has moved outside of its fattened AABB,
 	/// then the proxy is removed from the tree and re-inserted. Otherwise
 	/// the function returns immediately.
 	/// @return true if the proxy was re-inserted.
 	bool MoveProxy(int32 proxyId, const b2AABB& aabb1, const b2Vec2& displacement);
 
+	/// Move proxies in bulk without displacement prediction, as for teleports.
+	/// Proxies that leave their fattened AABB are flagged in moved. When at
+	/// least half of the leaves move, the tree is rebuilt top down once.
+	void MoveProxies(const int32* proxyIds, const b2AABB* aabbs, int32 count, bool* moved);
+
 	/// Get proxy user data.
 	/// @return the proxy user data or 0 if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
 
+	/// Set proxy user data.
+	void SetUserData(int32 proxyId, void* userData);
+
 	/// Get the fat AABB for a proxy.
 	const b2AABB& GetFatAABB(int32 proxyId) const;
 
+	/// Get the collision filter of a proxy.
+	const b2Filter& GetFilter(int32 proxyId) const;
+
+	/// Change the collision filter of a proxy. This updates the ancestors.
+	void SetFilter(int32 proxyId, const b2Filter& filter);
+
+	/// Was the proxy created or re-inserted since ClearMoved was last called?
+	bool WasMoved(int32 proxyId) const;
+
+	/// Clear the moved flag of a proxy.
+	void ClearMoved(int32 proxyId);
+
 	/// Query an AABB for overlapping proxies. The callback class
 	/// is called for each proxy that overlaps the supplied AABB.
 	template <typename T>
 	void Query(T* callback, const b2AABB& aabb) const;
 
+	/// Query an AABB for overlapping proxies that pass the default filtering
+	/// rules against the supplied filter. Subtrees whose combined filter
+	/// cannot match are skipped.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb, const b2Filter& filter) const;
+
 	/// Ray-cast against the proxies in the tree. This relies on the callback
 	/// to perform a exact ray-cast in the case were the proxy contains a shape.
 	/// The callback also performs the any collision filtering. This has performance
@@ -118,6 +167,11 @@ public:
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
+	/// Build a high quality tree top down using the surface area heuristic.
+	/// This takes O(N log N) time and keeps all proxy ids. Use it for proxies
+	/// that rarely move, such as static level geometry.
+	void RebuildTopDown();
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -133,6 +187,8 @@ private:
 
 	int32 Balance(int32 index);
 
+	int32 BuildTopDown(int32* leaves, int32 count, int32 depth);
+
 	int32 ComputeHeight() const;
 	int32 ComputeHeight(int32 nodeId) const;
 
@@ -159,12 +215,36 @@ inline void* b2DynamicTree::GetUserData(int32 proxyId) const
 	return m_nodes[proxyId].userData;
 }
 
+inline void b2DynamicTree::SetUserData(int32 proxyId, void* userData)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	m_nodes[proxyId].userData = userData;
+}
+
 inline const b2AABB& b2DynamicTree::GetFatAABB(int32 proxyId) const
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
 	return m_nodes[proxyId].aabb;
 }
 
+inline const b2Filter& b2DynamicTree::GetFilter(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	return m_nodes[proxyId].filter;
+}
+
+inline bool b2DynamicTree::WasMoved(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	return m_nodes[proxyId].moved;
+}
+
+inline void b2DynamicTree::ClearMoved(int32 proxyId)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	m_nodes[proxyId].moved = false;
+}
+
 template <typename T>
 inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 {
@@ -200,6 +280,48 @@ inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 	}
 }
 
+template <typename T>
+inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb, const b2Filter& filter) const
+{
+	// A positive group may match leaves in the same group whatever their bits.
+	uint16 categoryBits = filter.groupIndex > 0 ? 0xFFFF : filter.categoryBits;
+	uint16 maskBits = filter.groupIndex > 0 ? 0xFFFF : filter.maskBits;
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2TreeNode* node = m_nodes + nodeId;
+
+		if (node->IsLeaf())
+		{
+			if (b2ShouldCollide(node->filter, filter) && b2TestOverlap(node->aabb, aabb))
+			{
+				bool proceed = callback->QueryCallback(nodeId);
+				if (proceed == false)
+				{
+					return;
+				}
+			}
+		}
+		else if ((node->filter.maskBits & categoryBits) != 0 && (node->filter.categoryBits & maskBits) != 0)
+		{
+			if (b2TestOverlap(node->aabb, aabb))
+			{
+				stack.Push(node->child1);
+				stack.Push(node->child2);
+			}
+		}
+	}
+}
+
 template <typename T>
 inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) const
 {
@@ -0,0 +1,159 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2HashSet.h>
+#include <memory.h>
+
+// Thomas Wang's 64 bit to 32 bit hash.
+static inline uint32 b2KeyHash(uint64 key)
+{
+	key = (~key) + (key << 18);
+	key = key ^ (key >> 31);
+	key = key * 21;
+	key = key ^ (key >> 11);
+	key = key + (key << 6);
+	key = key ^ (key >> 22);
+	return (uint32)key;
+}
+
+b2HashSet::b2HashSet()
+{
+	m_capacity = 16;
+	m_count = 0;
+	m_keys = (uint64*)b2Alloc(m_capacity * sizeof(uint64));
+	memset(m_keys, 0, m_capacity * sizeof(uint64));
+}
+
+b2HashSet::~b2HashSet()
+{
+	b2Free(m_keys);
+}
+
+void b2HashSet::Clear()
+{
+	memset(m_keys, 0, m_capacity * sizeof(uint64));
+	m_count = 0;
+}
+
+void b2HashSet::Copy(const b2HashSet& set)
+{
+	// The slots depend on the capacity, so it must match.
+	if (m_capacity != set.m_capacity)
+	{
+		b2Free(m_keys);
+		m_capacity = set.m_capacity;
+		m_keys = (uint64*)b2Alloc(m_capacity * sizeof(uint64));
+	}
+
+	memcpy(m_keys, set.m_keys, m_capacity * sizeof(uint64));
+	m_count = set.m_count;
+}
+
+// Returns the slot holding the key or the empty slot where it belongs.
+int32 b2HashSet::FindSlot(uint64 key) const
+{
+	uint32 mask = m_capacity - 1;
+	uint32 index = b2KeyHash(key) & mask;
+	while (m_keys[index] != 0 && m_keys[index] != key)
+	{
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+void b2HashSet::Grow()
+{
+	uint64* oldKeys = m_keys;
+	int32 oldCapacity = m_capacity;
+
+	m_capacity *= 2;
+	m_keys = (uint64*)b2Alloc(m_capacity * sizeof(uint64));
+	memset(m_keys, 0, m_capacity * sizeof(uint64));
+
+	for (int32 i = 0; i < oldCapacity; ++i)
+	{
+		if (oldKeys[i] != 0)
+		{
+			m_keys[FindSlot(oldKeys[i])] = oldKeys[i];
+		}
+	}
+
+	b2Free(oldKeys);
+}
+
+bool b2HashSet::AddKey(uint64 key)
+{
+	b2Assert(key != 0);
+
+	int32 index = FindSlot(key);
+	if (m_keys[index] == key)
+	{
+		return true;
+	}
+
+	// Keep the load factor at or below one half.
+	if (2 * (m_count + 1) > m_capacity)
+	{
+		Grow();
+		index = FindSlot(key);
+	}
+
+	m_keys[index] = key;
+	++m_count;
+	return false;
+}
+
+bool b2HashSet::RemoveKey(uint64 key)
+{
+	b2Assert(key != 0);
+
+	uint32 mask = m_capacity - 1;
+	uint32 index = FindSlot(key);
+	if (m_keys[index] == 0)
+	{
+		return false;
+	}
+
+	// Shift back entries of the same probe run that would no longer be
+	// reachable through the emptied slot.
+	uint32 hole = index;
+	uint32 next = (hole + 1) & mask;
+	while (m_keys[next] != 0)
+	{
+		uint32 home = b2KeyHash(m_keys[next]) & mask;
+
+		// Move the entry if its home slot is not cyclically in (hole, next].
+		bool reachable = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+		if (reachable == false)
+		{
+			m_keys[hole] = m_keys[next];
+			hole = next;
+		}
+
+		next = (next + 1) & mask;
+	}
+
+	m_keys[hole] = 0;
+	--m_count;
+	return true;
+}
+
+bool b2HashSet::ContainsKey(uint64 key) const
+{
+	return m_keys[FindSlot(key)] == key;
+}
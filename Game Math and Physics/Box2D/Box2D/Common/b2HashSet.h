@@ -0,0 +1,68 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HASH_SET_H
+#define B2_HASH_SET_H
+
+#include <Box2D/Common/b2Settings.h>
+
+/// Build a key for an unordered pair of ids. The key is never zero for
+/// two different non-negative ids.
+inline uint64 b2PairKey(int32 idA, int32 idB)
+{
+	return idA < idB ? (uint64)idA << 32 | (uint64)idB : (uint64)idB << 32 | (uint64)idA;
+}
+
+/// A set of 64-bit keys using open addressing with linear probing. Zero is
+/// reserved for empty slots. Removal shifts the following entries back, so
+/// there are no tombstones and lookups stay short at any churn.
+class b2HashSet
+{
+public:
+	b2HashSet();
+	~b2HashSet();
+
+	/// Add a key. Returns true if the key was already present.
+	bool AddKey(uint64 key);
+
+	/// Remove a key. Returns true if the key was present.
+	bool RemoveKey(uint64 key);
+
+	/// Is the key in the set?
+	bool ContainsKey(uint64 key) const;
+
+	/// Remove all keys. The memory is kept.
+	void Clear();
+
+	/// Make this set a copy of another set.
+	void Copy(const b2HashSet& set);
+
+	/// Get the number of keys in the set.
+	int32 GetCount() const { return m_count; }
+
+private:
+
+	int32 FindSlot(uint64 key) const;
+	void Grow();
+
+	uint64* m_keys;
+	int32 m_capacity;
+	int32 m_count;
+};
+
+#endif
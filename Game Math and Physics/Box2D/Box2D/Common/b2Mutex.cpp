@@ -0,0 +1,140 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Mutex.h>
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+b2Mutex::b2Mutex()
+{
+	CRITICAL_SECTION* section = (CRITICAL_SECTION*)b2Alloc(sizeof(CRITICAL_SECTION));
+	InitializeCriticalSection(section);
+	m_handle = section;
+}
+
+b2Mutex::~b2Mutex()
+{
+	DeleteCriticalSection((CRITICAL_SECTION*)m_handle);
+	b2Free(m_handle);
+}
+
+void b2Mutex::Lock()
+{
+	EnterCriticalSection((CRITICAL_SECTION*)m_handle);
+}
+
+void b2Mutex::Unlock()
+{
+	LeaveCriticalSection((CRITICAL_SECTION*)m_handle);
+}
+
+void b2MemoryBarrier()
+{
+	MemoryBarrier();
+}
+
+uint32 b2AtomicLoad(const uint32* value)
+{
+	// The interlocked functions are full barriers.
+	return (uint32)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+}
+
+void b2AtomicStore(uint32* value, uint32 x)
+{
+	InterlockedExchange((volatile LONG*)value, (LONG)x);
+}
+
+#elif defined(__linux__) || defined (__APPLE__)
+
+#include <pthread.h>
+
+b2Mutex::b2Mutex()
+{
+	pthread_mutex_t* mutex = (pthread_mutex_t*)b2Alloc(sizeof(pthread_mutex_t));
+	pthread_mutex_init(mutex, NULL);
+	m_handle = mutex;
+}
+
+b2Mutex::~b2Mutex()
+{
+	pthread_mutex_destroy((pthread_mutex_t*)m_handle);
+	b2Free(m_handle);
+}
+
+void b2Mutex::Lock()
+{
+	pthread_mutex_lock((pthread_mutex_t*)m_handle);
+}
+
+void b2Mutex::Unlock()
+{
+	pthread_mutex_unlock((pthread_mutex_t*)m_handle);
+}
+
+void b2MemoryBarrier()
+{
+	__sync_synchronize();
+}
+
+uint32 b2AtomicLoad(const uint32* value)
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void b2AtomicStore(uint32* value, uint32 x)
+{
+	__atomic_store_n(value, x, __ATOMIC_RELEASE);
+}
+
+#else
+
+b2Mutex::b2Mutex()
+{
+	m_handle = NULL;
+}
+
+b2Mutex::~b2Mutex()
+{
+}
+
+void b2Mutex::Lock()
+{
+}
+
+void b2Mutex::Unlock()
+{
+}
+
+void b2MemoryBarrier()
+{
+}
+
+uint32 b2AtomicLoad(const uint32* value)
+{
+	return *value;
+}
+
+void b2AtomicStore(uint32* value, uint32 x)
+{
+	*value = x;
+}
+
+#endif
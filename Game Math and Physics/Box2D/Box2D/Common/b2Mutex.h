@@ -0,0 +1,58 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_MUTEX_H
+#define B2_MUTEX_H
+
+#include <Box2D/Common/b2Settings.h>
+
+/// A mutual exclusion lock. This has platform specific code. On platforms
+/// without thread support the lock does nothing.
+class b2Mutex
+{
+public:
+	b2Mutex();
+	~b2Mutex();
+
+	/// Block until the lock is acquired.
+	void Lock();
+
+	/// Release the lock.
+	void Unlock();
+
+private:
+
+	b2Mutex(const b2Mutex&);
+	b2Mutex& operator=(const b2Mutex&);
+
+	void* m_handle;
+};
+
+/// Full memory barrier. Loads and stores are not moved across this call by
+/// the compiler or the processor.
+void b2MemoryBarrier();
+
+/// Atomically load a value that other threads store to. Loads and stores that
+/// follow are not moved before the load (acquire).
+uint32 b2AtomicLoad(const uint32* value);
+
+/// Atomically store a value that other threads load. Loads and stores that
+/// precede are not moved after the store (release).
+void b2AtomicStore(uint32* value, uint32 x);
+
+#endif
@@ -26,12 +26,21 @@
 #define B2_NOT_USED(x) ((void)(x))
 #define b2Assert(A) assert(A)
 
+// Each thread gets its own copy of a variable declared with this, so that
+// worlds can be stepped on several threads at once.
+#if defined(_MSC_VER)
+#define b2ThreadLocal __declspec(thread)
+#else
+#define b2ThreadLocal __thread
+#endif
+
 typedef signed char	int8;
 typedef signed short int16;
 typedef signed int int32;
 typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint32;
+typedef unsigned long long uint64;
 typedef float float32;
 typedef double float64;
 
@@ -85,6 +94,9 @@ typedef double float64;
 /// Maximum number of contacts to be handled to solve a TOI impact.
 #define b2_maxTOIContacts			32
 
+/// The largest step divisor of a body. See b2BodyDef::stepDivisor.
+#define b2_maxStepDivisor			8
+
 /// A velocity threshold for elastic collisions. Any collision with a relative linear
 /// velocity below this threshold will be treated as inelastic.
 #define b2_velocityThreshold		1.0f
@@ -97,6 +109,10 @@ typedef double float64;
 /// prevent overshoot.
 #define b2_maxAngularCorrection		(8.0f / 180.0f * b2_pi)
 
+/// The maximum body rotation of a single articulation position step. The exact
+/// tree projection is linearized, so large steps can overshoot.
+#define b2_maxArticulationRotation	(2.0f / 180.0f * b2_pi)
+
 /// The maximum linear velocity of a body. This limit is very large and is used
 /// to prevent numerical problems. You shouldn't need to adjust this.
 #define b2_maxTranslation			2.0f
@@ -125,6 +141,16 @@ typedef double float64;
 /// A body cannot sleep if its angular velocity is above this tolerance.
 #define b2_angularSleepTolerance	(2.0f / 180.0f * b2_pi)
 
+// Adaptive iterations
+
+/// With adaptive iterations, an island stops its velocity iterations once no
+/// body's linear velocity changes more than this in one iteration.
+#define b2_linearIterationTolerance		0.001f
+
+/// With adaptive iterations, an island stops its velocity iterations once no
+/// body's angular velocity changes more than this in one iteration.
+#define b2_angularIterationTolerance	(0.2f / 180.0f * b2_pi)
+
 // Memory Allocation
 
 /// Implement this function to use your own memory allocator.
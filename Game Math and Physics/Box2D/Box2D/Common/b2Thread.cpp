@@ -0,0 +1,250 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Thread.h>
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+struct b2ThreadStart
+{
+	b2ThreadFunction* function;
+	void* data;
+};
+
+static DWORD WINAPI b2ThreadMain(LPVOID parameter)
+{
+	b2ThreadStart start = *(b2ThreadStart*)parameter;
+	b2Free(parameter);
+	start.function(start.data);
+	return 0;
+}
+
+b2Thread::b2Thread()
+{
+	m_handle = NULL;
+}
+
+b2Thread::~b2Thread()
+{
+	Join();
+}
+
+bool b2Thread::Start(b2ThreadFunction* function, void* data)
+{
+	b2Assert(m_handle == NULL);
+
+	b2ThreadStart* start = (b2ThreadStart*)b2Alloc(sizeof(b2ThreadStart));
+	start->function = function;
+	start->data = data;
+
+	m_handle = CreateThread(NULL, 0, b2ThreadMain, start, 0, NULL);
+	if (m_handle == NULL)
+	{
+		b2Free(start);
+		return false;
+	}
+
+	return true;
+}
+
+void b2Thread::Join()
+{
+	if (m_handle)
+	{
+		WaitForSingleObject((HANDLE)m_handle, INFINITE);
+		CloseHandle((HANDLE)m_handle);
+		m_handle = NULL;
+	}
+}
+
+b2Semaphore::b2Semaphore()
+{
+	m_handle = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+}
+
+b2Semaphore::~b2Semaphore()
+{
+	CloseHandle((HANDLE)m_handle);
+}
+
+void b2Semaphore::Signal(int32 count)
+{
+	ReleaseSemaphore((HANDLE)m_handle, count, NULL);
+}
+
+void b2Semaphore::Wait()
+{
+	WaitForSingleObject((HANDLE)m_handle, INFINITE);
+}
+
+#elif defined(__linux__) || defined (__APPLE__)
+
+#include <pthread.h>
+
+struct b2ThreadStart
+{
+	b2ThreadFunction* function;
+	void* data;
+};
+
+static void* b2ThreadMain(void* parameter)
+{
+	b2ThreadStart start = *(b2ThreadStart*)parameter;
+	b2Free(parameter);
+	start.function(start.data);
+	return NULL;
+}
+
+b2Thread::b2Thread()
+{
+	m_handle = NULL;
+}
+
+b2Thread::~b2Thread()
+{
+	Join();
+}
+
+bool b2Thread::Start(b2ThreadFunction* function, void* data)
+{
+	b2Assert(m_handle == NULL);
+
+	b2ThreadStart* start = (b2ThreadStart*)b2Alloc(sizeof(b2ThreadStart));
+	start->function = function;
+	start->data = data;
+
+	pthread_t* thread = (pthread_t*)b2Alloc(sizeof(pthread_t));
+	if (pthread_create(thread, NULL, b2ThreadMain, start) != 0)
+	{
+		b2Free(thread);
+		b2Free(start);
+		return false;
+	}
+
+	m_handle = thread;
+	return true;
+}
+
+void b2Thread::Join()
+{
+	if (m_handle)
+	{
+		pthread_join(*(pthread_t*)m_handle, NULL);
+		b2Free(m_handle);
+		m_handle = NULL;
+	}
+}
+
+// Unnamed POSIX semaphores are not available everywhere, so the semaphore
+// is built from a mutex and a condition variable.
+struct b2SemaphoreData
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	int32 count;
+};
+
+b2Semaphore::b2Semaphore()
+{
+	b2SemaphoreData* semaphore = (b2SemaphoreData*)b2Alloc(sizeof(b2SemaphoreData));
+	pthread_mutex_init(&semaphore->mutex, NULL);
+	pthread_cond_init(&semaphore->condition, NULL);
+	semaphore->count = 0;
+	m_handle = semaphore;
+}
+
+b2Semaphore::~b2Semaphore()
+{
+	b2SemaphoreData* semaphore = (b2SemaphoreData*)m_handle;
+	pthread_cond_destroy(&semaphore->condition);
+	pthread_mutex_destroy(&semaphore->mutex);
+	b2Free(semaphore);
+}
+
+void b2Semaphore::Signal(int32 count)
+{
+	b2SemaphoreData* semaphore = (b2SemaphoreData*)m_handle;
+	pthread_mutex_lock(&semaphore->mutex);
+	semaphore->count += count;
+	if (count == 1)
+	{
+		pthread_cond_signal(&semaphore->condition);
+	}
+	else
+	{
+		pthread_cond_broadcast(&semaphore->condition);
+	}
+	pthread_mutex_unlock(&semaphore->mutex);
+}
+
+void b2Semaphore::Wait()
+{
+	b2SemaphoreData* semaphore = (b2SemaphoreData*)m_handle;
+	pthread_mutex_lock(&semaphore->mutex);
+	while (semaphore->count == 0)
+	{
+		pthread_cond_wait(&semaphore->condition, &semaphore->mutex);
+	}
+	--semaphore->count;
+	pthread_mutex_unlock(&semaphore->mutex);
+}
+
+#else
+
+b2Thread::b2Thread()
+{
+	m_handle = NULL;
+}
+
+b2Thread::~b2Thread()
+{
+}
+
+bool b2Thread::Start(b2ThreadFunction* function, void* data)
+{
+	B2_NOT_USED(function);
+	B2_NOT_USED(data);
+	return false;
+}
+
+void b2Thread::Join()
+{
+}
+
+b2Semaphore::b2Semaphore()
+{
+	m_handle = NULL;
+}
+
+b2Semaphore::~b2Semaphore()
+{
+}
+
+void b2Semaphore::Signal(int32 count)
+{
+	B2_NOT_USED(count);
+}
+
+void b2Semaphore::Wait()
+{
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_H
+#define B2_THREAD_H
+
+#include <Box2D/Common/b2Settings.h>
+
+typedef void b2ThreadFunction(void* data);
+
+/// A thread of execution. This has platform specific code. On platforms
+/// without thread support a thread cannot be started.
+class b2Thread
+{
+public:
+	b2Thread();
+
+	/// Joins the thread if it is running.
+	~b2Thread();
+
+	/// Run function(data) on a new thread.
+	/// @return false if the thread could not be started.
+	bool Start(b2ThreadFunction* function, void* data);
+
+	/// Block until the thread returns.
+	void Join();
+
+private:
+
+	b2Thread(const b2Thread&);
+	b2Thread& operator=(const b2Thread&);
+
+	void* m_handle;
+};
+
+/// A counting semaphore. This has platform specific code. On platforms
+/// without thread support waiting on a semaphore does not block.
+class b2Semaphore
+{
+public:
+	b2Semaphore();
+	~b2Semaphore();
+
+	/// Increase the count, releasing up to count waiting threads.
+	void Signal(int32 count = 1);
+
+	/// Block until the count is positive, then decrease it.
+	void Wait();
+
+private:
+
+	b2Semaphore(const b2Semaphore&);
+	b2Semaphore& operator=(const b2Semaphore&);
+
+	void* m_handle;
+};
+
+#endif
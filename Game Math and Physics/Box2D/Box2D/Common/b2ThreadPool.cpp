@@ -0,0 +1,141 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Math.h>
+#include <new>
+
+b2ThreadPool::b2ThreadPool()
+{
+	m_workers = NULL;
+	m_threadCount = 0;
+	m_exit = false;
+	m_task = NULL;
+	m_count = 0;
+	m_rangeSize = 1;
+	m_next = 0;
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	StopThreads();
+}
+
+void b2ThreadPool::StopThreads()
+{
+	m_exit = true;
+	m_start.Signal(m_threadCount);
+
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		m_workers[i].thread.Join();
+		m_workers[i].~Worker();
+	}
+	b2Free(m_workers);
+
+	m_workers = NULL;
+	m_threadCount = 0;
+	m_exit = false;
+}
+
+void b2ThreadPool::SetThreadCount(int32 threadCount)
+{
+	b2Assert(threadCount >= 0);
+
+	StopThreads();
+
+	if (threadCount == 0)
+	{
+		return;
+	}
+
+	m_workers = (Worker*)b2Alloc(threadCount * sizeof(Worker));
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		Worker* worker = new (m_workers + i) Worker;
+		worker->pool = this;
+		worker->index = i + 1;
+		if (worker->thread.Start(ThreadMain, worker) == false)
+		{
+			worker->~Worker();
+			break;
+		}
+
+		++m_threadCount;
+	}
+}
+
+void b2ThreadPool::Run(b2ThreadTask* task, int32 count, int32 rangeSize)
+{
+	b2Assert(rangeSize > 0);
+
+	m_task = task;
+	m_count = count;
+	m_rangeSize = rangeSize;
+	m_next = 0;
+
+	// Only wake the threads that can get a range.
+	int32 rangeCount = (count + rangeSize - 1) / rangeSize;
+	int32 threadCount = b2Min(m_threadCount, rangeCount - 1);
+
+	m_start.Signal(threadCount);
+	Work(0);
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		m_done.Wait();
+	}
+
+	m_task = NULL;
+}
+
+void b2ThreadPool::ThreadMain(void* data)
+{
+	Worker* worker = (Worker*)data;
+	b2ThreadPool* pool = worker->pool;
+	for (;;)
+	{
+		pool->m_start.Wait();
+		if (pool->m_exit)
+		{
+			break;
+		}
+
+		pool->Work(worker->index);
+		pool->m_done.Signal();
+	}
+}
+
+// Run ranges until there are none left.
+void b2ThreadPool::Work(int32 threadIndex)
+{
+	for (;;)
+	{
+		m_mutex.Lock();
+		int32 begin = m_next;
+		m_next += m_rangeSize;
+		m_mutex.Unlock();
+
+		if (begin >= m_count)
+		{
+			break;
+		}
+
+		int32 end = b2Min(begin + m_rangeSize, m_count);
+		m_task->Run(begin, end, threadIndex);
+	}
+}
@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Mutex.h>
+#include <Box2D/Common/b2Thread.h>
+
+/// A task split into ranges of items. Ranges may run on several threads at
+/// once, so a task must only write data that belongs to its range.
+class b2ThreadTask
+{
+public:
+	virtual ~b2ThreadTask() {}
+
+	/// Run the items in [begin, end). The thread index is zero for the
+	/// thread that runs the task and in [1, b2ThreadPool::GetThreadCount()]
+	/// for the worker threads.
+	virtual void Run(int32 begin, int32 end, int32 threadIndex) = 0;
+};
+
+/// Worker threads that help the calling thread run a task. The items of a
+/// task are handed out in ranges of a fixed size, so the ranges are the
+/// same with any number of threads.
+class b2ThreadPool
+{
+public:
+	/// Construct a pool without worker threads.
+	b2ThreadPool();
+
+	/// Stops the threads.
+	~b2ThreadPool();
+
+	/// Stop the current worker threads and start the given number of new ones.
+	/// With zero threads tasks run on the calling thread only.
+	void SetThreadCount(int32 threadCount);
+
+	/// Get the number of worker threads that were started.
+	int32 GetThreadCount() const;
+
+	/// Run a task over count items in ranges of rangeSize items. This blocks
+	/// until all ranges are run.
+	void Run(b2ThreadTask* task, int32 count, int32 rangeSize);
+
+private:
+
+	struct Worker
+	{
+		b2ThreadPool* pool;
+		int32 index;
+		b2Thread thread;
+	};
+
+	b2ThreadPool(const b2ThreadPool&);
+	b2ThreadPool& operator=(const b2ThreadPool&);
+
+	static void ThreadMain(void* data);
+	void Work(int32 threadIndex);
+	void StopThreads();
+
+	Worker* m_workers;
+	int32 m_threadCount;
+
+	b2Semaphore m_start;
+	b2Semaphore m_done;
+	b2Mutex m_mutex;
+	bool m_exit;
+
+	b2ThreadTask* m_task;
+	int32 m_count;
+	int32 m_rangeSize;
+	int32 m_next;
+};
+
+inline int32 b2ThreadPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+#endif
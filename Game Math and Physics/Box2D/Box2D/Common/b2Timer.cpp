@@ -80,7 +80,12 @@ float32 b2Timer::GetMilliseconds() const
 {
     timeval t;
     gettimeofday(&t, 0);
-    return 1000.0f * (t.tv_sec - m_start_sec) + 0.001f * (t.tv_usec - m_start_usec);
+
+    // The start is unsigned, so subtract as signed values to avoid wrapping
+    // around when the microseconds are less than at the start.
+    long seconds = long(t.tv_sec) - long(m_start_sec);
+    long microseconds = long(t.tv_usec) - long(m_start_usec);
+    return 1000.0f * seconds + 0.001f * microseconds;
 }
 
 #else
@@ -47,4 +47,25 @@ private:
 #endif
 };
 
+/// A timer that compiles to nothing when it is disabled. Step policies use this
+/// to leave profiling out of the solver.
+template <bool enabled>
+class b2OptionalTimer
+{
+public:
+	void Reset() { m_timer.Reset(); }
+	float32 GetMilliseconds() const { return m_timer.GetMilliseconds(); }
+
+private:
+	b2Timer m_timer;
+};
+
+template <>
+class b2OptionalTimer<false>
+{
+public:
+	void Reset() {}
+	float32 GetMilliseconds() const { return 0.0f; }
+};
+
 #endif
@@ -24,6 +24,21 @@
 #include <Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2BoxContact.h>
+#include <Box2D/Dynamics/Contacts/b2BoxAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2PolygonAndBoxContact.h>
+#include <Box2D/Dynamics/Contacts/b2EdgeAndBoxContact.h>
+#include <Box2D/Dynamics/Contacts/b2ChainAndBoxContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2PolygonAndCapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2BoxAndCapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2EdgeAndCapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2ChainAndCapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2MeshAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2MeshAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2MeshAndBoxContact.h>
+#include <Box2D/Dynamics/Contacts/b2MeshAndCapsuleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 
 #include <Box2D/Collision/b2Collision.h>
@@ -33,39 +48,61 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2ContactEvents.h>
+
+#include <new>
 
 b2ContactRegister b2Contact::s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 bool b2Contact::s_initialized = false;
 
-void b2Contact::InitializeRegisters()
-{
-	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2Shape::e_circle, b2Shape::e_circle);
-	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2Shape::e_polygon, b2Shape::e_circle);
-	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, b2Shape::e_polygon, b2Shape::e_polygon);
-	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2Shape::e_edge, b2Shape::e_circle);
-	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
-	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
-	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
-}
-
-void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
-						b2Shape::Type type1, b2Shape::Type type2)
+template <typename T>
+void b2Contact::AddType(b2Shape::Type type1, b2Shape::Type type2)
 {
 	b2Assert(0 <= type1 && type1 < b2Shape::e_typeCount);
 	b2Assert(0 <= type2 && type2 < b2Shape::e_typeCount);
 	
-	s_registers[type1][type2].createFcn = createFcn;
-	s_registers[type1][type2].destroyFcn = destoryFcn;
+	s_registers[type1][type2].createFcn = T::Create;
+	s_registers[type1][type2].destroyFcn = T::Destroy;
+	s_registers[type1][type2].updateFcn = UpdateContacts<T>;
+	s_registers[type1][type2].cloneFcn = Clone<T>;
 	s_registers[type1][type2].primary = true;
 
 	if (type1 != type2)
 	{
-		s_registers[type2][type1].createFcn = createFcn;
-		s_registers[type2][type1].destroyFcn = destoryFcn;
+		s_registers[type2][type1].createFcn = T::Create;
+		s_registers[type2][type1].destroyFcn = T::Destroy;
+		s_registers[type2][type1].updateFcn = NULL;
+		s_registers[type2][type1].cloneFcn = Clone<T>;
 		s_registers[type2][type1].primary = false;
 	}
 }
 
+void b2Contact::InitializeRegisters()
+{
+	AddType<b2CircleContact>(b2Shape::e_circle, b2Shape::e_circle);
+	AddType<b2PolygonAndCircleContact>(b2Shape::e_polygon, b2Shape::e_circle);
+	AddType<b2PolygonContact>(b2Shape::e_polygon, b2Shape::e_polygon);
+	AddType<b2EdgeAndCircleContact>(b2Shape::e_edge, b2Shape::e_circle);
+	AddType<b2EdgeAndPolygonContact>(b2Shape::e_edge, b2Shape::e_polygon);
+	AddType<b2ChainAndCircleContact>(b2Shape::e_chain, b2Shape::e_circle);
+	AddType<b2ChainAndPolygonContact>(b2Shape::e_chain, b2Shape::e_polygon);
+	AddType<b2BoxContact>(b2Shape::e_box, b2Shape::e_box);
+	AddType<b2BoxAndCircleContact>(b2Shape::e_box, b2Shape::e_circle);
+	AddType<b2PolygonAndBoxContact>(b2Shape::e_polygon, b2Shape::e_box);
+	AddType<b2EdgeAndBoxContact>(b2Shape::e_edge, b2Shape::e_box);
+	AddType<b2ChainAndBoxContact>(b2Shape::e_chain, b2Shape::e_box);
+	AddType<b2CapsuleContact>(b2Shape::e_capsule, b2Shape::e_capsule);
+	AddType<b2CapsuleAndCircleContact>(b2Shape::e_capsule, b2Shape::e_circle);
+	AddType<b2PolygonAndCapsuleContact>(b2Shape::e_polygon, b2Shape::e_capsule);
+	AddType<b2BoxAndCapsuleContact>(b2Shape::e_box, b2Shape::e_capsule);
+	AddType<b2EdgeAndCapsuleContact>(b2Shape::e_edge, b2Shape::e_capsule);
+	AddType<b2ChainAndCapsuleContact>(b2Shape::e_chain, b2Shape::e_capsule);
+	AddType<b2MeshAndCircleContact>(b2Shape::e_mesh, b2Shape::e_circle);
+	AddType<b2MeshAndPolygonContact>(b2Shape::e_mesh, b2Shape::e_polygon);
+	AddType<b2MeshAndBoxContact>(b2Shape::e_mesh, b2Shape::e_box);
+	AddType<b2MeshAndCapsuleContact>(b2Shape::e_mesh, b2Shape::e_capsule);
+}
+
 b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
 {
 	if (s_initialized == false)
@@ -123,6 +160,24 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 	destroyFcn(contact, allocator);
 }
 
+b2Contact* b2Contact::Clone(const b2Contact* contact, b2BlockAllocator* allocator)
+{
+	b2Assert(s_initialized == true);
+
+	b2Shape::Type typeA = contact->m_fixtureA->GetType();
+	b2Shape::Type typeB = contact->m_fixtureB->GetType();
+
+	b2ContactCloneFcn* cloneFcn = s_registers[typeA][typeB].cloneFcn;
+	return cloneFcn(contact, allocator);
+}
+
+template <typename T>
+b2Contact* b2Contact::Clone(const b2Contact* contact, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(T));
+	return new (mem) T(*static_cast<const T*>(contact));
+}
+
 b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 {
 	m_flags = e_enabledFlag;
@@ -133,6 +188,8 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_indexA = indexA;
 	m_indexB = indexB;
 
+	m_pairIndex = -1;
+
 	m_manifold.pointCount = 0;
 
 	m_prev = NULL;
@@ -156,9 +213,39 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_tangentSpeed = 0.0f;
 }
 
+// Evaluate a contact of type T without virtual dispatch.
+template <typename T>
+inline void b2EvaluateContact(b2Contact* contact, b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
+{
+	static_cast<T*>(contact)->T::Evaluate(manifold, xfA, xfB);
+}
+
+// The contact type is not known.
+template <>
+inline void b2EvaluateContact<b2Contact>(b2Contact* contact, b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
+{
+	contact->Evaluate(manifold, xfA, xfB);
+}
+
+void b2Contact::Update(b2ContactListener* listener, b2ContactEvents* events)
+{
+	Update<b2Contact>(listener, events);
+}
+
+template <typename T>
+void b2Contact::UpdateContacts(b2Contact** contacts, int32 count,
+							   b2ContactListener* listener, b2ContactEvents* events)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		contacts[i]->Update<T>(listener, events);
+	}
+}
+
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+template <typename T>
+void b2Contact::Update(b2ContactListener* listener, b2ContactEvents* events)
 {
 	b2Manifold oldManifold = m_manifold;
 
@@ -182,14 +269,23 @@ void b2Contact::Update(b2ContactListener* listener)
 	{
 		const b2Shape* shapeA = m_fixtureA->GetShape();
 		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+
+		// The proxy AABBs bound the current child shapes, so run GJK only
+		// when they overlap. Mesh segments share the first proxy.
+		int32 proxyIndexA = shapeA->GetType() == b2Shape::e_mesh ? 0 : m_indexA;
+		int32 proxyIndexB = shapeB->GetType() == b2Shape::e_mesh ? 0 : m_indexB;
+		touching = b2TestOverlap(m_fixtureA->m_proxies[proxyIndexA].aabb, m_fixtureB->m_proxies[proxyIndexB].aabb);
+		if (touching)
+		{
+			touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+		}
 
 		// Sensors don't generate manifolds.
 		m_manifold.pointCount = 0;
 	}
 	else
 	{
-		Evaluate(&m_manifold, xfA, xfB);
+		b2EvaluateContact<T>(this, &m_manifold, xfA, xfB);
 		touching = m_manifold.pointCount > 0;
 
 		// Match old contact ids to new contact ids and copy the
@@ -230,14 +326,30 @@ void b2Contact::Update(b2ContactListener* listener)
 		m_flags &= ~e_touchingFlag;
 	}
 
-	if (wasTouching == false && touching == true && listener)
+	if (wasTouching == false && touching == true)
 	{
-		listener->BeginContact(this);
+		if (listener)
+		{
+			listener->BeginContact(this);
+		}
+
+		if (events)
+		{
+			events->AddBeginEvent(this);
+		}
 	}
 
-	if (wasTouching == true && touching == false && listener)
+	if (wasTouching == true && touching == false)
 	{
-		listener->EndContact(this);
+		if (listener)
+		{
+			listener->EndContact(this);
+		}
+
+		if (events)
+		{
+			events->AddEndEvent(this);
+		}
 	}
 
 	if (sensor == false && touching && listener)
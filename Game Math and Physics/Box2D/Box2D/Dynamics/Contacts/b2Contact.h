@@ -31,6 +31,7 @@ class b2World;
 class b2BlockAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+class b2ContactEvents;
 
 /// Friction mixing law. The idea is to allow either fixture to drive the restitution to zero.
 /// For example, anything slides on ice.
@@ -50,11 +51,16 @@ typedef b2Contact* b2ContactCreateFcn(	b2Fixture* fixtureA, int32 indexA,
 										b2Fixture* fixtureB, int32 indexB,
 										b2BlockAllocator* allocator);
 typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
+typedef b2Contact* b2ContactCloneFcn(const b2Contact* contact, b2BlockAllocator* allocator);
+typedef void b2ContactUpdateFcn(b2Contact** contacts, int32 count,
+								b2ContactListener* listener, b2ContactEvents* events);
 
 struct b2ContactRegister
 {
 	b2ContactCreateFcn* createFcn;
 	b2ContactDestroyFcn* destroyFcn;
+	b2ContactUpdateFcn* updateFcn;
+	b2ContactCloneFcn* cloneFcn;
 	bool primary;
 };
 
@@ -150,6 +156,8 @@ protected:
 	friend class b2ContactSolver;
 	friend class b2Body;
 	friend class b2Fixture;
+	friend class b2ContactEvents;
+	friend class b2WorldPool;
 
 	// Flags stored in m_flags
 	enum
@@ -163,9 +171,6 @@ protected:
 		// This contact can be disabled (by user)
 		e_enabledFlag		= 0x0004,
 
-		// This contact needs filtering because a fixture filter was changed.
-		e_filterFlag		= 0x0008,
-
 		// This bullet contact had a TOI event
 		e_bulletHitFlag		= 0x0010,
 
@@ -173,21 +178,34 @@ protected:
 		e_toiFlag			= 0x0020
 	};
 
-	/// Flag this contact for filtering. Filtering will occur the next time step.
-	void FlagForFiltering();
-
-	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
-						b2Shape::Type typeA, b2Shape::Type typeB);
+	template <typename T>
+	static void AddType(b2Shape::Type typeA, b2Shape::Type typeB);
 	static void InitializeRegisters();
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
 
+	// Copy a contact including its cached collision state. The copy still
+	// points to the fixtures and bodies of the original.
+	static b2Contact* Clone(const b2Contact* contact, b2BlockAllocator* allocator);
+
+	template <typename T>
+	static b2Contact* Clone(const b2Contact* contact, b2BlockAllocator* allocator);
+
 	b2Contact() : m_fixtureA(NULL), m_fixtureB(NULL) {}
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	void Update(b2ContactListener* listener, b2ContactEvents* events);
+
+	// Same as Update for a contact known to be a T, so Evaluate is called directly.
+	template <typename T>
+	void Update(b2ContactListener* listener, b2ContactEvents* events);
+
+	// Update a run of contacts that are all of type T.
+	template <typename T>
+	static void UpdateContacts(b2Contact** contacts, int32 count,
+							   b2ContactListener* listener, b2ContactEvents* events);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
@@ -208,6 +226,9 @@ protected:
 	int32 m_indexA;
 	int32 m_indexB;
 
+	// Index of the contact pair in the contact manager.
+	int32 m_pairIndex;
+
 	b2Manifold m_manifold;
 
 	int32 m_toiCount;
@@ -301,11 +322,6 @@ inline int32 b2Contact::GetChildIndexB() const
 	return m_indexB;
 }
 
-inline void b2Contact::FlagForFiltering()
-{
-	m_flags |= e_filterFlag;
-}
-
 inline void b2Contact::SetFriction(float32 friction)
 {
 	m_friction = friction;
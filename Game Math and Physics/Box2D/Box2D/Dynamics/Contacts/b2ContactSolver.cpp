@@ -51,6 +51,7 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_maxPointCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -69,6 +70,7 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 		int32 pointCount = manifold->pointCount;
 		b2Assert(pointCount > 0);
+		m_maxPointCount = b2Max(m_maxPointCount, pointCount);
 
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 		vc->friction = contact->m_friction;
@@ -286,6 +288,7 @@ void b2ContactSolver::WarmStart()
 	}
 }
 
+template <int32 maxPointCount>
 void b2ContactSolver::SolveVelocityConstraints()
 {
 	for (int32 i = 0; i < m_count; ++i)
@@ -298,7 +301,8 @@ void b2ContactSolver::SolveVelocityConstraints()
 		float32 iA = vc->invIA;
 		float32 mB = vc->invMassB;
 		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
+		b2Assert(vc->pointCount <= maxPointCount);
+		int32 pointCount = maxPointCount == 1 ? 1 : vc->pointCount;
 
 		b2Vec2 vA = m_velocities[indexA].v;
 		float32 wA = m_velocities[indexA].w;
@@ -341,7 +345,7 @@ void b2ContactSolver::SolveVelocityConstraints()
 		}
 
 		// Solve normal constraints
-		if (vc->pointCount == 1)
+		if (pointCount == 1)
 		{
 			b2VelocityConstraintPoint* vcp = vc->points + 0;
 
@@ -663,6 +667,7 @@ struct b2PositionSolverManifold
 };
 
 // Sequential solver.
+template <int32 maxPointCount>
 bool b2ContactSolver::SolvePositionConstraints()
 {
 	float32 minSeparation = 0.0f;
@@ -679,7 +684,8 @@ bool b2ContactSolver::SolvePositionConstraints()
 		b2Vec2 localCenterB = pc->localCenterB;
 		float32 mB = pc->invMassB;
 		float32 iB = pc->invIB;
-		int32 pointCount = pc->pointCount;
+		b2Assert(pc->pointCount <= maxPointCount);
+		int32 pointCount = maxPointCount == 1 ? 1 : pc->pointCount;
 
 		b2Vec2 cA = m_positions[indexA].c;
 		float32 aA = m_positions[indexA].a;
@@ -831,3 +837,8 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 	// push the separation above -b2_linearSlop.
 	return minSeparation >= -1.5f * b2_linearSlop;
 }
+
+template void b2ContactSolver::SolveVelocityConstraints<1>();
+template void b2ContactSolver::SolveVelocityConstraints<2>();
+template bool b2ContactSolver::SolvePositionConstraints<1>();
+template bool b2ContactSolver::SolvePositionConstraints<2>();
@@ -75,10 +75,18 @@ public:
 	void InitializeVelocityConstraints();
 
 	void WarmStart();
+
+	/// Solve the velocity constraints. If maxPointCount is one the two point
+	/// block solver is compiled out, so it may only be used when
+	/// m_maxPointCount is one.
+	template <int32 maxPointCount>
 	void SolveVelocityConstraints();
+
 	void StoreImpulses();
 
+	template <int32 maxPointCount>
 	bool SolvePositionConstraints();
+
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
 	b2TimeStep m_step;
@@ -89,6 +97,7 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+	int32 m_maxPointCount;	// the most points in a manifold
 };
 
 #endif
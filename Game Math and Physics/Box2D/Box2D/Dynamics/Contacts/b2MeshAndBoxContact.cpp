@@ -0,0 +1,53 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Contacts/b2MeshAndBoxContact.h>
+#include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+
+#include <new>
+
+b2Contact* b2MeshAndBoxContact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2MeshAndBoxContact));
+	return new (mem) b2MeshAndBoxContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void b2MeshAndBoxContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2MeshAndBoxContact*)contact)->~b2MeshAndBoxContact();
+	allocator->Free(contact, sizeof(b2MeshAndBoxContact));
+}
+
+b2MeshAndBoxContact::b2MeshAndBoxContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+: b2Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	b2Assert(m_fixtureA->GetType() == b2Shape::e_mesh);
+	b2Assert(m_fixtureB->GetType() == b2Shape::e_box);
+}
+
+void b2MeshAndBoxContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
+{
+	b2MeshShape* mesh = (b2MeshShape*)m_fixtureA->GetShape();
+	b2EdgeShape edge;
+	mesh->GetChildEdge(&edge, m_indexA);
+	b2CollideEdgeAndBox(	manifold, &edge, xfA,
+							(b2BoxShape*)m_fixtureB->GetShape(), xfB);
+}
@@ -0,0 +1,533 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Joints/b2ArticulationSolver.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+// Each articulated tree gives the symmetric system
+// [M  J^T] [ dv]   [0]
+// [J   0 ] [-P ] = [c]
+// where dv is the velocity change, P holds the joint impulses and
+// c = -Cdot. Bodies and joints are the nodes of the tree and H(i,j) is
+// nonzero only if i == j or the nodes are adjacent. Ordering the nodes so
+// that children precede their parents gives a block LDL^T factorization
+// without fill-in (Baraff, Linear-Time Dynamics using Lagrange Multipliers).
+//
+// factor, children first:
+//   D_i = H(i,i) - sum over children c of H(c,i)^T D_c^-1 H(c,i)
+//   J_i = D_i^-1 H(i,parent)
+// solve:
+//   forward:  x_parent -= J_i^T x_i
+//   backward: x_i = D_i^-1 x_i - J_i x_parent
+//
+// A joint node must never be a leaf, otherwise its diagonal block is zero.
+// Static and kinematic bodies are not nodes, so a joint to the ground is
+// only allowed as the root of its tree. Additional ground joints close a loop
+// through the ground and are left to the iterative solver.
+
+struct b2ArticulationStage
+{
+	b2RevoluteJoint* joint;
+	int32 index;
+	int32 parent;
+	int32 firstEdge;
+	int32 node;
+};
+
+static int32 b2FindSet(int32* sets, int32 i)
+{
+	while (sets[i] != i)
+	{
+		sets[i] = sets[sets[i]];
+		i = sets[i];
+	}
+	return i;
+}
+
+static b2Vec3 b2MulT(const b2Mat33& A, const b2Vec3& v)
+{
+	return b2Vec3(b2Dot(A.ex, v), b2Dot(A.ey, v), b2Dot(A.ez, v));
+}
+
+static b2Mat33 b2Mul(const b2Mat33& A, const b2Mat33& B)
+{
+	return b2Mat33(b2Mul(A, B.ex), b2Mul(A, B.ey), b2Mul(A, B.ez));
+}
+
+static b2Mat33 b2MulT(const b2Mat33& A, const b2Mat33& B)
+{
+	return b2Mat33(b2MulT(A, B.ex), b2MulT(A, B.ey), b2MulT(A, B.ez));
+}
+
+static b2Mat33 b2Transpose(const b2Mat33& A)
+{
+	b2Mat33 B;
+	B.ex.Set(A.ex.x, A.ey.x, A.ez.x);
+	B.ey.Set(A.ex.y, A.ey.y, A.ez.y);
+	B.ez.Set(A.ex.z, A.ey.z, A.ez.z);
+	return B;
+}
+
+// Jacobian of the joint rows (x, y, angle) with respect to the velocity
+// (vx, vy, w) of one of the joint's bodies.
+// J = [-I -rA_skew -1] for bodyA and [I rB_skew 1] for bodyB
+static b2Mat33 b2ComputeJacobian(const b2ArticulationNode* node, bool bodyA, float32 invI)
+{
+	float32 s = bodyA ? -1.0f : 1.0f;
+	b2Vec2 r = bodyA ? node->rA : node->rB;
+
+	b2Mat33 J;
+	J.ex.Set(s, 0.0f, 0.0f);
+	J.ey.Set(0.0f, s, 0.0f);
+	if (invI > 0.0f)
+	{
+		J.ez.Set(-s * r.y, s * r.x, node->angular ? s : 0.0f);
+	}
+	else
+	{
+		J.ez.SetZero();
+	}
+	return J;
+}
+
+b2ArticulationSolver::b2ArticulationSolver(b2Joint** joints, int32 jointCount, b2Body** bodies, int32 bodyCount,
+										   b2StackAllocator* allocator)
+{
+	m_bodies = bodies;
+	m_allocator = allocator;
+	m_nodes = NULL;
+	m_nodeCount = 0;
+
+	int32 candidateCount = 0;
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		if (joints[i]->GetType() != e_revoluteJoint)
+		{
+			continue;
+		}
+
+		b2RevoluteJoint* joint = (b2RevoluteJoint*)joints[i];
+		joint->m_inArticulation = false;
+		if (joint->m_articulated)
+		{
+			++candidateCount;
+		}
+	}
+
+	if (candidateCount == 0)
+	{
+		return;
+	}
+
+	int32 capacity = bodyCount + candidateCount;
+	m_nodes = (b2ArticulationNode*)m_allocator->Allocate(capacity * sizeof(b2ArticulationNode));
+
+	b2ArticulationStage* stages = (b2ArticulationStage*)m_allocator->Allocate(capacity * sizeof(b2ArticulationStage));
+	int32* edgeTo = (int32*)m_allocator->Allocate(4 * candidateCount * sizeof(int32));
+	int32* edgeNext = (int32*)m_allocator->Allocate(4 * candidateCount * sizeof(int32));
+	int32* bodyNodes = (int32*)m_allocator->Allocate(bodyCount * sizeof(int32));
+	int32* sets = (int32*)m_allocator->Allocate((bodyCount + 1) * sizeof(int32));
+	int32* queue = (int32*)m_allocator->Allocate(capacity * sizeof(int32));
+
+	// The last set is the ground: all static and kinematic bodies.
+	int32 ground = bodyCount;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		bodyNodes[i] = -1;
+		sets[i] = i;
+	}
+	sets[ground] = ground;
+
+	// Build a spanning forest. A joint that would close a loop is skipped.
+	int32 stageCount = 0;
+	int32 edgeCount = 0;
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		if (joints[i]->GetType() != e_revoluteJoint)
+		{
+			continue;
+		}
+
+		b2RevoluteJoint* joint = (b2RevoluteJoint*)joints[i];
+		if (joint->m_articulated == false)
+		{
+			continue;
+		}
+
+		b2Body* jointBodies[2] = { joint->m_bodyA, joint->m_bodyB };
+		int32 jointSets[2];
+		for (int32 j = 0; j < 2; ++j)
+		{
+			b2Body* b = jointBodies[j];
+			jointSets[j] = b2FindSet(sets, b->m_type == b2_dynamicBody ? b->m_islandIndex : ground);
+		}
+
+		if (jointSets[0] == jointSets[1])
+		{
+			continue;
+		}
+
+		sets[jointSets[0]] = jointSets[1];
+		joint->m_inArticulation = true;
+
+		int32 jointNode = stageCount++;
+		stages[jointNode].joint = joint;
+		stages[jointNode].index = -1;
+		stages[jointNode].firstEdge = -1;
+
+		for (int32 j = 0; j < 2; ++j)
+		{
+			b2Body* b = jointBodies[j];
+			if (b->m_type != b2_dynamicBody)
+			{
+				continue;
+			}
+
+			int32 bodyNode = bodyNodes[b->m_islandIndex];
+			if (bodyNode == -1)
+			{
+				bodyNode = stageCount++;
+				stages[bodyNode].joint = NULL;
+				stages[bodyNode].index = b->m_islandIndex;
+				stages[bodyNode].firstEdge = -1;
+				bodyNodes[b->m_islandIndex] = bodyNode;
+			}
+
+			edgeTo[edgeCount] = bodyNode;
+			edgeNext[edgeCount] = stages[jointNode].firstEdge;
+			stages[jointNode].firstEdge = edgeCount++;
+
+			edgeTo[edgeCount] = jointNode;
+			edgeNext[edgeCount] = stages[bodyNode].firstEdge;
+			stages[bodyNode].firstEdge = edgeCount++;
+		}
+	}
+
+	// Breadth first order. Ground joints are visited first so they become
+	// the roots of their trees.
+	const int32 unvisited = -2;
+	for (int32 i = 0; i < stageCount; ++i)
+	{
+		stages[i].parent = unvisited;
+	}
+
+	int32 queueCount = 0;
+	for (int32 pass = 0; pass < 2; ++pass)
+	{
+		for (int32 i = 0; i < stageCount; ++i)
+		{
+			b2ArticulationStage* root = stages + i;
+			if (root->parent != unvisited)
+			{
+				continue;
+			}
+
+			if (pass == 0)
+			{
+				if (root->joint == NULL)
+				{
+					continue;
+				}
+
+				bool groundA = root->joint->m_bodyA->m_type != b2_dynamicBody;
+				bool groundB = root->joint->m_bodyB->m_type != b2_dynamicBody;
+				if (groundA == false && groundB == false)
+				{
+					continue;
+				}
+			}
+
+			int32 head = queueCount;
+			root->parent = -1;
+			queue[queueCount++] = i;
+			while (head < queueCount)
+			{
+				int32 n = queue[head++];
+				for (int32 e = stages[n].firstEdge; e != -1; e = edgeNext[e])
+				{
+					int32 t = edgeTo[e];
+					if (stages[t].parent == unvisited)
+					{
+						stages[t].parent = n;
+						queue[queueCount++] = t;
+					}
+				}
+			}
+		}
+	}
+
+	b2Assert(queueCount == stageCount);
+
+	// Store in reverse breadth first order so children precede their parents.
+	for (int32 i = 0; i < stageCount; ++i)
+	{
+		stages[queue[i]].node = stageCount - 1 - i;
+	}
+
+	m_nodeCount = stageCount;
+	for (int32 i = 0; i < stageCount; ++i)
+	{
+		b2ArticulationStage* stage = stages + i;
+		b2ArticulationNode* node = m_nodes + stage->node;
+		node->joint = stage->joint;
+		node->index = stage->index;
+		node->parent = stage->parent >= 0 ? stages[stage->parent].node : -1;
+		node->angular = false;
+	}
+
+	// Warning: the order should reverse the allocation order.
+	m_allocator->Free(queue);
+	m_allocator->Free(sets);
+	m_allocator->Free(bodyNodes);
+	m_allocator->Free(edgeNext);
+	m_allocator->Free(edgeTo);
+	m_allocator->Free(stages);
+}
+
+b2ArticulationSolver::~b2ArticulationSolver()
+{
+	if (m_nodes)
+	{
+		m_allocator->Free(m_nodes);
+	}
+}
+
+void b2ArticulationSolver::InitializeVelocityConstraints(const b2SolverData& data)
+{
+	B2_NOT_USED(data);
+
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		b2RevoluteJoint* joint = node->joint;
+		if (joint)
+		{
+			node->rA = joint->m_rA;
+			node->rB = joint->m_rB;
+			node->angular = joint->m_limitState == e_equalLimits;
+		}
+	}
+
+	Factor();
+}
+
+void b2ArticulationSolver::SolveVelocityConstraints(const b2SolverData& data)
+{
+	b2Velocity* velocities = data.velocities;
+
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		b2RevoluteJoint* joint = node->joint;
+		if (joint == NULL)
+		{
+			node->x.SetZero();
+			continue;
+		}
+
+		b2Vec2 vA = velocities[joint->m_indexA].v;
+		float32 wA = velocities[joint->m_indexA].w;
+		b2Vec2 vB = velocities[joint->m_indexB].v;
+		float32 wB = velocities[joint->m_indexB].w;
+
+		b2Vec2 Cdot1 = vB + b2Cross(wB, node->rB) - vA - b2Cross(wA, node->rA);
+		float32 Cdot2 = node->angular ? wB - wA : 0.0f;
+		node->x.Set(-Cdot1.x, -Cdot1.y, -Cdot2);
+	}
+
+	Solve();
+
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		b2RevoluteJoint* joint = node->joint;
+		if (joint)
+		{
+			// The solution holds the negated impulse.
+			joint->m_impulse.x -= node->x.x;
+			joint->m_impulse.y -= node->x.y;
+			joint->m_impulse.z -= node->x.z;
+		}
+		else
+		{
+			velocities[node->index].v += b2Vec2(node->x.x, node->x.y);
+			velocities[node->index].w += node->x.z;
+		}
+	}
+}
+
+bool b2ArticulationSolver::SolvePositionConstraints(const b2SolverData& data)
+{
+	b2Position* positions = data.positions;
+
+	float32 linearError = 0.0f;
+	float32 angularError = 0.0f;
+
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		b2RevoluteJoint* joint = node->joint;
+		if (joint == NULL)
+		{
+			node->x.SetZero();
+			continue;
+		}
+
+		b2Vec2 cA = positions[joint->m_indexA].c;
+		float32 aA = positions[joint->m_indexA].a;
+		b2Vec2 cB = positions[joint->m_indexB].c;
+		float32 aB = positions[joint->m_indexB].a;
+
+		b2Rot qA(aA), qB(aB);
+		node->rA = b2Mul(qA, joint->m_localAnchorA - joint->m_localCenterA);
+		node->rB = b2Mul(qB, joint->m_localAnchorB - joint->m_localCenterB);
+
+		b2Vec2 C1 = cB + node->rB - cA - node->rA;
+		float32 length = C1.Length();
+		linearError = b2Max(linearError, length);
+
+		// Prevent large linear corrections
+		if (length > b2_maxLinearCorrection)
+		{
+			C1 *= b2_maxLinearCorrection / length;
+		}
+
+		float32 C2 = 0.0f;
+		if (node->angular)
+		{
+			// Prevent large angular corrections
+			float32 angle = aB - aA - joint->m_referenceAngle;
+			C2 = b2Clamp(angle - joint->m_lowerAngle, -b2_maxAngularCorrection, b2_maxAngularCorrection);
+			angularError = b2Max(angularError, b2Abs(C2));
+		}
+
+		node->x.Set(-C1.x, -C1.y, -C2);
+	}
+
+	Factor();
+	Solve();
+
+	// A nearly straight chain is close to a kinematic singularity and the
+	// linearized step can swing light links far beyond the range where
+	// the linearization holds. Scale the whole step to keep it small.
+	float32 maxRotation = 0.0f;
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		if (node->joint == NULL)
+		{
+			maxRotation = b2Max(maxRotation, b2Abs(node->x.z));
+		}
+	}
+
+	float32 scale = 1.0f;
+	if (maxRotation > b2_maxArticulationRotation)
+	{
+		scale = b2_maxArticulationRotation / maxRotation;
+	}
+
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		if (node->joint == NULL)
+		{
+			positions[node->index].c += scale * b2Vec2(node->x.x, node->x.y);
+			positions[node->index].a += scale * node->x.z;
+		}
+	}
+
+	return linearError <= b2_linearSlop && angularError <= b2_angularSlop;
+}
+
+void b2ArticulationSolver::Factor()
+{
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		node->D.SetZero();
+		if (node->joint)
+		{
+			// Unused rows are decoupled.
+			node->D.ez.z = node->angular ? 0.0f : 1.0f;
+		}
+		else
+		{
+			b2Body* b = m_bodies[node->index];
+			node->D.ex.x = b->m_mass;
+			node->D.ey.y = b->m_mass;
+			node->D.ez.z = b->m_invI > 0.0f ? b->m_I : 1.0f;
+		}
+	}
+
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+
+		b2Mat33 Dinv;
+		node->D.GetSymInverse33(&Dinv);
+		node->D = Dinv;
+
+		if (node->parent == -1)
+		{
+			continue;
+		}
+
+		b2ArticulationNode* parent = m_nodes + node->parent;
+		if (node->joint)
+		{
+			b2Body* b = m_bodies[parent->index];
+			node->H = b2ComputeJacobian(node, node->joint->m_indexA == parent->index, b->m_invI);
+		}
+		else
+		{
+			b2Body* b = m_bodies[node->index];
+			node->H = b2Transpose(b2ComputeJacobian(parent, parent->joint->m_indexA == node->index, b->m_invI));
+		}
+
+		node->J = b2Mul(Dinv, node->H);
+
+		b2Mat33 S = b2MulT(node->H, node->J);
+		parent->D.ex -= S.ex;
+		parent->D.ey -= S.ey;
+		parent->D.ez -= S.ez;
+	}
+}
+
+void b2ArticulationSolver::Solve()
+{
+	for (int32 i = 0; i < m_nodeCount; ++i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		if (node->parent != -1)
+		{
+			m_nodes[node->parent].x -= b2MulT(node->J, node->x);
+		}
+	}
+
+	for (int32 i = m_nodeCount - 1; i >= 0; --i)
+	{
+		b2ArticulationNode* node = m_nodes + i;
+		node->x = b2Mul(node->D, node->x);
+		if (node->parent != -1)
+		{
+			node->x -= b2Mul(node->J, m_nodes[node->parent].x);
+		}
+	}
+}
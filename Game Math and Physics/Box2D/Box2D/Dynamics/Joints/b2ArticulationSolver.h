@@ -0,0 +1,78 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ARTICULATION_SOLVER_H
+#define B2_ARTICULATION_SOLVER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Body;
+class b2Joint;
+class b2RevoluteJoint;
+class b2StackAllocator;
+
+/// A node of the articulation tree. Bodies and joints are both nodes, so a
+/// chain of bodies alternates body, joint, body, ... Every block is embedded
+/// in a 3-by-3 matrix: (vx, vy, w) for bodies and (x, y, angle) rows for
+/// joints, with unused joint rows decoupled.
+struct b2ArticulationNode
+{
+	b2Mat33 D;		// diagonal block, holds its inverse after factoring
+	b2Mat33 H;		// block coupling this node's rows to its parent's columns
+	b2Mat33 J;		// D^-1 * H
+	b2Vec3 x;		// right hand side and solution
+	b2Vec2 rA, rB;	// joint anchors relative to the centers of mass
+	b2RevoluteJoint* joint;	// NULL for body nodes
+	int32 index;	// island index of a body node
+	int32 parent;	// parent node, always greater than this node's index
+	bool angular;	// the joint angle is fixed by equal limits
+};
+
+/// Solves the point constraints of articulated revolute joints exactly. The
+/// joints are arranged in a forest and the KKT system of each tree is
+/// factored in linear time, children before parents (Baraff 1996). This is
+/// equivalent to a reduced coordinate (Featherstone) solve but keeps the
+/// island's maximal coordinates, so contacts and other joints still use the
+/// sequential impulse solver.
+/// This is an internal class.
+class b2ArticulationSolver
+{
+public:
+	b2ArticulationSolver(b2Joint** joints, int32 jointCount, b2Body** bodies, int32 bodyCount,
+						 b2StackAllocator* allocator);
+	~b2ArticulationSolver();
+
+	/// Call after the joints have initialized their velocity constraints.
+	void InitializeVelocityConstraints(const b2SolverData& data);
+	void SolveVelocityConstraints(const b2SolverData& data);
+	bool SolvePositionConstraints(const b2SolverData& data);
+
+	int32 GetNodeCount() const { return m_nodeCount; }
+
+private:
+	void Factor();
+	void Solve();
+
+	b2Body** m_bodies;
+	b2StackAllocator* m_allocator;
+	b2ArticulationNode* m_nodes;
+	int32 m_nodeCount;
+};
+
+#endif
@@ -180,6 +180,56 @@ void b2Joint::Destroy(b2Joint* joint, b2BlockAllocator* allocator)
 	}
 }
 
+template <typename T>
+static b2Joint* b2CloneJoint(const b2Joint* joint, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(T));
+	return new (mem) T(*static_cast<const T*>(joint));
+}
+
+b2Joint* b2Joint::Clone(const b2Joint* joint, b2BlockAllocator* allocator)
+{
+	switch (joint->m_type)
+	{
+	case e_distanceJoint:
+		return b2CloneJoint<b2DistanceJoint>(joint, allocator);
+
+	case e_mouseJoint:
+		return b2CloneJoint<b2MouseJoint>(joint, allocator);
+
+	case e_prismaticJoint:
+		return b2CloneJoint<b2PrismaticJoint>(joint, allocator);
+
+	case e_revoluteJoint:
+		return b2CloneJoint<b2RevoluteJoint>(joint, allocator);
+
+	case e_pulleyJoint:
+		return b2CloneJoint<b2PulleyJoint>(joint, allocator);
+
+	case e_gearJoint:
+		return b2CloneJoint<b2GearJoint>(joint, allocator);
+
+	case e_wheelJoint:
+		return b2CloneJoint<b2WheelJoint>(joint, allocator);
+
+	case e_weldJoint:
+		return b2CloneJoint<b2WeldJoint>(joint, allocator);
+
+	case e_frictionJoint:
+		return b2CloneJoint<b2FrictionJoint>(joint, allocator);
+
+	case e_ropeJoint:
+		return b2CloneJoint<b2RopeJoint>(joint, allocator);
+
+	case e_motorJoint:
+		return b2CloneJoint<b2MotorJoint>(joint, allocator);
+
+	default:
+		b2Assert(false);
+		return NULL;
+	}
+}
+
 b2Joint::b2Joint(const b2JointDef* def)
 {
 	b2Assert(def->bodyA != def->bodyB);
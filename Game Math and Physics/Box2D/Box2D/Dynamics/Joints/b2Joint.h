@@ -158,6 +158,10 @@ protected:
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
 
+	// Copy a joint including its solver state. The copy still points to the
+	// bodies and joints of the original.
+	static b2Joint* Clone(const b2Joint* joint, b2BlockAllocator* allocator);
+
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
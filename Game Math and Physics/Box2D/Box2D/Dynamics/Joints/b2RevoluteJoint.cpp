@@ -59,6 +59,9 @@ b2RevoluteJoint::b2RevoluteJoint(const b2RevoluteJointDef* def)
 	m_enableLimit = def->enableLimit;
 	m_enableMotor = def->enableMotor;
 	m_limitState = e_inactiveLimit;
+
+	m_articulated = def->articulated;
+	m_inArticulation = false;
 }
 
 void b2RevoluteJoint::InitVelocityConstraints(const b2SolverData& data)
@@ -206,9 +209,32 @@ void b2RevoluteJoint::SolveVelocityConstraints(const b2SolverData& data)
 		wB += iB * impulse;
 	}
 
-	// Solve limit constraint.
-	if (m_enableLimit && m_limitState != e_inactiveLimit && fixedRotation == false)
+	if (m_inArticulation)
+	{
+		// The articulation solver handles the point constraint and equal limits.
+		if (m_enableLimit && fixedRotation == false &&
+			(m_limitState == e_atLowerLimit || m_limitState == e_atUpperLimit))
+		{
+			float32 Cdot = wB - wA;
+			float32 impulse = -m_motorMass * Cdot;
+			float32 oldImpulse = m_impulse.z;
+			if (m_limitState == e_atLowerLimit)
+			{
+				m_impulse.z = b2Max(m_impulse.z + impulse, 0.0f);
+			}
+			else
+			{
+				m_impulse.z = b2Min(m_impulse.z + impulse, 0.0f);
+			}
+			impulse = m_impulse.z - oldImpulse;
+
+			wA -= iA * impulse;
+			wB += iB * impulse;
+		}
+	}
+	else if (m_enableLimit && m_limitState != e_inactiveLimit && fixedRotation == false)
 	{
+		// Solve limit constraint.
 		b2Vec2 Cdot1 = vB + b2Cross(wB, m_rB) - vA - b2Cross(wA, m_rA);
 		float32 Cdot2 = wB - wA;
 		b2Vec3 Cdot(Cdot1.x, Cdot1.y, Cdot2);
@@ -498,5 +524,6 @@ void b2RevoluteJoint::Dump()
 	b2Log("  jd.enableMotor = bool(%d);\n", m_enableMotor);
 	b2Log("  jd.motorSpeed = %.15lef;\n", m_motorSpeed);
 	b2Log("  jd.maxMotorTorque = %.15lef;\n", m_maxMotorTorque);
+	b2Log("  jd.articulated = bool(%d);\n", m_articulated);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
@@ -46,6 +46,7 @@ struct b2RevoluteJointDef : public b2JointDef
 		motorSpeed = 0.0f;
 		enableLimit = false;
 		enableMotor = false;
+		articulated = false;
 	}
 
 	/// Initialize the bodies, anchors, and reference angle using a world
@@ -79,6 +80,12 @@ struct b2RevoluteJointDef : public b2JointDef
 	/// The maximum motor torque used to achieve the desired motor speed.
 	/// Usually in N-m.
 	float32 maxMotorTorque;
+
+	/// Solve the point constraint exactly as part of an articulated tree.
+	/// All articulated revolute joints in an island that form a tree are
+	/// solved together in linear time, so long chains and ragdolls do not
+	/// stretch. Joints that close a loop fall back to the iterative solver.
+	bool articulated;
 };
 
 /// A revolute joint constrains two bodies to share a common point while they
@@ -139,6 +146,9 @@ public:
 	void SetMaxMotorTorque(float32 torque);
 	float32 GetMaxMotorTorque() const { return m_maxMotorTorque; }
 
+	/// Is this joint solved by the articulation solver?
+	bool IsArticulated() const { return m_articulated; }
+
 	/// Get the reaction force given the inverse time step.
 	/// Unit is N.
 	b2Vec2 GetReactionForce(float32 inv_dt) const;
@@ -158,6 +168,7 @@ protected:
 	
 	friend class b2Joint;
 	friend class b2GearJoint;
+	friend class b2ArticulationSolver;
 
 	b2RevoluteJoint(const b2RevoluteJointDef* def);
 
@@ -180,6 +191,8 @@ protected:
 	float32 m_lowerAngle;
 	float32 m_upperAngle;
 
+	bool m_articulated;
+
 	// Solver temp
 	int32 m_indexA;
 	int32 m_indexB;
@@ -194,6 +207,7 @@ protected:
 	b2Mat33 m_mass;			// effective mass for point-to-point constraint.
 	float32 m_motorMass;	// effective mass for motor/limit angular constraint.
 	b2LimitState m_limitState;
+	bool m_inArticulation;	// point velocity constraint is solved by b2ArticulationSolver.
 };
 
 inline float32 b2RevoluteJoint::GetMotorSpeed() const
@@ -83,6 +83,12 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_sleepTime = 0.0f;
 
+	b2Assert(1 <= bd->stepDivisor && bd->stepDivisor <= b2_maxStepDivisor);
+	m_stepDivisor = bd->stepDivisor;
+	m_stepsPending = 0;
+	m_targetCenter = m_sweep.c;
+	m_targetAngle = m_sweep.a;
+
 	m_type = bd->type;
 
 	if (m_type == b2_dynamicBody)
@@ -123,6 +129,9 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	// Static proxies live in their own broad-phase tree.
+	bool moveProxies = (m_type == b2_staticBody) != (type == b2_staticBody);
+
 	m_type = type;
 
 	ResetMassData();
@@ -155,6 +164,14 @@ void b2Body::SetType(b2BodyType type)
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
+		if (moveProxies && f->m_proxyCount > 0)
+		{
+			// New proxies are reported as moved.
+			f->DestroyProxies(broadPhase);
+			f->CreateProxies(broadPhase, m_xf);
+			continue;
+		}
+
 		int32 proxyCount = f->m_proxyCount;
 		for (int32 i = 0; i < proxyCount; ++i)
 		{
@@ -280,6 +297,9 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
 void b2Body::ResetMassData()
 {
+	// Moving the center of mass abandons any coarse step in progress.
+	m_stepsPending = 0;
+
 	// Compute mass data from shapes. Each shape has its own density.
 	m_mass = 0.0f;
 	m_invMass = 0.0f;
@@ -386,6 +406,7 @@ void b2Body::SetMassData(const b2MassData* massData)
 	b2Vec2 oldCenter = m_sweep.c;
 	m_sweep.localCenter =  massData->center;
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	m_stepsPending = 0;
 
 	// Update center of mass velocity.
 	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
@@ -430,6 +451,7 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 
 	m_sweep.c0 = m_sweep.c;
 	m_sweep.a0 = angle;
+	m_stepsPending = 0;
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -477,14 +499,8 @@ void b2Body::SetActive(bool flag)
 	{
 		m_flags &= ~e_activeFlag;
 
-		// Destroy all proxies.
-		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
-		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
-		{
-			f->DestroyProxies(broadPhase);
-		}
-
-		// Destroy the attached contacts.
+		// Destroy the attached contacts. This must happen before the proxies
+		// go away because contacts are keyed on proxy ids.
 		b2ContactEdge* ce = m_contactList;
 		while (ce)
 		{
@@ -493,6 +509,13 @@ void b2Body::SetActive(bool flag)
 			m_world->m_contactManager.Destroy(ce0->contact);
 		}
 		m_contactList = NULL;
+
+		// Destroy all proxies.
+		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+		{
+			f->DestroyProxies(broadPhase);
+		}
 	}
 }
 
@@ -537,6 +560,7 @@ void b2Body::Dump()
 	b2Log("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
 	b2Log("  bd.active = bool(%d);\n", m_flags & e_activeFlag);
 	b2Log("  bd.gravityScale = %.15lef;\n", m_gravityScale);
+	b2Log("  bd.stepDivisor = %d;\n", m_stepDivisor);
 	b2Log("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
 	b2Log("\n");
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
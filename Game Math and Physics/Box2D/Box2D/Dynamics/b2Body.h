@@ -67,6 +67,7 @@ struct b2BodyDef
 		type = b2_staticBody;
 		active = true;
 		gravityScale = 1.0f;
+		stepDivisor = 1;
 	}
 
 	/// The body type: static, kinematic, or dynamic.
@@ -120,6 +121,15 @@ struct b2BodyDef
 
 	/// Scale the gravity applied to this body.
 	float32 gravityScale;
+
+	/// Solve this body only every stepDivisor steps, using a time step that is
+	/// stepDivisor times larger, and move it smoothly in between. Use this for
+	/// bodies far from the action. An island is solved at the rate of its fastest
+	/// body, so a body touching a full rate body is solved at full rate. Setting
+	/// the transform or velocity, or applying a force or impulse, ends the coarse
+	/// step so the body is solved again in the next step. The divisor must be
+	/// in [1, b2_maxStepDivisor].
+	int32 stepDivisor;
 };
 
 /// A rigid body. These are created via b2World::CreateBody.
@@ -299,6 +309,12 @@ public:
 	/// Set the gravity scale of the body.
 	void SetGravityScale(float32 scale);
 
+	/// Get the step divisor of this body.
+	int32 GetStepDivisor() const;
+
+	/// Set the step divisor of this body. See b2BodyDef::stepDivisor.
+	void SetStepDivisor(int32 divisor);
+
 	/// Set the type of this body. This may alter the mass and velocity.
 	void SetType(b2BodyType type);
 
@@ -390,6 +406,8 @@ private:
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
 	friend class b2Contact;
+	friend class b2ArticulationSolver;
+	friend struct b2ForceFieldQuery;
 	
 	friend class b2DistanceJoint;
 	friend class b2FrictionJoint;
@@ -412,7 +430,8 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_fieldFlag			= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -463,6 +482,13 @@ private:
 
 	float32 m_sleepTime;
 
+	// Multi-rate stepping. A body solved with a divided rate moves towards the
+	// end of its coarse step over the following steps.
+	int32 m_stepDivisor;
+	int32 m_stepsPending;
+	b2Vec2 m_targetCenter;
+	float32 m_targetAngle;
+
 	void* m_userData;
 };
 
@@ -509,6 +535,7 @@ inline void b2Body::SetLinearVelocity(const b2Vec2& v)
 	}
 
 	m_linearVelocity = v;
+	m_stepsPending = 0;
 }
 
 inline const b2Vec2& b2Body::GetLinearVelocity() const
@@ -529,6 +556,7 @@ inline void b2Body::SetAngularVelocity(float32 w)
 	}
 
 	m_angularVelocity = w;
+	m_stepsPending = 0;
 }
 
 inline float32 b2Body::GetAngularVelocity() const
@@ -613,6 +641,17 @@ inline void b2Body::SetGravityScale(float32 scale)
 	m_gravityScale = scale;
 }
 
+inline int32 b2Body::GetStepDivisor() const
+{
+	return m_stepDivisor;
+}
+
+inline void b2Body::SetStepDivisor(int32 divisor)
+{
+	b2Assert(1 <= divisor && divisor <= b2_maxStepDivisor);
+	m_stepDivisor = divisor;
+}
+
 inline void b2Body::SetBullet(bool flag)
 {
 	if (flag)
@@ -644,6 +683,7 @@ inline void b2Body::SetAwake(bool flag)
 	{
 		m_flags &= ~e_awakeFlag;
 		m_sleepTime = 0.0f;
+		m_stepsPending = 0;
 		m_linearVelocity.SetZero();
 		m_angularVelocity = 0.0f;
 		m_force.SetZero();
@@ -751,6 +791,7 @@ inline void b2Body::ApplyForce(const b2Vec2& force, const b2Vec2& point, bool wa
 	{
 		m_force += force;
 		m_torque += b2Cross(point - m_sweep.c, force);
+		m_stepsPending = 0;
 	}
 }
 
@@ -770,6 +811,7 @@ inline void b2Body::ApplyForceToCenter(const b2Vec2& force, bool wake)
 	if (m_flags & e_awakeFlag)
 	{
 		m_force += force;
+		m_stepsPending = 0;
 	}
 }
 
@@ -789,6 +831,7 @@ inline void b2Body::ApplyTorque(float32 torque, bool wake)
 	if (m_flags & e_awakeFlag)
 	{
 		m_torque += torque;
+		m_stepsPending = 0;
 	}
 }
 
@@ -809,6 +852,7 @@ inline void b2Body::ApplyLinearImpulse(const b2Vec2& impulse, const b2Vec2& poin
 	{
 		m_linearVelocity += m_invMass * impulse;
 		m_angularVelocity += m_invI * b2Cross(point - m_sweep.c, impulse);
+		m_stepsPending = 0;
 	}
 }
 
@@ -828,6 +872,7 @@ inline void b2Body::ApplyAngularImpulse(float32 impulse, bool wake)
 	if (m_flags & e_awakeFlag)
 	{
 		m_angularVelocity += m_invI * impulse;
+		m_stepsPending = 0;
 	}
 }
 
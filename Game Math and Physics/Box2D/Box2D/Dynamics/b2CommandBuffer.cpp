@@ -0,0 +1,273 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2CommandBuffer.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Collision/Shapes/b2Shape.h>
+#include <algorithm>
+#include <string.h>
+
+template <typename T>
+static T* b2AddCommand(T** commands, int32* count, int32* capacity)
+{
+	if (*count == *capacity)
+	{
+		T* oldCommands = *commands;
+		*capacity = *capacity > 0 ? 2 * *capacity : 16;
+		*commands = (T*)b2Alloc(*capacity * sizeof(T));
+		if (oldCommands)
+		{
+			memcpy(*commands, oldCommands, *count * sizeof(T));
+			b2Free(oldCommands);
+		}
+	}
+
+	T* command = *commands + *count;
+	++*count;
+	return command;
+}
+
+b2CommandBuffer::b2CommandBuffer()
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		Queue* queue = m_queues + i;
+
+		queue->creates = NULL;
+		queue->createCount = 0;
+		queue->createCapacity = 0;
+
+		queue->destroys = NULL;
+		queue->destroyCount = 0;
+		queue->destroyCapacity = 0;
+
+		queue->transforms = NULL;
+		queue->transformCount = 0;
+		queue->transformCapacity = 0;
+
+		queue->impulses = NULL;
+		queue->impulseCount = 0;
+		queue->impulseCapacity = 0;
+
+		queue->actives = NULL;
+		queue->activeCount = 0;
+		queue->activeCapacity = 0;
+	}
+
+	m_record = m_queues;
+}
+
+b2CommandBuffer::~b2CommandBuffer()
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		Queue* queue = m_queues + i;
+		Clear(queue);
+
+		b2Free(queue->creates);
+		b2Free(queue->destroys);
+		b2Free(queue->transforms);
+		b2Free(queue->impulses);
+		b2Free(queue->actives);
+	}
+}
+
+void b2CommandBuffer::CreateBody(const b2BodyDef& def, const b2FixtureDef* fixtureDef, b2Body** body)
+{
+	m_mutex.Lock();
+
+	CreateCommand* command = b2AddCommand(&m_record->creates, &m_record->createCount, &m_record->createCapacity);
+	command->bodyDef = def;
+	if (fixtureDef && fixtureDef->shape)
+	{
+		command->fixtureDef = *fixtureDef;
+		command->fixtureDef.shape = fixtureDef->shape->Clone(&m_record->allocator);
+	}
+	else
+	{
+		command->fixtureDef = b2FixtureDef();
+	}
+	command->body = body;
+
+	m_mutex.Unlock();
+}
+
+void b2CommandBuffer::DestroyBody(b2Body* body)
+{
+	m_mutex.Lock();
+
+	b2Body** command = b2AddCommand(&m_record->destroys, &m_record->destroyCount, &m_record->destroyCapacity);
+	*command = body;
+
+	m_mutex.Unlock();
+}
+
+void b2CommandBuffer::SetTransform(b2Body* body, const b2Vec2& position, float32 angle)
+{
+	m_mutex.Lock();
+
+	TransformCommand* command = b2AddCommand(&m_record->transforms, &m_record->transformCount, &m_record->transformCapacity);
+	command->body = body;
+	command->transform[0] = position.x;
+	command->transform[1] = position.y;
+	command->transform[2] = angle;
+
+	m_mutex.Unlock();
+}
+
+void b2CommandBuffer::ApplyLinearImpulse(b2Body* body, const b2Vec2& impulse, const b2Vec2& point)
+{
+	m_mutex.Lock();
+
+	ImpulseCommand* command = b2AddCommand(&m_record->impulses, &m_record->impulseCount, &m_record->impulseCapacity);
+	command->body = body;
+	command->linearImpulse = impulse;
+	command->point = point;
+	command->angularImpulse = 0.0f;
+
+	m_mutex.Unlock();
+}
+
+void b2CommandBuffer::ApplyAngularImpulse(b2Body* body, float32 impulse)
+{
+	m_mutex.Lock();
+
+	ImpulseCommand* command = b2AddCommand(&m_record->impulses, &m_record->impulseCount, &m_record->impulseCapacity);
+	command->body = body;
+	command->linearImpulse.SetZero();
+	command->point.SetZero();
+	command->angularImpulse = impulse;
+
+	m_mutex.Unlock();
+}
+
+void b2CommandBuffer::SetActive(b2Body* body, bool flag)
+{
+	m_mutex.Lock();
+
+	ActiveCommand* command = b2AddCommand(&m_record->actives, &m_record->activeCount, &m_record->activeCapacity);
+	command->body = body;
+	command->flag = flag;
+
+	m_mutex.Unlock();
+}
+
+void b2CommandBuffer::Apply(b2World* world)
+{
+	// Swap the queues so other threads can keep recording while this one applies.
+	m_mutex.Lock();
+	Queue* queue = m_record;
+	m_record = queue == m_queues ? m_queues + 1 : m_queues;
+	m_mutex.Unlock();
+
+	if (queue->createCount > 0)
+	{
+		int32 count = queue->createCount;
+		b2StackAllocator* stack = world->m_stack;
+		b2BodyDef* bodyDefs = (b2BodyDef*)stack->Allocate(count * sizeof(b2BodyDef));
+		b2FixtureDef* fixtureDefs = (b2FixtureDef*)stack->Allocate(count * sizeof(b2FixtureDef));
+		b2Body** bodies = (b2Body**)stack->Allocate(count * sizeof(b2Body*));
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			bodyDefs[i] = queue->creates[i].bodyDef;
+			fixtureDefs[i] = queue->creates[i].fixtureDef;
+		}
+
+		world->CreateBodies(bodyDefs, count, bodies, fixtureDefs);
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (queue->creates[i].body)
+			{
+				*queue->creates[i].body = bodies[i];
+			}
+		}
+
+		stack->Free(bodies);
+		stack->Free(fixtureDefs);
+		stack->Free(bodyDefs);
+	}
+
+	for (int32 i = 0; i < queue->activeCount; ++i)
+	{
+		queue->actives[i].body->SetActive(queue->actives[i].flag);
+	}
+
+	if (queue->transformCount > 0)
+	{
+		int32 count = queue->transformCount;
+		b2StackAllocator* stack = world->m_stack;
+		b2Body** bodies = (b2Body**)stack->Allocate(count * sizeof(b2Body*));
+		float32* transforms = (float32*)stack->Allocate(3 * count * sizeof(float32));
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			bodies[i] = queue->transforms[i].body;
+			memcpy(transforms + 3 * i, queue->transforms[i].transform, 3 * sizeof(float32));
+		}
+
+		world->SetTransforms(bodies, transforms, count);
+
+		stack->Free(transforms);
+		stack->Free(bodies);
+	}
+
+	for (int32 i = 0; i < queue->impulseCount; ++i)
+	{
+		const ImpulseCommand& command = queue->impulses[i];
+		if (command.angularImpulse != 0.0f)
+		{
+			command.body->ApplyAngularImpulse(command.angularImpulse, true);
+		}
+		else
+		{
+			command.body->ApplyLinearImpulse(command.linearImpulse, command.point, true);
+		}
+	}
+
+	if (queue->destroyCount > 0)
+	{
+		// A body may have been queued by several threads.
+		b2Body** destroys = queue->destroys;
+		std::sort(destroys, destroys + queue->destroyCount);
+		int32 count = int32(std::unique(destroys, destroys + queue->destroyCount) - destroys);
+		world->DestroyBodies(destroys, count);
+	}
+
+	Clear(queue);
+}
+
+void b2CommandBuffer::Clear(Queue* queue)
+{
+	for (int32 i = 0; i < queue->createCount; ++i)
+	{
+		b2Shape* shape = const_cast<b2Shape*>(queue->creates[i].fixtureDef.shape);
+		if (shape)
+		{
+			shape->~b2Shape();
+		}
+	}
+	queue->allocator.Clear();
+
+	queue->createCount = 0;
+	queue->destroyCount = 0;
+	queue->transformCount = 0;
+	queue->impulseCount = 0;
+	queue->activeCount = 0;
+}
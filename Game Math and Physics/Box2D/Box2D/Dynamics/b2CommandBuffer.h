@@ -0,0 +1,133 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_COMMAND_BUFFER_H
+#define B2_COMMAND_BUFFER_H
+
+#include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Common/b2Mutex.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+
+class b2World;
+
+/// Records world changes from any thread at any time, including from
+/// callbacks while the world is locked. The world applies the commands at
+/// the start of the next time step, grouped by kind: creations, activity
+/// changes, transforms, impulses and finally destructions. Each group is
+/// applied as one batch in recording order. Commands recorded while the
+/// world applies a batch go into the next one.
+/// Bodies named by commands must still exist when the commands are applied.
+class b2CommandBuffer
+{
+public:
+
+	/// Queue the creation of a body with an optional fixture. The definitions
+	/// and the shape are copied.
+	/// @param body receives the new body when the commands are applied, may be NULL.
+	void CreateBody(const b2BodyDef& def, const b2FixtureDef* fixtureDef = NULL, b2Body** body = NULL);
+
+	/// Queue the destruction of a body. A body may be queued more than once.
+	void DestroyBody(b2Body* body);
+
+	/// Queue a teleport. See b2Body::SetTransform.
+	void SetTransform(b2Body* body, const b2Vec2& position, float32 angle);
+
+	/// Queue an impulse at a world point. This wakes up the body.
+	void ApplyLinearImpulse(b2Body* body, const b2Vec2& impulse, const b2Vec2& point);
+
+	/// Queue an angular impulse. This wakes up the body.
+	void ApplyAngularImpulse(b2Body* body, float32 impulse);
+
+	/// Queue a change of the active state. See b2Body::SetActive.
+	void SetActive(b2Body* body, bool flag);
+
+private:
+
+	friend class b2World;
+
+	struct CreateCommand
+	{
+		b2BodyDef bodyDef;
+		b2FixtureDef fixtureDef;
+		b2Body** body;
+	};
+
+	struct TransformCommand
+	{
+		b2Body* body;
+		float32 transform[3];
+	};
+
+	struct ImpulseCommand
+	{
+		b2Body* body;
+		b2Vec2 linearImpulse;
+		b2Vec2 point;
+		float32 angularImpulse;
+	};
+
+	struct ActiveCommand
+	{
+		b2Body* body;
+		bool flag;
+	};
+
+	// One side of the double buffer. Shapes are cloned into its allocator.
+	struct Queue
+	{
+		CreateCommand* creates;
+		int32 createCount;
+		int32 createCapacity;
+
+		b2Body** destroys;
+		int32 destroyCount;
+		int32 destroyCapacity;
+
+		TransformCommand* transforms;
+		int32 transformCount;
+		int32 transformCapacity;
+
+		ImpulseCommand* impulses;
+		int32 impulseCount;
+		int32 impulseCapacity;
+
+		ActiveCommand* actives;
+		int32 activeCount;
+		int32 activeCapacity;
+
+		b2BlockAllocator allocator;
+	};
+
+	b2CommandBuffer();
+	~b2CommandBuffer();
+
+	b2CommandBuffer(const b2CommandBuffer&);
+	b2CommandBuffer& operator=(const b2CommandBuffer&);
+
+	// Apply and remove the recorded commands. Called by the world while unlocked.
+	void Apply(b2World* world);
+
+	void Clear(Queue* queue);
+
+	Queue m_queues[2];
+	Queue* m_record;
+	b2Mutex m_mutex;
+};
+
+#endif
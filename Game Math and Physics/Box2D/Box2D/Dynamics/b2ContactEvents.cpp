@@ -0,0 +1,172 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2ContactEvents.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <memory.h>
+
+// Get a new element at the end of an event array, doubling it as needed.
+template <typename T>
+static T* b2AddEvent(T** events, int32* count, int32* capacity)
+{
+	if (*count == *capacity)
+	{
+		T* oldEvents = *events;
+		*capacity = *capacity > 0 ? 2 * *capacity : 16;
+		*events = (T*)b2Alloc(*capacity * sizeof(T));
+		if (oldEvents)
+		{
+			memcpy(*events, oldEvents, *count * sizeof(T));
+			b2Free(oldEvents);
+		}
+	}
+
+	T* event = *events + *count;
+	++*count;
+	return event;
+}
+
+b2ContactEvents::b2ContactEvents()
+{
+	m_beginEvents = NULL;
+	m_beginCount = 0;
+	m_beginCapacity = 0;
+
+	m_endEvents = NULL;
+	m_endCount = 0;
+	m_endCapacity = 0;
+
+	m_sensorBeginEvents = NULL;
+	m_sensorBeginCount = 0;
+	m_sensorBeginCapacity = 0;
+
+	m_sensorEndEvents = NULL;
+	m_sensorEndCount = 0;
+	m_sensorEndCapacity = 0;
+
+	m_hitEvents = NULL;
+	m_hitCount = 0;
+	m_hitCapacity = 0;
+}
+
+b2ContactEvents::~b2ContactEvents()
+{
+	if (m_beginEvents)
+	{
+		b2Free(m_beginEvents);
+	}
+
+	if (m_endEvents)
+	{
+		b2Free(m_endEvents);
+	}
+
+	if (m_sensorBeginEvents)
+	{
+		b2Free(m_sensorBeginEvents);
+	}
+
+	if (m_sensorEndEvents)
+	{
+		b2Free(m_sensorEndEvents);
+	}
+
+	if (m_hitEvents)
+	{
+		b2Free(m_hitEvents);
+	}
+}
+
+void b2ContactEvents::Clear()
+{
+	m_beginCount = 0;
+	m_endCount = 0;
+	m_sensorBeginCount = 0;
+	m_sensorEndCount = 0;
+	m_hitCount = 0;
+}
+
+void b2ContactEvents::Swap(b2ContactEvents* other)
+{
+	b2Swap(m_beginEvents, other->m_beginEvents);
+	b2Swap(m_beginCount, other->m_beginCount);
+	b2Swap(m_beginCapacity, other->m_beginCapacity);
+
+	b2Swap(m_endEvents, other->m_endEvents);
+	b2Swap(m_endCount, other->m_endCount);
+	b2Swap(m_endCapacity, other->m_endCapacity);
+
+	b2Swap(m_sensorBeginEvents, other->m_sensorBeginEvents);
+	b2Swap(m_sensorBeginCount, other->m_sensorBeginCount);
+	b2Swap(m_sensorBeginCapacity, other->m_sensorBeginCapacity);
+
+	b2Swap(m_sensorEndEvents, other->m_sensorEndEvents);
+	b2Swap(m_sensorEndCount, other->m_sensorEndCount);
+	b2Swap(m_sensorEndCapacity, other->m_sensorEndCapacity);
+
+	b2Swap(m_hitEvents, other->m_hitEvents);
+	b2Swap(m_hitCount, other->m_hitCount);
+	b2Swap(m_hitCapacity, other->m_hitCapacity);
+}
+
+void b2ContactEvents::AddBeginEvent(const b2Contact* contact)
+{
+	b2ContactTouchEvent* event;
+	if (contact->m_fixtureA->IsSensor() || contact->m_fixtureB->IsSensor())
+	{
+		event = b2AddEvent(&m_sensorBeginEvents, &m_sensorBeginCount, &m_sensorBeginCapacity);
+	}
+	else
+	{
+		event = b2AddEvent(&m_beginEvents, &m_beginCount, &m_beginCapacity);
+	}
+
+	event->fixtureA = contact->m_fixtureA;
+	event->fixtureB = contact->m_fixtureB;
+	event->childIndexA = contact->m_indexA;
+	event->childIndexB = contact->m_indexB;
+}
+
+void b2ContactEvents::AddEndEvent(const b2Contact* contact)
+{
+	b2ContactTouchEvent* event;
+	if (contact->m_fixtureA->IsSensor() || contact->m_fixtureB->IsSensor())
+	{
+		event = b2AddEvent(&m_sensorEndEvents, &m_sensorEndCount, &m_sensorEndCapacity);
+	}
+	else
+	{
+		event = b2AddEvent(&m_endEvents, &m_endCount, &m_endCapacity);
+	}
+
+	event->fixtureA = contact->m_fixtureA;
+	event->fixtureB = contact->m_fixtureB;
+	event->childIndexA = contact->m_indexA;
+	event->childIndexB = contact->m_indexB;
+}
+
+void b2ContactEvents::AddHitEvent(const b2Contact* contact, const b2Vec2& point, const b2Vec2& normal, float32 normalImpulse)
+{
+	b2ContactHitEvent* event = b2AddEvent(&m_hitEvents, &m_hitCount, &m_hitCapacity);
+	event->fixtureA = contact->m_fixtureA;
+	event->fixtureB = contact->m_fixtureB;
+	event->point = point;
+	event->normal = normal;
+	event->normalImpulse = normalImpulse;
+}
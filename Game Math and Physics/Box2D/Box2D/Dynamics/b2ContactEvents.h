@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_CONTACT_EVENTS_H
+#define B2_CONTACT_EVENTS_H
+
+#include <Box2D/Common/b2Math.h>
+
+class b2Fixture;
+class b2Contact;
+
+/// Reported when two fixtures begin or cease to touch. Sensor overlaps
+/// are reported separately from solid contacts.
+struct b2ContactTouchEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	int32 childIndexA;
+	int32 childIndexB;
+};
+
+/// Reported when the solver applies a normal impulse above the hit threshold.
+struct b2ContactHitEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+
+	/// World contact point with the largest normal impulse.
+	b2Vec2 point;
+
+	/// World normal pointing from fixture A to fixture B.
+	b2Vec2 normal;
+
+	/// The largest normal impulse of the manifold points.
+	float32 normalImpulse;
+};
+
+/// The contact events of one time step in contiguous arrays. The world fills
+/// these during b2World::Step when contact events are enabled. The events hold
+/// plain data, so a buffer taken with b2World::SwapContactEvents can be read on
+/// another thread while the world keeps stepping. The fixture pointers are only
+/// valid until the fixtures are destroyed.
+class b2ContactEvents
+{
+public:
+	b2ContactEvents();
+	~b2ContactEvents();
+
+	/// Remove all events. Keeps the memory.
+	void Clear();
+
+	/// Exchange the contents with another buffer without copying.
+	void Swap(b2ContactEvents* other);
+
+	/// Get the begin touch events.
+	const b2ContactTouchEvent* GetBeginEvents() const { return m_beginEvents; }
+	int32 GetBeginEventCount() const { return m_beginCount; }
+
+	/// Get the end touch events.
+	const b2ContactTouchEvent* GetEndEvents() const { return m_endEvents; }
+	int32 GetEndEventCount() const { return m_endCount; }
+
+	/// Get the events of sensors beginning to overlap. These are not
+	/// included in the begin touch events.
+	const b2ContactTouchEvent* GetSensorBeginEvents() const { return m_sensorBeginEvents; }
+	int32 GetSensorBeginEventCount() const { return m_sensorBeginCount; }
+
+	/// Get the events of sensors ceasing to overlap. These are not included
+	/// in the end touch events.
+	const b2ContactTouchEvent* GetSensorEndEvents() const { return m_sensorEndEvents; }
+	int32 GetSensorEndEventCount() const { return m_sensorEndCount; }
+
+	/// Get the hit events.
+	const b2ContactHitEvent* GetHitEvents() const { return m_hitEvents; }
+	int32 GetHitEventCount() const { return m_hitCount; }
+
+private:
+
+	friend class b2Contact;
+	friend class b2ContactManager;
+	friend class b2Island;
+
+	b2ContactEvents(const b2ContactEvents&);
+	b2ContactEvents& operator=(const b2ContactEvents&);
+
+	void AddBeginEvent(const b2Contact* contact);
+	void AddEndEvent(const b2Contact* contact);
+	void AddHitEvent(const b2Contact* contact, const b2Vec2& point, const b2Vec2& normal, float32 normalImpulse);
+
+	b2ContactTouchEvent* m_beginEvents;
+	int32 m_beginCount;
+	int32 m_beginCapacity;
+
+	b2ContactTouchEvent* m_endEvents;
+	int32 m_endCount;
+	int32 m_endCapacity;
+
+	b2ContactTouchEvent* m_sensorBeginEvents;
+	int32 m_sensorBeginCount;
+	int32 m_sensorBeginCapacity;
+
+	b2ContactTouchEvent* m_sensorEndEvents;
+	int32 m_sensorEndCount;
+	int32 m_sensorEndCapacity;
+
+	b2ContactHitEvent* m_hitEvents;
+	int32 m_hitCount;
+	int32 m_hitCapacity;
+};
+
+#endif
@@ -20,7 +20,10 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
+#include <Box2D/Dynamics/b2ContactEvents.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
+#include <memory.h>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
@@ -29,11 +32,29 @@ b2ContactManager::b2ContactManager()
 {
 	m_contactList = NULL;
 	m_contactCount = 0;
+	m_pairCapacity = 16;
+	m_pairs = (b2ContactPair*)b2Alloc(m_pairCapacity * sizeof(b2ContactPair));
+	m_updateContacts = (b2Contact**)b2Alloc(m_pairCapacity * sizeof(b2Contact*));
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
+	m_contactEvents = NULL;
 	m_allocator = NULL;
 }
 
+b2ContactManager::~b2ContactManager()
+{
+	b2Free(m_pairs);
+	b2Free(m_updateContacts);
+}
+
+void b2ContactManager::SetContactFilter(b2ContactFilter* filter)
+{
+	m_contactFilter = filter;
+
+	// The broad-phase can only apply the default rules.
+	m_broadPhase.SetPairFiltering(filter == &b2_defaultFilter);
+}
+
 void b2ContactManager::Destroy(b2Contact* c)
 {
 	b2Fixture* fixtureA = c->GetFixtureA();
@@ -41,9 +62,36 @@ void b2ContactManager::Destroy(b2Contact* c)
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
-	if (m_contactListener && c->IsTouching())
+	if (c->IsTouching())
+	{
+		if (m_contactListener)
+		{
+			m_contactListener->EndContact(c);
+		}
+
+		if (m_contactEvents)
+		{
+			m_contactEvents->AddEndEvent(c);
+		}
+	}
+
+	// Remove from the pair set.
+	uint64 key = GetPairKey(fixtureA, c->GetChildIndexA(), fixtureB, c->GetChildIndexB());
+	if (key != 0)
+	{
+		bool found = m_pairSet.RemoveKey(key);
+		b2Assert(found);
+		B2_NOT_USED(found);
+	}
+
+	// Remove from the pair array. The last pair fills the hole.
+	int32 index = c->m_pairIndex;
+	int32 lastIndex = m_contactCount - 1;
+	b2Assert(0 <= index && index < m_contactCount && m_pairs[index].contact == c);
+	if (index != lastIndex)
 	{
-		m_contactListener->EndContact(c);
+		m_pairs[index] = m_pairs[lastIndex];
+		m_pairs[index].contact->m_pairIndex = index;
 	}
 
 	// Remove from the world.
@@ -99,45 +147,72 @@ void b2ContactManager::Destroy(b2Contact* c)
 	--m_contactCount;
 }
 
+void b2ContactManager::Clear()
+{
+	m_broadPhase.Clear();
+	m_pairSet.Clear();
+	m_contactList = NULL;
+	m_contactCount = 0;
+}
+
+void b2ContactManager::Copy(const b2ContactManager& manager)
+{
+	m_broadPhase.Copy(manager.m_broadPhase);
+	m_pairSet.Copy(manager.m_pairSet);
+
+	if (m_pairCapacity < manager.m_contactCount)
+	{
+		b2Free(m_pairs);
+		b2Free(m_updateContacts);
+		m_pairCapacity = manager.m_pairCapacity;
+		m_pairs = (b2ContactPair*)b2Alloc(m_pairCapacity * sizeof(b2ContactPair));
+		m_updateContacts = (b2Contact**)b2Alloc(m_pairCapacity * sizeof(b2Contact*));
+	}
+
+	memcpy(m_pairs, manager.m_pairs, manager.m_contactCount * sizeof(b2ContactPair));
+	m_contactList = NULL;
+	m_contactCount = manager.m_contactCount;
+}
+
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
 void b2ContactManager::Collide()
 {
-	// Update awake contacts.
-	b2Contact* c = m_contactList;
-	while (c)
-	{
-		b2Fixture* fixtureA = c->GetFixtureA();
-		b2Fixture* fixtureB = c->GetFixtureB();
-		int32 indexA = c->GetChildIndexA();
-		int32 indexB = c->GetChildIndexB();
-		b2Body* bodyA = fixtureA->GetBody();
-		b2Body* bodyB = fixtureB->GetBody();
-		 
+	const int32 typeCount = b2Shape::e_typeCount * b2Shape::e_typeCount;
+	int32 counts[typeCount];
+	memset(counts, 0, sizeof(counts));
+
+	// Find the awake contacts. Destroying a contact moves the last pair into
+	// the current slot, so the index only advances when the contact persists.
+	int32 index = 0;
+	while (index < m_contactCount)
+	{
+		b2ContactPair* pair = m_pairs + index;
+		b2Body* bodyA = pair->bodyA;
+		b2Body* bodyB = pair->bodyB;
+
 		// Is this contact flagged for filtering?
-		if (c->m_flags & b2Contact::e_filterFlag)
+		if (pair->flags & b2ContactPair::e_filterFlag)
 		{
+			b2Contact* c = pair->contact;
+
 			// Should these bodies collide?
 			if (bodyB->ShouldCollide(bodyA) == false)
 			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
+				Destroy(c);
 				continue;
 			}
 
 			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+			if (m_contactFilter && m_contactFilter->ShouldCollide(c->GetFixtureA(), c->GetFixtureB()) == false)
 			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
+				Destroy(c);
 				continue;
 			}
 
 			// Clear the filtering flag.
-			c->m_flags &= ~b2Contact::e_filterFlag;
+			pair->flags &= ~b2ContactPair::e_filterFlag;
 		}
 
 		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
@@ -146,34 +221,125 @@ void b2ContactManager::Collide()
 		// At least one body must be awake and it must be dynamic or kinematic.
 		if (activeA == false && activeB == false)
 		{
-			c = c->GetNext();
+			++index;
 			continue;
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		// Bodies part way through a coarse step are not solved, so their
+		// contacts can wait until the island is solved again.
+		bool pendingA = activeA == false || bodyA->m_stepsPending > 0;
+		bool pendingB = activeB == false || bodyB->m_stepsPending > 0;
+		if (pendingA && pendingB)
+		{
+			++index;
+			continue;
+		}
+
+		bool overlap;
+		if (pair->flags & b2ContactPair::e_meshFlag)
+		{
+			// Mesh segments share one proxy, so test the segment bounds directly.
+			b2Contact* c = pair->contact;
+			b2AABB aabbA;
+			((b2MeshShape*)c->GetFixtureA()->GetShape())->ComputeSegmentAABB(&aabbA, bodyA->GetTransform(), c->GetChildIndexA());
+			overlap = b2TestOverlap(aabbA, m_broadPhase.GetFatAABB(pair->proxyIdB));
+		}
+		else
+		{
+			overlap = m_broadPhase.TestOverlap(pair->proxyIdA, pair->proxyIdB);
+		}
 
 		// Here we destroy contacts that cease to overlap in the broad-phase.
 		if (overlap == false)
 		{
-			b2Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
+			Destroy(pair->contact);
 			continue;
 		}
 
 		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+		pair->flags |= b2ContactPair::e_updateFlag;
+		++counts[pair->type];
+		++index;
+	}
+
+	// Sort the contacts by shape pair so each bucket is updated by a
+	// single loop that calls Evaluate directly.
+	int32 offsets[typeCount];
+	int32 updateCount = 0;
+	for (int32 i = 0; i < typeCount; ++i)
+	{
+		offsets[i] = updateCount;
+		updateCount += counts[i];
+	}
+
+	for (int32 i = 0; i < m_contactCount; ++i)
+	{
+		b2ContactPair* pair = m_pairs + i;
+		if (pair->flags & b2ContactPair::e_updateFlag)
+		{
+			pair->flags &= ~b2ContactPair::e_updateFlag;
+			m_updateContacts[offsets[pair->type]++] = pair->contact;
+		}
+	}
+
+	// Update the manifolds. This cannot destroy contacts.
+	b2Contact** contacts = m_updateContacts;
+	for (int32 i = 0; i < typeCount; ++i)
+	{
+		if (counts[i] == 0)
+		{
+			continue;
+		}
+
+		int32 typeA = i / b2Shape::e_typeCount;
+		int32 typeB = i - typeA * b2Shape::e_typeCount;
+		b2ContactUpdateFcn* updateFcn = b2Contact::s_registers[typeA][typeB].updateFcn;
+		b2Assert(updateFcn != NULL);
+		updateFcn(contacts, counts[i], m_contactListener, m_contactEvents);
+		contacts += counts[i];
 	}
 }
 
+void b2ContactManager::FlagForFiltering(b2Contact* c)
+{
+	b2Assert(0 <= c->m_pairIndex && c->m_pairIndex < m_contactCount);
+	m_pairs[c->m_pairIndex].flags |= b2ContactPair::e_filterFlag;
+}
+
 void b2ContactManager::FindNewContacts()
 {
 	m_broadPhase.UpdatePairs(this);
 }
 
+// Adds contacts for the mesh segments found by the mid-phase.
+struct b2MeshPairCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		// The hierarchy is queried in the mesh frame, so test the world bounds again.
+		b2AABB aabb;
+		mesh->ComputeSegmentAABB(&aabb, meshFixture->GetBody()->GetTransform(), index);
+		if (b2TestOverlap(aabb, fatAABB) == false)
+		{
+			return true;
+		}
+
+		if (manager->ContactExists(meshFixture, index, fixture, childIndex) == false)
+		{
+			manager->AddContact(meshFixture, index, fixture, childIndex);
+		}
+
+		return true;
+	}
+
+	b2ContactManager* manager;
+	const b2MeshShape* mesh;
+	b2Fixture* meshFixture;
+	b2Fixture* fixture;
+	int32 childIndex;
+	b2AABB fatAABB;
+};
+
 void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 {
 	b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
@@ -194,9 +360,96 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
-	// TODO_ERIN use a hash table to remove a potential bottleneck when both
-	// bodies have a lot of contacts.
+	// A mesh has a single proxy for all its segments. The mid-phase below
+	// creates one contact per touching segment.
+	bool meshA = fixtureA->GetType() == b2Shape::e_mesh;
+	bool meshB = fixtureB->GetType() == b2Shape::e_mesh;
+	if (meshA && meshB)
+	{
+		return;
+	}
+
 	// Does a contact already exist?
+	if (meshA == false && meshB == false && ContactExists(fixtureA, indexA, fixtureB, indexB))
+	{
+		return;
+	}
+
+	// Does a joint override collision? Is at least one body dynamic?
+	if (bodyB->ShouldCollide(bodyA) == false)
+	{
+		return;
+	}
+
+	// Check user filtering. The broad-phase already applied the default filter.
+	if (m_contactFilter != &b2_defaultFilter && m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+	{
+		return;
+	}
+
+	if (meshA || meshB)
+	{
+		b2FixtureProxy* meshProxy = meshA ? proxyA : proxyB;
+		b2FixtureProxy* otherProxy = meshA ? proxyB : proxyA;
+
+		b2MeshPairCallback callback;
+		callback.manager = this;
+		callback.meshFixture = meshProxy->fixture;
+		callback.mesh = (const b2MeshShape*)meshProxy->fixture->GetShape();
+		callback.fixture = otherProxy->fixture;
+		callback.childIndex = otherProxy->childIndex;
+		callback.fatAABB = m_broadPhase.GetFatAABB(otherProxy->proxyId);
+
+		// Bring the fat AABB of the other proxy into the mesh frame.
+		const b2Transform& xf = meshProxy->fixture->GetBody()->GetTransform();
+		b2Vec2 center = b2MulT(xf, callback.fatAABB.GetCenter());
+		b2Vec2 h = callback.fatAABB.GetExtents();
+		b2Vec2 r;
+		r.x = b2Abs(xf.q.c) * h.x + b2Abs(xf.q.s) * h.y;
+		r.y = b2Abs(xf.q.s) * h.x + b2Abs(xf.q.c) * h.y;
+
+		b2AABB aabb;
+		aabb.lowerBound = center - r;
+		aabb.upperBound = center + r;
+		callback.mesh->Query(&callback, aabb);
+		return;
+	}
+
+	AddContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+uint64 b2ContactManager::GetPairKey(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB) const
+{
+	// A mesh has a single proxy shared by the contacts of all its segments.
+	if (fixtureA->GetType() == b2Shape::e_mesh || fixtureB->GetType() == b2Shape::e_mesh)
+	{
+		return 0;
+	}
+
+	int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+	int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+	b2Assert(proxyIdA != b2BroadPhase::e_nullProxy && proxyIdB != b2BroadPhase::e_nullProxy);
+	return b2PairKey(proxyIdA, proxyIdB);
+}
+
+bool b2ContactManager::ContactExists(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB) const
+{
+	uint64 key = GetPairKey(fixtureA, indexA, fixtureB, indexB);
+	if (key != 0)
+	{
+		return m_pairSet.ContainsKey(key);
+	}
+
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	// Mesh contacts are found through the contact list. Meshes are usually
+	// static and touch many bodies, so walk the list of the other body.
+	if (bodyB->GetType() == b2_staticBody)
+	{
+		b2Swap(bodyA, bodyB);
+	}
+
 	b2ContactEdge* edge = bodyB->GetContactList();
 	while (edge)
 	{
@@ -209,32 +462,23 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 
 			if (fA == fixtureA && fB == fixtureB && iA == indexA && iB == indexB)
 			{
-				// A contact already exists.
-				return;
+				return true;
 			}
 
 			if (fA == fixtureB && fB == fixtureA && iA == indexB && iB == indexA)
 			{
-				// A contact already exists.
-				return;
+				return true;
 			}
 		}
 
 		edge = edge->next;
 	}
 
-	// Does a joint override collision? Is at least one body dynamic?
-	if (bodyB->ShouldCollide(bodyA) == false)
-	{
-		return;
-	}
-
-	// Check user filtering.
-	if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
-	{
-		return;
-	}
+	return false;
+}
 
+void b2ContactManager::AddContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+{
 	// Call the factory.
 	b2Contact* c = b2Contact::Create(fixtureA, indexA, fixtureB, indexB, m_allocator);
 	if (c == NULL)
@@ -247,8 +491,50 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	fixtureB = c->GetFixtureB();
 	indexA = c->GetChildIndexA();
 	indexB = c->GetChildIndexB();
-	bodyA = fixtureA->GetBody();
-	bodyB = fixtureB->GetBody();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	// Insert into the pair set.
+	uint64 key = GetPairKey(fixtureA, indexA, fixtureB, indexB);
+	if (key != 0)
+	{
+		bool found = m_pairSet.AddKey(key);
+		b2Assert(found == false);
+		B2_NOT_USED(found);
+	}
+
+	// Insert into the pair array.
+	if (m_contactCount == m_pairCapacity)
+	{
+		b2ContactPair* oldPairs = m_pairs;
+		m_pairCapacity *= 2;
+		m_pairs = (b2ContactPair*)b2Alloc(m_pairCapacity * sizeof(b2ContactPair));
+		memcpy(m_pairs, oldPairs, m_contactCount * sizeof(b2ContactPair));
+		b2Free(oldPairs);
+
+		// The update scratch holds no data between steps.
+		b2Free(m_updateContacts);
+		m_updateContacts = (b2Contact**)b2Alloc(m_pairCapacity * sizeof(b2Contact*));
+	}
+
+	b2ContactPair* pair = m_pairs + m_contactCount;
+	pair->contact = c;
+	pair->bodyA = bodyA;
+	pair->bodyB = bodyB;
+	pair->proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+	pair->type = fixtureA->GetType() * b2Shape::e_typeCount + fixtureB->GetType();
+	if (fixtureA->GetType() == b2Shape::e_mesh)
+	{
+		// The child index is a segment, all segments share the first proxy.
+		pair->proxyIdA = fixtureA->m_proxies[0].proxyId;
+		pair->flags = b2ContactPair::e_meshFlag;
+	}
+	else
+	{
+		pair->proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+		pair->flags = 0;
+	}
+	c->m_pairIndex = m_contactCount;
 
 	// Insert into the world.
 	c->m_prev = NULL;
@@ -20,32 +20,87 @@
 #define B2_CONTACT_MANAGER_H
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2HashSet.h>
 
 class b2Contact;
+class b2Fixture;
 class b2ContactFilter;
 class b2ContactListener;
+class b2ContactEvents;
 class b2BlockAllocator;
+class b2Body;
+
+// Per-step collide data of a contact. These are kept in a dense array so the
+// collide loop only touches the contact itself when it is awake and still
+// overlapping.
+struct b2ContactPair
+{
+	enum
+	{
+		// The contact needs filtering because a fixture filter or joint changed.
+		e_filterFlag	= 0x0001,
+
+		// Fixture A is a mesh. The segment bounds are tested instead of proxy A.
+		e_meshFlag		= 0x0002,
+
+		// The contact persists this step and its manifold needs an update.
+		e_updateFlag	= 0x0004
+	};
+
+	b2Contact* contact;
+	b2Body* bodyA;
+	b2Body* bodyB;
+	int32 proxyIdA;
+	int32 proxyIdB;
+	int32 type;		// typeA * b2Shape::e_typeCount + typeB, selects the update bucket
+	uint32 flags;
+};
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
 	b2ContactManager();
+	~b2ContactManager();
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
+	bool ContactExists(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB) const;
+
+	// Key of a contact in the pair set, zero for mesh contacts.
+	uint64 GetPairKey(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB) const;
+
+	void SetContactFilter(b2ContactFilter* filter);
+
+	void AddContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
+
 	void FindNewContacts();
 
+	// Flag a contact for filtering. Filtering will occur the next time step.
+	void FlagForFiltering(b2Contact* c);
+
 	void Destroy(b2Contact* c);
 
+	// Forget all contacts and proxies. The caller frees the contacts.
+	void Clear();
+
+	// Copy the broad-phase, pair set and pair array of another manager. The
+	// caller copies the contacts and fixes up the pair pointers.
+	void Copy(const b2ContactManager& manager);
+
 	void Collide();
             
 	b2BroadPhase m_broadPhase;
+	b2HashSet m_pairSet;
 	b2Contact* m_contactList;
 	int32 m_contactCount;
+	b2ContactPair* m_pairs;
+	int32 m_pairCapacity;
+	b2Contact** m_updateContacts;	// scratch for Collide, sorted by pair type
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
+	b2ContactEvents* m_contactEvents;
 	b2BlockAllocator* m_allocator;
 };
 
@@ -23,6 +23,9 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2BlockAllocator.h>
@@ -66,6 +69,36 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 	m_density = def->density;
 }
 
+void b2Fixture::Copy(b2BlockAllocator* allocator, b2Body* body, const b2Fixture* fixture)
+{
+	m_userData = fixture->m_userData;
+	m_friction = fixture->m_friction;
+	m_restitution = fixture->m_restitution;
+
+	m_body = body;
+	m_next = NULL;
+
+	m_filter = fixture->m_filter;
+
+	m_isSensor = fixture->m_isSensor;
+
+	m_shape = fixture->m_shape->Clone(allocator);
+
+	int32 childCount = m_shape->GetChildCount();
+	m_proxies = (b2FixtureProxy*)allocator->Allocate(childCount * sizeof(b2FixtureProxy));
+	for (int32 i = 0; i < childCount; ++i)
+	{
+		m_proxies[i] = fixture->m_proxies[i];
+		if (i < fixture->m_proxyCount)
+		{
+			m_proxies[i].fixture = this;
+		}
+	}
+	m_proxyCount = fixture->m_proxyCount;
+
+	m_density = fixture->m_density;
+}
+
 void b2Fixture::Destroy(b2BlockAllocator* allocator)
 {
 	// The proxies must be destroyed before calling this.
@@ -111,6 +144,30 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_box:
+		{
+			b2BoxShape* s = (b2BoxShape*)m_shape;
+			s->~b2BoxShape();
+			allocator->Free(s, sizeof(b2BoxShape));
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			s->~b2CapsuleShape();
+			allocator->Free(s, sizeof(b2CapsuleShape));
+		}
+		break;
+
+	case b2Shape::e_mesh:
+		{
+			b2MeshShape* s = (b2MeshShape*)m_shape;
+			s->~b2MeshShape();
+			allocator->Free(s, sizeof(b2MeshShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -126,11 +183,12 @@ void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 	// Create proxies in the broad-phase.
 	m_proxyCount = m_shape->GetChildCount();
 
+	bool staticProxy = m_body->GetType() == b2_staticBody;
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
 		m_shape->ComputeAABB(&proxy->aabb, xf, i);
-		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
+		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy, staticProxy, m_filter);
 		proxy->fixture = this;
 		proxy->childIndex = i;
 	}
@@ -187,6 +245,13 @@ void b2Fixture::Refilter()
 		return;
 	}
 
+	b2World* world = m_body->GetWorld();
+
+	if (world == NULL)
+	{
+		return;
+	}
+
 	// Flag associated contacts for filtering.
 	b2ContactEdge* edge = m_body->GetContactList();
 	while (edge)
@@ -196,23 +261,17 @@ void b2Fixture::Refilter()
 		b2Fixture* fixtureB = contact->GetFixtureB();
 		if (fixtureA == this || fixtureB == this)
 		{
-			contact->FlagForFiltering();
+			world->m_contactManager.FlagForFiltering(contact);
 		}
 
 		edge = edge->next;
 	}
 
-	b2World* world = m_body->GetWorld();
-
-	if (world == NULL)
-	{
-		return;
-	}
-
-	// Touch each proxy so that new pairs may be created
+	// Update the proxy filters and touch each proxy so that new pairs may be created
 	b2BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
+		broadPhase->SetProxyFilter(m_proxies[i].proxyId, m_filter);
 		broadPhase->TouchProxy(m_proxies[i].proxyId);
 	}
 }
@@ -292,6 +351,42 @@ void b2Fixture::Dump(int32 bodyIndex)
 		}
 		break;
 
+	case b2Shape::e_box:
+		{
+			b2BoxShape* s = (b2BoxShape*)m_shape;
+			b2Log("    b2BoxShape shape;\n");
+			b2Log("    shape.SetAsBox(%.15lef, %.15lef, b2Vec2(%.15lef, %.15lef));\n",
+				s->m_extents.x, s->m_extents.y, s->m_center.x, s->m_center.y);
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			b2Log("    b2CapsuleShape shape;\n");
+			b2Log("    shape.Set(b2Vec2(%.15lef, %.15lef), b2Vec2(%.15lef, %.15lef), %.15lef);\n",
+				s->m_vertex1.x, s->m_vertex1.y, s->m_vertex2.x, s->m_vertex2.y, s->m_radius);
+		}
+		break;
+
+	case b2Shape::e_mesh:
+		{
+			b2MeshShape* s = (b2MeshShape*)m_shape;
+			b2Log("    b2MeshShape shape;\n");
+			b2Log("    b2Vec2 vs[%d];\n", s->m_vertexCount);
+			for (int32 i = 0; i < s->m_vertexCount; ++i)
+			{
+				b2Log("    vs[%d].Set(%.15lef, %.15lef);\n", i, s->m_vertices[i].x, s->m_vertices[i].y);
+			}
+			b2Log("    int32 is[%d];\n", 2 * s->m_segmentCount);
+			for (int32 i = 0; i < 2 * s->m_segmentCount; ++i)
+			{
+				b2Log("    is[%d] = %d;\n", i, s->m_indices[i]);
+			}
+			b2Log("    shape.Create(vs, %d, is, %d);\n", s->m_vertexCount, s->m_segmentCount);
+		}
+		break;
+
 	default:
 		return;
 	}
@@ -28,29 +28,6 @@ class b2Body;
 class b2BroadPhase;
 class b2Fixture;
 
-/// This holds contact filtering data.
-struct b2Filter
-{
-	b2Filter()
-	{
-		categoryBits = 0x0001;
-		maskBits = 0xFFFF;
-		groupIndex = 0;
-	}
-
-	/// The collision category bits. Normally you would just set one bit.
-	uint16 categoryBits;
-
-	/// The collision mask bits. This states the categories that this
-	/// shape would accept for collision.
-	uint16 maskBits;
-
-	/// Collision groups allow a certain group of objects to never collide (negative)
-	/// or always collide (positive). Zero means no collision group. Non-zero group
-	/// filtering always wins against the mask bits.
-	int16 groupIndex;
-};
-
 /// A fixture definition is used to create a fixture. This class defines an
 /// abstract fixture definition. You can reuse fixture definitions safely.
 struct b2FixtureDef
@@ -209,6 +186,10 @@ protected:
 	void Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def);
 	void Destroy(b2BlockAllocator* allocator);
 
+	// Copy a fixture of another world. The proxies keep their ids, the caller
+	// points the broad-phase user data at them.
+	void Copy(b2BlockAllocator* allocator, b2Body* body, const b2Fixture* fixture);
+
 	// These support body activation/deactivation.
 	void CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf);
 	void DestroyProxies(b2BroadPhase* broadPhase);
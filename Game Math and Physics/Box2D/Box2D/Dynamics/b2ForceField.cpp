@@ -0,0 +1,92 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2ForceField.h>
+
+b2ForceField::b2ForceField(const b2ForceFieldDef* def)
+{
+	b2Assert(def->type != e_directionalField || def->region.IsValid());
+	b2Assert(def->type == e_directionalField || def->radius > 0.0f);
+
+	m_type = def->type;
+	m_region = def->region;
+	m_center = def->center;
+	m_radius = def->radius;
+	m_acceleration = def->acceleration;
+	m_strength = def->strength;
+	m_filter = def->filter;
+	m_impulse = def->impulse;
+	m_enabled = true;
+	m_userData = def->userData;
+	m_prev = NULL;
+	m_next = NULL;
+}
+
+b2AABB b2ForceField::GetAABB() const
+{
+	if (m_type == e_directionalField)
+	{
+		return m_region;
+	}
+
+	b2Vec2 r(m_radius, m_radius);
+	b2AABB aabb;
+	aabb.lowerBound = m_center - r;
+	aabb.upperBound = m_center + r;
+	return aabb;
+}
+
+// The loops are branch free per point so the compiler can vectorize them.
+void b2ForceField::ComputeAccelerations(b2Vec2* accelerations, const b2Vec2* points, int32 count) const
+{
+	switch (m_type)
+	{
+	case e_directionalField:
+		{
+			b2Vec2 lower = m_region.lowerBound;
+			b2Vec2 upper = m_region.upperBound;
+			for (int32 i = 0; i < count; ++i)
+			{
+				b2Vec2 p = points[i];
+				bool inside = lower.x <= p.x && p.x <= upper.x && lower.y <= p.y && p.y <= upper.y;
+				float32 s = inside ? 1.0f : 0.0f;
+				accelerations[i].Set(s * m_acceleration.x, s * m_acceleration.y);
+			}
+		}
+		break;
+
+	case e_radialField:
+	case e_vortexField:
+		{
+			bool vortex = m_type == e_vortexField;
+			float32 inv_radius = 1.0f / m_radius;
+			for (int32 i = 0; i < count; ++i)
+			{
+				b2Vec2 d = points[i] - m_center;
+				float32 length = b2Sqrt(d.x * d.x + d.y * d.y);
+
+				// Linear falloff, zero outside the radius and along the unit direction.
+				float32 falloff = b2Max(1.0f - length * inv_radius, 0.0f);
+				float32 s = length > b2_epsilon ? m_strength * falloff / length : 0.0f;
+				b2Vec2 dir = vortex ? b2Vec2(-d.y, d.x) : d;
+				accelerations[i].Set(s * dir.x, s * dir.y);
+			}
+		}
+		break;
+	}
+}
@@ -0,0 +1,209 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_FORCE_FIELD_H
+#define B2_FORCE_FIELD_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Collision/b2Collision.h>
+
+enum b2ForceFieldType
+{
+	e_directionalField,
+	e_radialField,
+	e_vortexField
+};
+
+/// A force field definition is used to create a force field.
+struct b2ForceFieldDef
+{
+	b2ForceFieldDef()
+	{
+		type = e_directionalField;
+		region.lowerBound.SetZero();
+		region.upperBound.SetZero();
+		center.SetZero();
+		radius = 0.0f;
+		acceleration.SetZero();
+		strength = 0.0f;
+		impulse = false;
+		userData = NULL;
+	}
+
+	/// The field type.
+	b2ForceFieldType type;
+
+	/// The region of a directional field, in world co-ordinates.
+	b2AABB region;
+
+	/// The center of a radial or vortex field, in world co-ordinates.
+	b2Vec2 center;
+
+	/// The radius of a radial or vortex field.
+	float32 radius;
+
+	/// The acceleration of a directional field, usually in m/s^2. This is
+	/// independent of mass, like gravity.
+	b2Vec2 acceleration;
+
+	/// The acceleration at the center of a radial or vortex field. It falls off
+	/// linearly to zero at the radius. Radial fields push outward, or pull
+	/// inward if negative. Vortex fields turn counter-clockwise, or clockwise
+	/// if negative.
+	float32 strength;
+
+	/// Only fixtures that pass this filter are affected.
+	b2Filter filter;
+
+	/// Apply the field once as a change in velocity, for example for an
+	/// explosion. The acceleration becomes a velocity change in m/s and
+	/// sleeping bodies are woken. The field disables itself afterwards.
+	bool impulse;
+
+	/// Use this to store application specific data.
+	void* userData;
+};
+
+/// A force field accelerates the dynamic bodies inside a region, such as wind,
+/// a conveyor zone or an explosion. Fields are applied by b2World::Step before
+/// the solver: the broad-phase is queried for the region and the accelerations
+/// of all bodies found are computed in one pass. A body is inside when its center
+/// of mass is inside. Continuous fields do not wake sleeping bodies.
+/// Force fields are created by b2World::CreateForceField.
+class b2ForceField
+{
+public:
+
+	/// Get the field type.
+	b2ForceFieldType GetType() const;
+
+	/// Get the world AABB that is queried for bodies.
+	b2AABB GetAABB() const;
+
+	/// Set the region of a directional field.
+	void SetRegion(const b2AABB& region);
+
+	/// Set the center of a radial or vortex field.
+	void SetCenter(const b2Vec2& center);
+
+	/// Set the acceleration of a directional field.
+	void SetAcceleration(const b2Vec2& acceleration);
+
+	/// Set the acceleration at the center of a radial or vortex field.
+	void SetStrength(float32 strength);
+
+	/// Enable or disable the field. Impulse fields are enabled again to fire
+	/// once more.
+	void SetEnabled(bool flag);
+
+	/// Is the field enabled?
+	bool IsEnabled() const;
+
+	/// Compute the acceleration of each point. Points outside the field
+	/// get zero.
+	void ComputeAccelerations(b2Vec2* accelerations, const b2Vec2* points, int32 count) const;
+
+	/// Get the user data pointer that was provided in the field definition.
+	void* GetUserData() const;
+
+	/// Set the user data. Use this to store your application specific data.
+	void SetUserData(void* data);
+
+	/// Get the next force field in the world list.
+	b2ForceField* GetNext();
+	const b2ForceField* GetNext() const;
+
+private:
+
+	friend class b2World;
+
+	b2ForceField(const b2ForceFieldDef* def);
+
+	b2ForceFieldType m_type;
+	b2AABB m_region;
+	b2Vec2 m_center;
+	float32 m_radius;
+	b2Vec2 m_acceleration;
+	float32 m_strength;
+	b2Filter m_filter;
+	bool m_impulse;
+	bool m_enabled;
+
+	void* m_userData;
+
+	// World force fields
+	b2ForceField* m_prev;
+	b2ForceField* m_next;
+};
+
+inline b2ForceFieldType b2ForceField::GetType() const
+{
+	return m_type;
+}
+
+inline void b2ForceField::SetRegion(const b2AABB& region)
+{
+	m_region = region;
+}
+
+inline void b2ForceField::SetCenter(const b2Vec2& center)
+{
+	m_center = center;
+}
+
+inline void b2ForceField::SetAcceleration(const b2Vec2& acceleration)
+{
+	m_acceleration = acceleration;
+}
+
+inline void b2ForceField::SetStrength(float32 strength)
+{
+	m_strength = strength;
+}
+
+inline void b2ForceField::SetEnabled(bool flag)
+{
+	m_enabled = flag;
+}
+
+inline bool b2ForceField::IsEnabled() const
+{
+	return m_enabled;
+}
+
+inline void* b2ForceField::GetUserData() const
+{
+	return m_userData;
+}
+
+inline void b2ForceField::SetUserData(void* data)
+{
+	m_userData = data;
+}
+
+inline b2ForceField* b2ForceField::GetNext()
+{
+	return m_next;
+}
+
+inline const b2ForceField* b2ForceField::GetNext() const
+{
+	return m_next;
+}
+
+#endif
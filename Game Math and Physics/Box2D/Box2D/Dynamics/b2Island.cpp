@@ -21,11 +21,14 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2ContactEvents.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Dynamics/Joints/b2ArticulationSolver.h>
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Timer.h>
+#include <memory.h>
 
 #pragma warning( disable : 4456) //added by Ian Parberry
 
@@ -152,7 +155,9 @@ b2Island::b2Island(
 	int32 contactCapacity,
 	int32 jointCapacity,
 	b2StackAllocator* allocator,
-	b2ContactListener* listener)
+	b2ContactListener* listener,
+	b2ContactEvents* events,
+	float32 hitEventThreshold)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
@@ -163,6 +168,8 @@ b2Island::b2Island(
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_events = events;
+	m_hitEventThreshold = hitEventThreshold;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -182,9 +189,29 @@ b2Island::~b2Island()
 	m_allocator->Free(m_bodies);
 }
 
+// Did any body velocity change more than the iteration tolerances?
+static bool b2HasConverged(const b2Velocity* velocities, const b2Velocity* previous, int32 count)
+{
+	const float32 linTolSqr = b2_linearIterationTolerance * b2_linearIterationTolerance;
+	const float32 angTol = b2_angularIterationTolerance;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 dv = velocities[i].v - previous[i].v;
+		float32 dw = velocities[i].w - previous[i].w;
+		if (b2Dot(dv, dv) > linTolSqr || b2Abs(dw) > angTol)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename Policy>
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
-	b2Timer timer;
+	b2OptionalTimer<Policy::profile != 0> timer;
 
 	float32 h = step.dt;
 
@@ -245,30 +272,91 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	b2ContactSolver contactSolver(&contactSolverDef);
 	contactSolver.InitializeVelocityConstraints();
 
+	// A world that breaks a single point policy, for example with a polygon
+	// among the circles, falls back to the generic contact solver.
+	bool singlePoint = Policy::maxPointCount == 1 && contactSolver.m_maxPointCount <= 1;
+
 	if (step.warmStarting)
 	{
 		contactSolver.WarmStart();
 	}
 	
-	for (int32 i = 0; i < m_jointCount; ++i)
+	// Gather the articulated revolute joints into trees.
+	int32 jointCount = Policy::joints ? m_jointCount : 0;
+	b2ArticulationSolver articulationSolver(m_joints, jointCount, m_bodies, m_bodyCount, m_allocator);
+
+	if (Policy::joints)
 	{
-		m_joints[i]->InitVelocityConstraints(solverData);
+		for (int32 i = 0; i < m_jointCount; ++i)
+		{
+			m_joints[i]->InitVelocityConstraints(solverData);
+		}
+
+		articulationSolver.InitializeVelocityConstraints(solverData);
 	}
 
 	profile->solveInit = timer.GetMilliseconds();
 
+	// Adaptive iterations run until the velocities stop changing, up to the
+	// maximum. The change is measured on the body velocities so that joints
+	// count as well as contacts.
+	int32 velocityIterations = step.velocityIterations;
+	int32 positionIterations = step.positionIterations;
+	b2Velocity* previousVelocities = NULL;
+	if (step.adaptiveIterations)
+	{
+		velocityIterations = step.maxVelocityIterations;
+		positionIterations = step.maxPositionIterations;
+		previousVelocities = (b2Velocity*)m_allocator->Allocate(m_bodyCount * sizeof(b2Velocity));
+	}
+
 	// Solve velocity constraints
 	timer.Reset();
-	for (int32 i = 0; i < step.velocityIterations; ++i)
+	int32 velocityIteration = 0;
+	while (velocityIteration < velocityIterations)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		if (previousVelocities)
+		{
+			memcpy(previousVelocities, m_velocities, m_bodyCount * sizeof(b2Velocity));
+		}
+
+		if (Policy::joints)
+		{
+			for (int32 j = 0; j < m_jointCount; ++j)
+			{
+				m_joints[j]->SolveVelocityConstraints(solverData);
+			}
+		}
+
+		if (singlePoint)
+		{
+			contactSolver.SolveVelocityConstraints<1>();
+		}
+		else
 		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
+			contactSolver.SolveVelocityConstraints<2>();
 		}
 
-		contactSolver.SolveVelocityConstraints();
+		if (Policy::joints)
+		{
+			articulationSolver.SolveVelocityConstraints(solverData);
+		}
+
+		++velocityIteration;
+
+		if (previousVelocities && b2HasConverged(m_velocities, previousVelocities, m_bodyCount))
+		{
+			break;
+		}
 	}
 
+	if (previousVelocities)
+	{
+		m_allocator->Free(previousVelocities);
+	}
+
+	profile->velocityIterations = velocityIteration;
+
 	// Store impulses for warm starting
 	contactSolver.StoreImpulses();
 	profile->solveVelocity = timer.GetMilliseconds();
@@ -309,15 +397,24 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	// Solve position constraints
 	timer.Reset();
 	bool positionSolved = false;
-	for (int32 i = 0; i < step.positionIterations; ++i)
+	int32 positionIteration = 0;
+	while (positionIteration < positionIterations)
 	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints();
+		++positionIteration;
+
+		bool contactsOkay = singlePoint ? contactSolver.SolvePositionConstraints<1>() : contactSolver.SolvePositionConstraints<2>();
 
 		bool jointsOkay = true;
-		for (int32 i = 0; i < m_jointCount; ++i)
+		if (Policy::joints)
 		{
-			bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
-			jointsOkay = jointsOkay && jointOkay;
+			for (int32 i = 0; i < m_jointCount; ++i)
+			{
+				bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
+				jointsOkay = jointsOkay && jointOkay;
+			}
+
+			bool articulationOkay = articulationSolver.SolvePositionConstraints(solverData);
+			jointsOkay = jointsOkay && articulationOkay;
 		}
 
 		if (contactsOkay && jointsOkay)
@@ -328,6 +425,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		}
 	}
 
+	profile->positionIterations = positionIteration;
+
 	// Copy state buffers back to the bodies
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
@@ -343,7 +442,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	Report(contactSolver.m_velocityConstraints);
 
-	if (allowSleep)
+	if (Policy::sleep && allowSleep)
 	{
 		float32 minSleepTime = b2_maxFloat;
 
@@ -463,7 +562,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	// Solve velocity constraints.
 	for (int32 i = 0; i < subStep.velocityIterations; ++i)
 	{
-		contactSolver.SolveVelocityConstraints();
+		contactSolver.SolveVelocityConstraints<b2_maxManifoldPoints>();
 	}
 
 	// Don't store the TOI contact forces for warm starting
@@ -517,7 +616,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_events == NULL)
 	{
 		return;
 	}
@@ -528,14 +627,42 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 
 		const b2ContactVelocityConstraint* vc = constraints + i;
 		
-		b2ContactImpulse impulse;
-		impulse.count = vc->pointCount;
-		for (int32 j = 0; j < vc->pointCount; ++j)
+		if (m_listener)
 		{
-			impulse.normalImpulses[j] = vc->points[j].normalImpulse;
-			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
+			b2ContactImpulse impulse;
+			impulse.count = vc->pointCount;
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				impulse.normalImpulses[j] = vc->points[j].normalImpulse;
+				impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
+			}
+
+			m_listener->PostSolve(c, &impulse);
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_events)
+		{
+			// Report the strongest point if it is above the threshold.
+			int32 hitIndex = -1;
+			float32 maxImpulse = m_hitEventThreshold;
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				if (vc->points[j].normalImpulse > maxImpulse)
+				{
+					maxImpulse = vc->points[j].normalImpulse;
+					hitIndex = j;
+				}
+			}
+
+			if (hitIndex != -1)
+			{
+				b2WorldManifold worldManifold;
+				c->GetWorldManifold(&worldManifold);
+				m_events->AddHitEvent(c, worldManifold.points[hitIndex], worldManifold.normal, maxImpulse);
+			}
+		}
 	}
 }
+
+template void b2Island::Solve<b2DefaultStepPolicy>(b2Profile*, const b2TimeStep&, const b2Vec2&, bool);
+template void b2Island::Solve<b2CircleStepPolicy>(b2Profile*, const b2TimeStep&, const b2Vec2&, bool);
@@ -27,6 +27,7 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+class b2ContactEvents;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -35,7 +36,8 @@ class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactListener* listener,
+			b2ContactEvents* events, float32 hitEventThreshold);
 	~b2Island();
 
 	void Clear()
@@ -45,6 +47,7 @@ public:
 		m_jointCount = 0;
 	}
 
+	template <typename Policy>
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
@@ -73,6 +76,8 @@ public:
 
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
+	b2ContactEvents* m_events;
+	float32 m_hitEventThreshold;
 
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
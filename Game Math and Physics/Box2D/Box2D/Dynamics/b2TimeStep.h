@@ -21,7 +21,8 @@
 
 #include <Box2D/Common/b2Math.h>
 
-/// Profiling data. Times are in milliseconds.
+/// Profiling data. Times are in milliseconds. Iteration counts are summed
+/// over the islands solved in the step.
 struct b2Profile
 {
 	float32 step;
@@ -32,6 +33,54 @@ struct b2Profile
 	float32 solvePosition;
 	float32 broadphase;
 	float32 solveTOI;
+	float32 forceFields;
+	float32 solveRopes;
+	float32 solveParticles;
+	int32 islandCount;
+	int32 velocityIterations;
+	int32 positionIterations;
+	int32 maxVelocityIterations;	// most used by a single island
+	int32 maxPositionIterations;	// most used by a single island
+};
+
+/// The step policies that can be passed to b2World::Step. A step policy selects
+/// the features that are compiled into the step. Features that are left out are
+/// removed from the solver loops entirely, so a world that never uses them steps
+/// faster. Runtime switches such as b2World::SetContinuousPhysics still apply to
+/// the features that are kept. The set of policies is fixed because each one is
+/// compiled into the library.
+enum b2StepPolicy
+{
+	b2_defaultStepPolicy = 0,	///< every feature, see b2DefaultStepPolicy
+	b2_circleStepPolicy			///< no joints and single point contacts, see b2CircleStepPolicy
+};
+
+/// The features of b2_defaultStepPolicy. This is an internal structure.
+struct b2DefaultStepPolicy
+{
+	enum
+	{
+		joints = 1,			///< joints and articulations
+		continuous = 1,		///< time of impact sub-stepping
+		sleep = 1,			///< bodies falling asleep
+		maxPointCount = 2,	///< the most points in a contact manifold
+		profile = 1			///< b2Profile timings
+	};
+};
+
+/// The features of b2_circleStepPolicy, for scenes without joints where every
+/// moving shape is a circle, like a pool table. All contacts of a circle have a
+/// single point. This is an internal structure.
+struct b2CircleStepPolicy
+{
+	enum
+	{
+		joints = 0,
+		continuous = 1,
+		sleep = 1,
+		maxPointCount = 1,
+		profile = 0
+	};
 };
 
 /// This is an internal structure.
@@ -42,7 +91,10 @@ struct b2TimeStep
 	float32 dtRatio;	// dt * inv_dt0
 	int32 velocityIterations;
 	int32 positionIterations;
+	int32 maxVelocityIterations;	// adaptive limits
+	int32 maxPositionIterations;
 	bool warmStarting;
+	bool adaptiveIterations;
 };
 
 /// This is an internal structure.
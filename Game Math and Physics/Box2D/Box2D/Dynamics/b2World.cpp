@@ -19,8 +19,10 @@
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2ForceField.h>
 #include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Joints/b2GearJoint.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Collision/b2Collision.h>
@@ -29,31 +31,56 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Collision/Shapes/b2BoxShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
+#include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Rope/b2Rope.h>
+#include <Box2D/Particle/b2ParticleSystem.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Mutex.h>
 #include <new>
+#include <algorithm>
 
 b2World::b2World(const b2Vec2& gravity)
 {
 	m_destructionListener = NULL;
 	m_debugDraw = NULL;
+	m_stack = &m_stackAllocator;
 
 	m_bodyList = NULL;
 	m_jointList = NULL;
+	m_ropeList = NULL;
+	m_particleSystemList = NULL;
+	m_forceFieldList = NULL;
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
+	m_ropeCount = 0;
+	m_particleSystemCount = 0;
+	m_forceFieldCount = 0;
 
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
+	m_adaptiveIterations = false;
+	m_maxVelocityIterations = 20;
+	m_maxPositionIterations = 10;
+
 	m_stepComplete = true;
 
 	m_allowSleep = true;
 	m_gravity = gravity;
 
+	m_contactEventsEnabled = false;
+	m_hitEventThreshold = 1.0f;
+
+	m_stepEpoch = 0;
+	m_queryGuardEnabled = false;
+
 	m_flags = e_clearForces;
 
 	m_inv_dt0 = 0.0f;
@@ -82,6 +109,24 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	// Ropes allocate using b2Alloc.
+	b2Rope* r = m_ropeList;
+	while (r)
+	{
+		b2Rope* rNext = r->m_next;
+		r->~b2Rope();
+		r = rNext;
+	}
+
+	// Particle systems allocate using b2Alloc.
+	b2ParticleSystem* ps = m_particleSystemList;
+	while (ps)
+	{
+		b2ParticleSystem* psNext = ps->m_next;
+		ps->~b2ParticleSystem();
+		ps = psNext;
+	}
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -91,7 +136,7 @@ void b2World::SetDestructionListener(b2DestructionListener* listener)
 
 void b2World::SetContactFilter(b2ContactFilter* filter)
 {
-	m_contactManager.m_contactFilter = filter;
+	m_contactManager.SetContactFilter(filter);
 }
 
 void b2World::SetContactListener(b2ContactListener* listener)
@@ -99,6 +144,40 @@ void b2World::SetContactListener(b2ContactListener* listener)
 	m_contactManager.m_contactListener = listener;
 }
 
+void b2World::SetMaxIterations(int32 velocityIterations, int32 positionIterations)
+{
+	b2Assert(velocityIterations > 0 && positionIterations >= 0);
+	m_maxVelocityIterations = velocityIterations;
+	m_maxPositionIterations = positionIterations;
+}
+
+void b2World::SetThreadCount(int32 threadCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_threadPool.SetThreadCount(threadCount);
+}
+
+void b2World::SetContactEventsEnabled(bool flag)
+{
+	m_contactEventsEnabled = flag;
+	if (flag == false)
+	{
+		m_contactEvents.Clear();
+	}
+}
+
+void b2World::SwapContactEvents(b2ContactEvents* events)
+{
+	b2Assert(IsLocked() == false);
+	m_contactEvents.Swap(events);
+	m_contactEvents.Clear();
+}
+
 void b2World::SetDebugDraw(b2Draw* debugDraw)
 {
 	m_debugDraw = debugDraw;
@@ -155,6 +234,22 @@ void b2World::DestroyBody(b2Body* b)
 	}
 	b->m_jointList = NULL;
 
+	// Release the attached rope ends.
+	for (b2Rope* r = m_ropeList; r; r = r->m_next)
+	{
+		if (r->m_bodyA == b)
+		{
+			r->m_bodyA = NULL;
+			r->m_ims[0] = r->m_imA;
+		}
+
+		if (r->m_bodyB == b)
+		{
+			r->m_bodyB = NULL;
+			r->m_ims[r->m_count - 1] = r->m_imB;
+		}
+	}
+
 	// Delete the attached contacts.
 	b2ContactEdge* ce = b->m_contactList;
 	while (ce)
@@ -209,6 +304,690 @@ void b2World::DestroyBody(b2Body* b)
 	m_blockAllocator.Free(b, sizeof(b2Body));
 }
 
+void b2World::CreateBodies(const b2BodyDef* defs, int32 count, b2Body** bodies, const b2FixtureDef* fixtureDefs)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Count the proxies of active bodies. Static proxies go first.
+	int32 staticCount = 0;
+	int32 proxyCount = 0;
+	if (fixtureDefs)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (defs[i].active && fixtureDefs[i].shape)
+			{
+				int32 childCount = fixtureDefs[i].shape->GetChildCount();
+				proxyCount += childCount;
+				if (defs[i].type == b2_staticBody)
+				{
+					staticCount += childCount;
+				}
+			}
+		}
+	}
+
+	b2AABB* aabbs = (b2AABB*)m_stack->Allocate(proxyCount * sizeof(b2AABB));
+	void** userData = (void**)m_stack->Allocate(proxyCount * sizeof(void*));
+	b2Filter* filters = (b2Filter*)m_stack->Allocate(proxyCount * sizeof(b2Filter));
+	int32* proxyIds = (int32*)m_stack->Allocate(proxyCount * sizeof(int32));
+	int32 staticIndex = 0;
+	int32 dynamicIndex = staticCount;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
+		b2Body* b = new (mem) b2Body(defs + i, this);
+
+		// Add to world doubly linked list.
+		b->m_prev = NULL;
+		b->m_next = m_bodyList;
+		if (m_bodyList)
+		{
+			m_bodyList->m_prev = b;
+		}
+		m_bodyList = b;
+		++m_bodyCount;
+
+		if (bodies)
+		{
+			bodies[i] = b;
+		}
+
+		if (fixtureDefs == NULL || fixtureDefs[i].shape == NULL)
+		{
+			continue;
+		}
+
+		void* memory = m_blockAllocator.Allocate(sizeof(b2Fixture));
+		b2Fixture* fixture = new (memory) b2Fixture;
+		fixture->Create(&m_blockAllocator, b, fixtureDefs + i);
+
+		b->m_fixtureList = fixture;
+		b->m_fixtureCount = 1;
+
+		if (fixture->m_density > 0.0f)
+		{
+			b->ResetMassData();
+		}
+
+		if ((b->m_flags & b2Body::e_activeFlag) == 0)
+		{
+			continue;
+		}
+
+		// Gather the proxies. The broad-phase ids are filled in below.
+		fixture->m_proxyCount = fixture->m_shape->GetChildCount();
+		for (int32 j = 0; j < fixture->m_proxyCount; ++j)
+		{
+			b2FixtureProxy* proxy = fixture->m_proxies + j;
+			fixture->m_shape->ComputeAABB(&proxy->aabb, b->m_xf, j);
+			proxy->fixture = fixture;
+			proxy->childIndex = j;
+
+			int32 index = b->m_type == b2_staticBody ? staticIndex++ : dynamicIndex++;
+			aabbs[index] = proxy->aabb;
+			userData[index] = proxy;
+			filters[index] = fixture->m_filter;
+		}
+	}
+
+	b2Assert(staticIndex == staticCount && dynamicIndex == proxyCount);
+
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	broadPhase->CreateProxies(aabbs, userData, filters, staticCount, true, proxyIds);
+	broadPhase->CreateProxies(aabbs + staticCount, userData + staticCount, filters + staticCount,
+							  proxyCount - staticCount, false, proxyIds + staticCount);
+
+	for (int32 i = 0; i < proxyCount; ++i)
+	{
+		((b2FixtureProxy*)userData[i])->proxyId = proxyIds[i];
+	}
+
+	m_stack->Free(proxyIds);
+	m_stack->Free(filters);
+	m_stack->Free(userData);
+	m_stack->Free(aabbs);
+
+	if (fixtureDefs)
+	{
+		m_flags |= e_newFixture;
+	}
+}
+
+void b2World::DestroyBodies(b2Body* const* bodies, int32 count)
+{
+	b2Assert(m_bodyCount >= count);
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Delete the attached joints and contacts. Contacts need the proxies
+	// of both fixtures, so these go before any fixture.
+	int32 proxyCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+
+		b2JointEdge* je = b->m_jointList;
+		while (je)
+		{
+			b2JointEdge* je0 = je;
+			je = je->next;
+
+			if (m_destructionListener)
+			{
+				m_destructionListener->SayGoodbye(je0->joint);
+			}
+
+			DestroyJoint(je0->joint);
+
+			b->m_jointList = je;
+		}
+		b->m_jointList = NULL;
+
+		// Release the attached rope ends.
+		for (b2Rope* r = m_ropeList; r; r = r->m_next)
+		{
+			if (r->m_bodyA == b)
+			{
+				r->m_bodyA = NULL;
+				r->m_ims[0] = r->m_imA;
+			}
+
+			if (r->m_bodyB == b)
+			{
+				r->m_bodyB = NULL;
+				r->m_ims[r->m_count - 1] = r->m_imB;
+			}
+		}
+
+		b2ContactEdge* ce = b->m_contactList;
+		while (ce)
+		{
+			b2ContactEdge* ce0 = ce;
+			ce = ce->next;
+			m_contactManager.Destroy(ce0->contact);
+		}
+		b->m_contactList = NULL;
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			proxyCount += f->m_proxyCount;
+		}
+	}
+
+	// Delete the fixtures and gather their proxies.
+	int32* proxyIds = (int32*)m_stack->Allocate(proxyCount * sizeof(int32));
+	int32 proxyIndex = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+
+		b2Fixture* f = b->m_fixtureList;
+		while (f)
+		{
+			b2Fixture* f0 = f;
+			f = f->m_next;
+
+			if (m_destructionListener)
+			{
+				m_destructionListener->SayGoodbye(f0);
+			}
+
+			for (int32 j = 0; j < f0->m_proxyCount; ++j)
+			{
+				proxyIds[proxyIndex++] = f0->m_proxies[j].proxyId;
+			}
+			f0->m_proxyCount = 0;
+
+			f0->Destroy(&m_blockAllocator);
+			f0->~b2Fixture();
+			m_blockAllocator.Free(f0, sizeof(b2Fixture));
+		}
+		b->m_fixtureList = NULL;
+		b->m_fixtureCount = 0;
+	}
+
+	b2Assert(proxyIndex == proxyCount);
+	m_contactManager.m_broadPhase.DestroyProxies(proxyIds, proxyCount);
+	m_stack->Free(proxyIds);
+
+	// Remove from the world body list.
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+
+		if (b->m_prev)
+		{
+			b->m_prev->m_next = b->m_next;
+		}
+
+		if (b->m_next)
+		{
+			b->m_next->m_prev = b->m_prev;
+		}
+
+		if (b == m_bodyList)
+		{
+			m_bodyList = b->m_next;
+		}
+
+		--m_bodyCount;
+		b->~b2Body();
+		m_blockAllocator.Free(b, sizeof(b2Body));
+	}
+}
+
+void b2World::Clear()
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Some shapes allocate using b2Alloc. Everything else lives in the
+	// block allocator, which is released as a whole.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->m_proxyCount = 0;
+			f->Destroy(&m_blockAllocator);
+		}
+	}
+
+	// Ropes allocate using b2Alloc.
+	b2Rope* r = m_ropeList;
+	while (r)
+	{
+		b2Rope* rNext = r->m_next;
+		r->~b2Rope();
+		r = rNext;
+	}
+
+	// Particle systems allocate using b2Alloc.
+	b2ParticleSystem* ps = m_particleSystemList;
+	while (ps)
+	{
+		b2ParticleSystem* psNext = ps->m_next;
+		ps->~b2ParticleSystem();
+		ps = psNext;
+	}
+
+	m_blockAllocator.Clear();
+	m_contactManager.Clear();
+	m_contactEvents.Clear();
+
+	m_bodyList = NULL;
+	m_jointList = NULL;
+	m_ropeList = NULL;
+	m_particleSystemList = NULL;
+	m_forceFieldList = NULL;
+
+	m_bodyCount = 0;
+	m_jointCount = 0;
+	m_ropeCount = 0;
+	m_particleSystemCount = 0;
+	m_forceFieldCount = 0;
+
+	m_flags &= ~e_newFixture;
+}
+
+// Maps an object of the source world to its copy.
+struct b2CopyEntry
+{
+	const void* source;
+	void* copy;
+
+	bool operator<(const b2CopyEntry& other) const
+	{
+		return source < other.source;
+	}
+};
+
+static void* b2FindCopy(const b2CopyEntry* entries, int32 count, const void* source)
+{
+	if (source == NULL)
+	{
+		return NULL;
+	}
+
+	b2CopyEntry key;
+	key.source = source;
+	const b2CopyEntry* entry = std::lower_bound(entries, entries + count, key);
+	b2Assert(entry < entries + count && entry->source == source);
+	return entry->copy;
+}
+
+// A fixture with contacts has proxies, and the copied broad-phase already
+// points at the proxies of the copy.
+static b2Fixture* b2FindFixtureCopy(const b2BroadPhase* broadPhase, const b2FixtureProxy* proxies)
+{
+	b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxies[0].proxyId);
+	return proxy->fixture;
+}
+
+void b2World::Copy(const b2World& world)
+{
+	b2Assert(IsLocked() == false);
+	b2Assert(world.IsLocked() == false);
+	if (IsLocked() || &world == this)
+	{
+		return;
+	}
+
+	Clear();
+
+	m_flags = world.m_flags;
+	m_gravity = world.m_gravity;
+	m_allowSleep = world.m_allowSleep;
+	m_contactEventsEnabled = world.m_contactEventsEnabled;
+	m_hitEventThreshold = world.m_hitEventThreshold;
+	m_inv_dt0 = world.m_inv_dt0;
+	m_warmStarting = world.m_warmStarting;
+	m_continuousPhysics = world.m_continuousPhysics;
+	m_subStepping = world.m_subStepping;
+	m_adaptiveIterations = world.m_adaptiveIterations;
+	m_maxVelocityIterations = world.m_maxVelocityIterations;
+	m_maxPositionIterations = world.m_maxPositionIterations;
+	m_stepComplete = world.m_stepComplete;
+
+	// Proxy ids, the pair set and the pair array carry over as they are.
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	m_contactManager.Copy(world.m_contactManager);
+
+	b2CopyEntry* bodyMap = (b2CopyEntry*)m_stack->Allocate(world.m_bodyCount * sizeof(b2CopyEntry));
+	b2CopyEntry* jointMap = (b2CopyEntry*)m_stack->Allocate(world.m_jointCount * sizeof(b2CopyEntry));
+	b2Contact** contactMap = (b2Contact**)m_stack->Allocate(world.GetContactCount() * sizeof(b2Contact*));
+
+	// Copy the bodies and fixtures, keeping the list order.
+	b2Body* bodyTail = NULL;
+	int32 bodyCount = 0;
+	for (const b2Body* sb = world.m_bodyList; sb; sb = sb->m_next)
+	{
+		void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
+		b2Body* b = new (mem) b2Body(*sb);
+		b->m_world = this;
+		b->m_jointList = NULL;
+		b->m_contactList = NULL;
+
+		b->m_prev = bodyTail;
+		b->m_next = NULL;
+		if (bodyTail)
+		{
+			bodyTail->m_next = b;
+		}
+		else
+		{
+			m_bodyList = b;
+		}
+		bodyTail = b;
+
+		b2Fixture** fixtureLink = &b->m_fixtureList;
+		for (const b2Fixture* sf = sb->m_fixtureList; sf; sf = sf->m_next)
+		{
+			void* fixtureMem = m_blockAllocator.Allocate(sizeof(b2Fixture));
+			b2Fixture* f = new (fixtureMem) b2Fixture;
+			f->Copy(&m_blockAllocator, b, sf);
+
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				broadPhase->SetUserData(f->m_proxies[i].proxyId, f->m_proxies + i);
+			}
+
+			*fixtureLink = f;
+			fixtureLink = &f->m_next;
+		}
+
+		bodyMap[bodyCount].source = sb;
+		bodyMap[bodyCount].copy = b;
+		++bodyCount;
+	}
+	m_bodyCount = bodyCount;
+	std::sort(bodyMap, bodyMap + bodyCount);
+
+	// Copy the joints.
+	b2Joint* jointTail = NULL;
+	int32 jointCount = 0;
+	for (const b2Joint* sj = world.m_jointList; sj; sj = sj->m_next)
+	{
+		b2Joint* j = b2Joint::Clone(sj, &m_blockAllocator);
+		j->m_bodyA = (b2Body*)b2FindCopy(bodyMap, bodyCount, sj->m_bodyA);
+		j->m_bodyB = (b2Body*)b2FindCopy(bodyMap, bodyCount, sj->m_bodyB);
+		j->m_edgeA.joint = j;
+		j->m_edgeA.other = j->m_bodyB;
+		j->m_edgeB.joint = j;
+		j->m_edgeB.other = j->m_bodyA;
+
+		j->m_prev = jointTail;
+		j->m_next = NULL;
+		if (jointTail)
+		{
+			jointTail->m_next = j;
+		}
+		else
+		{
+			m_jointList = j;
+		}
+		jointTail = j;
+
+		jointMap[jointCount].source = sj;
+		jointMap[jointCount].copy = j;
+		++jointCount;
+	}
+	m_jointCount = jointCount;
+	std::sort(jointMap, jointMap + jointCount);
+
+	// Gear joints refer to two other joints and their bodies.
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type == e_gearJoint)
+		{
+			b2GearJoint* gear = (b2GearJoint*)j;
+			gear->m_joint1 = (b2Joint*)b2FindCopy(jointMap, jointCount, gear->m_joint1);
+			gear->m_joint2 = (b2Joint*)b2FindCopy(jointMap, jointCount, gear->m_joint2);
+			gear->m_bodyC = (b2Body*)b2FindCopy(bodyMap, bodyCount, gear->m_bodyC);
+			gear->m_bodyD = (b2Body*)b2FindCopy(bodyMap, bodyCount, gear->m_bodyD);
+		}
+	}
+
+	// Copy the contacts. The pair index identifies a contact in both worlds.
+	b2Contact* contactTail = NULL;
+	for (const b2Contact* sc = world.m_contactManager.m_contactList; sc; sc = sc->m_next)
+	{
+		b2Contact* c = b2Contact::Clone(sc, &m_blockAllocator);
+		c->m_fixtureA = b2FindFixtureCopy(broadPhase, sc->m_fixtureA->m_proxies);
+		c->m_fixtureB = b2FindFixtureCopy(broadPhase, sc->m_fixtureB->m_proxies);
+		c->m_nodeA.contact = c;
+		c->m_nodeA.other = c->m_fixtureB->m_body;
+		c->m_nodeB.contact = c;
+		c->m_nodeB.other = c->m_fixtureA->m_body;
+
+		c->m_prev = contactTail;
+		c->m_next = NULL;
+		if (contactTail)
+		{
+			contactTail->m_next = c;
+		}
+		else
+		{
+			m_contactManager.m_contactList = c;
+		}
+		contactTail = c;
+
+		contactMap[sc->m_pairIndex] = c;
+	}
+
+	for (int32 i = 0; i < m_contactManager.m_contactCount; ++i)
+	{
+		b2ContactPair* pair = m_contactManager.m_pairs + i;
+		b2Contact* c = contactMap[i];
+		pair->contact = c;
+		pair->bodyA = c->m_fixtureA->m_body;
+		pair->bodyB = c->m_fixtureB->m_body;
+	}
+
+	// Rebuild the joint and contact edge lists of each body in the same order.
+	const b2Body* sb = world.m_bodyList;
+	for (b2Body* b = m_bodyList; b; b = b->m_next, sb = sb->m_next)
+	{
+		b2JointEdge* jointEdgeTail = NULL;
+		for (const b2JointEdge* se = sb->m_jointList; se; se = se->next)
+		{
+			b2Joint* j = (b2Joint*)b2FindCopy(jointMap, jointCount, se->joint);
+			b2JointEdge* edge = se == &se->joint->m_edgeA ? &j->m_edgeA : &j->m_edgeB;
+			edge->prev = jointEdgeTail;
+			edge->next = NULL;
+			if (jointEdgeTail)
+			{
+				jointEdgeTail->next = edge;
+			}
+			else
+			{
+				b->m_jointList = edge;
+			}
+			jointEdgeTail = edge;
+		}
+
+		b2ContactEdge* contactEdgeTail = NULL;
+		for (const b2ContactEdge* se = sb->m_contactList; se; se = se->next)
+		{
+			b2Contact* c = contactMap[se->contact->m_pairIndex];
+			b2ContactEdge* edge = se == &se->contact->m_nodeA ? &c->m_nodeA : &c->m_nodeB;
+			edge->prev = contactEdgeTail;
+			edge->next = NULL;
+			if (contactEdgeTail)
+			{
+				contactEdgeTail->next = edge;
+			}
+			else
+			{
+				b->m_contactList = edge;
+			}
+			contactEdgeTail = edge;
+		}
+	}
+
+	// Copy the ropes.
+	b2Rope* ropeTail = NULL;
+	for (const b2Rope* sr = world.m_ropeList; sr; sr = sr->m_next)
+	{
+		void* mem = m_blockAllocator.Allocate(sizeof(b2Rope));
+		b2Rope* r = new (mem) b2Rope;
+		r->Copy(sr);
+		r->m_bodyA = (b2Body*)b2FindCopy(bodyMap, bodyCount, sr->m_bodyA);
+		r->m_bodyB = (b2Body*)b2FindCopy(bodyMap, bodyCount, sr->m_bodyB);
+
+		r->m_prev = ropeTail;
+		r->m_next = NULL;
+		if (ropeTail)
+		{
+			ropeTail->m_next = r;
+		}
+		else
+		{
+			m_ropeList = r;
+		}
+		ropeTail = r;
+	}
+	m_ropeCount = world.m_ropeCount;
+
+	// Copy the particle systems.
+	b2ParticleSystem* systemTail = NULL;
+	for (const b2ParticleSystem* sps = world.m_particleSystemList; sps; sps = sps->m_next)
+	{
+		b2ParticleSystemDef def;
+		void* mem = m_blockAllocator.Allocate(sizeof(b2ParticleSystem));
+		b2ParticleSystem* ps = new (mem) b2ParticleSystem(&def, this);
+		ps->Copy(sps);
+
+		ps->m_prev = systemTail;
+		ps->m_next = NULL;
+		if (systemTail)
+		{
+			systemTail->m_next = ps;
+		}
+		else
+		{
+			m_particleSystemList = ps;
+		}
+		systemTail = ps;
+	}
+	m_particleSystemCount = world.m_particleSystemCount;
+
+	// Copy the force fields.
+	b2ForceField* fieldTail = NULL;
+	for (const b2ForceField* sf = world.m_forceFieldList; sf; sf = sf->m_next)
+	{
+		void* mem = m_blockAllocator.Allocate(sizeof(b2ForceField));
+		b2ForceField* f = new (mem) b2ForceField(*sf);
+
+		f->m_prev = fieldTail;
+		f->m_next = NULL;
+		if (fieldTail)
+		{
+			fieldTail->m_next = f;
+		}
+		else
+		{
+			m_forceFieldList = f;
+		}
+		fieldTail = f;
+	}
+	m_forceFieldCount = world.m_forceFieldCount;
+
+	m_stack->Free(contactMap);
+	m_stack->Free(jointMap);
+	m_stack->Free(bodyMap);
+}
+
+void b2World::GetTransforms(float32* transforms) const
+{
+	for (const b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		transforms[0] = b->m_xf.p.x;
+		transforms[1] = b->m_xf.p.y;
+		transforms[2] = b->m_sweep.a;
+		transforms += 3;
+	}
+}
+
+void b2World::GetTransforms(const b2Body* const* bodies, int32 count, float32* transforms) const
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		const b2Body* b = bodies[i];
+		transforms[0] = b->m_xf.p.x;
+		transforms[1] = b->m_xf.p.y;
+		transforms[2] = b->m_sweep.a;
+		transforms += 3;
+	}
+}
+
+void b2World::SetTransforms(b2Body* const* bodies, const float32* transforms, int32 count)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	int32 proxyCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+		float32 angle = transforms[3 * i + 2];
+
+		b->m_xf.q.Set(angle);
+		b->m_xf.p.Set(transforms[3 * i], transforms[3 * i + 1]);
+
+		b->m_sweep.c = b2Mul(b->m_xf, b->m_sweep.localCenter);
+		b->m_sweep.a = angle;
+
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = angle;
+		b->m_stepsPending = 0;
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			proxyCount += f->m_proxyCount;
+		}
+	}
+
+	// The body does not sweep, so one AABB per proxy is enough.
+	int32* proxyIds = (int32*)m_stack->Allocate(proxyCount * sizeof(int32));
+	b2AABB* aabbs = (b2AABB*)m_stack->Allocate(proxyCount * sizeof(b2AABB));
+	int32 proxyIndex = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
+			{
+				b2FixtureProxy* proxy = f->m_proxies + j;
+				f->m_shape->ComputeAABB(&proxy->aabb, b->m_xf, proxy->childIndex);
+				proxyIds[proxyIndex] = proxy->proxyId;
+				aabbs[proxyIndex] = proxy->aabb;
+				++proxyIndex;
+			}
+		}
+	}
+
+	m_contactManager.m_broadPhase.MoveProxies(proxyIds, aabbs, proxyCount);
+
+	m_stack->Free(aabbs);
+	m_stack->Free(proxyIds);
+}
+
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -257,7 +1036,7 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 			{
 				// Flag the contact for filtering at the next time step (where either
 				// body is awake).
-				edge->contact->FlagForFiltering();
+				m_contactManager.FlagForFiltering(edge->contact);
 			}
 
 			edge = edge->next;
@@ -356,15 +1135,189 @@ void b2World::DestroyJoint(b2Joint* j)
 			{
 				// Flag the contact for filtering at the next time step (where either
 				// body is awake).
-				edge->contact->FlagForFiltering();
+				m_contactManager.FlagForFiltering(edge->contact);
 			}
 
-			edge = edge->next;
-		}
+			edge = edge->next;
+		}
+	}
+}
+
+//
+b2Rope* b2World::CreateRope(const b2RopeDef* def)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	void* mem = m_blockAllocator.Allocate(sizeof(b2Rope));
+	b2Rope* r = new (mem) b2Rope;
+	r->Initialize(def);
+
+	// Pinned ends are moved by their bodies.
+	if (r->m_bodyA)
+	{
+		r->m_ims[0] = 0.0f;
+	}
+
+	if (r->m_bodyB)
+	{
+		r->m_ims[r->m_count - 1] = 0.0f;
+	}
+
+	// Add to world doubly linked list.
+	r->m_prev = NULL;
+	r->m_next = m_ropeList;
+	if (m_ropeList)
+	{
+		m_ropeList->m_prev = r;
+	}
+	m_ropeList = r;
+	++m_ropeCount;
+
+	return r;
+}
+
+void b2World::DestroyRope(b2Rope* r)
+{
+	b2Assert(m_ropeCount > 0);
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Remove from the world.
+	if (r->m_prev)
+	{
+		r->m_prev->m_next = r->m_next;
+	}
+
+	if (r->m_next)
+	{
+		r->m_next->m_prev = r->m_prev;
+	}
+
+	if (r == m_ropeList)
+	{
+		m_ropeList = r->m_next;
+	}
+
+	--m_ropeCount;
+	r->~b2Rope();
+	m_blockAllocator.Free(r, sizeof(b2Rope));
+}
+
+b2ParticleSystem* b2World::CreateParticleSystem(const b2ParticleSystemDef* def)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	void* mem = m_blockAllocator.Allocate(sizeof(b2ParticleSystem));
+	b2ParticleSystem* ps = new (mem) b2ParticleSystem(def, this);
+
+	// Add to world doubly linked list.
+	ps->m_prev = NULL;
+	ps->m_next = m_particleSystemList;
+	if (m_particleSystemList)
+	{
+		m_particleSystemList->m_prev = ps;
+	}
+	m_particleSystemList = ps;
+	++m_particleSystemCount;
+
+	return ps;
+}
+
+void b2World::DestroyParticleSystem(b2ParticleSystem* ps)
+{
+	b2Assert(m_particleSystemCount > 0);
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Remove from the world.
+	if (ps->m_prev)
+	{
+		ps->m_prev->m_next = ps->m_next;
+	}
+
+	if (ps->m_next)
+	{
+		ps->m_next->m_prev = ps->m_prev;
+	}
+
+	if (ps == m_particleSystemList)
+	{
+		m_particleSystemList = ps->m_next;
+	}
+
+	--m_particleSystemCount;
+	ps->~b2ParticleSystem();
+	m_blockAllocator.Free(ps, sizeof(b2ParticleSystem));
+}
+
+b2ForceField* b2World::CreateForceField(const b2ForceFieldDef* def)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	void* mem = m_blockAllocator.Allocate(sizeof(b2ForceField));
+	b2ForceField* f = new (mem) b2ForceField(def);
+
+	// Add to world doubly linked list.
+	f->m_prev = NULL;
+	f->m_next = m_forceFieldList;
+	if (m_forceFieldList)
+	{
+		m_forceFieldList->m_prev = f;
+	}
+	m_forceFieldList = f;
+	++m_forceFieldCount;
+
+	return f;
+}
+
+void b2World::DestroyForceField(b2ForceField* f)
+{
+	b2Assert(m_forceFieldCount > 0);
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Remove from the world.
+	if (f->m_prev)
+	{
+		f->m_prev->m_next = f->m_next;
+	}
+
+	if (f->m_next)
+	{
+		f->m_next->m_prev = f->m_prev;
 	}
+
+	if (f == m_forceFieldList)
+	{
+		m_forceFieldList = f->m_next;
+	}
+
+	--m_forceFieldCount;
+	f->~b2ForceField();
+	m_blockAllocator.Free(f, sizeof(b2ForceField));
 }
 
-//
 void b2World::SetAllowSleeping(bool flag)
 {
 	if (flag == m_allowSleep)
@@ -383,18 +1336,26 @@ void b2World::SetAllowSleeping(bool flag)
 }
 
 // Find islands, integrate and solve constraints, solve position constraints
+template <typename Policy>
 void b2World::Solve(const b2TimeStep& step)
 {
 	m_profile.solveInit = 0.0f;
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
+	m_profile.islandCount = 0;
+	m_profile.velocityIterations = 0;
+	m_profile.positionIterations = 0;
+	m_profile.maxVelocityIterations = 0;
+	m_profile.maxPositionIterations = 0;
 
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+					Policy::joints ? m_jointCount : 0,
+					m_stack,
+					m_contactManager.m_contactListener,
+					m_contactManager.m_contactEvents,
+					m_hitEventThreshold);
 
 	// Clear all the island flags.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
@@ -412,7 +1373,7 @@ void b2World::Solve(const b2TimeStep& step)
 
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)m_stack->Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
 		if (seed->m_flags & b2Body::e_islandFlag)
@@ -497,8 +1458,9 @@ void b2World::Solve(const b2TimeStep& step)
 				other->m_flags |= b2Body::e_islandFlag;
 			}
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			// Search all joints connect to this body, unless the policy has none.
+			b2JointEdge* jointList = Policy::joints ? b->m_jointList : NULL;
+			for (b2JointEdge* je = jointList; je; je = je->next)
 			{
 				if (je->joint->m_islandFlag == true)
 				{
@@ -527,11 +1489,58 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+		// The island is solved at the rate of its fastest body. If all of its
+		// bodies are still part way through a coarse step, just move them along.
+		int32 divisor = b2_maxStepDivisor;
+		bool pending = true;
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* b = island.m_bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			divisor = b2Min(divisor, b->m_stepDivisor);
+			pending = pending && b->m_stepsPending > 0;
+		}
+
+		if (pending)
+		{
+			AdvancePending(island);
+		}
+		else
+		{
+			b2TimeStep islandStep = step;
+			islandStep.dt *= divisor;
+			islandStep.inv_dt /= divisor;
+
+			b2Profile profile;
+			island.Solve<Policy>(&profile, islandStep, m_gravity, m_allowSleep);
+			m_profile.solveInit += profile.solveInit;
+			m_profile.solveVelocity += profile.solveVelocity;
+			m_profile.solvePosition += profile.solvePosition;
+			m_profile.islandCount += 1;
+			m_profile.velocityIterations += profile.velocityIterations;
+			m_profile.positionIterations += profile.positionIterations;
+			m_profile.maxVelocityIterations = b2Max(m_profile.maxVelocityIterations, profile.velocityIterations);
+			m_profile.maxPositionIterations = b2Max(m_profile.maxPositionIterations, profile.positionIterations);
+
+			if (divisor > 1)
+			{
+				BeginPending(island, divisor);
+			}
+			else
+			{
+				// Slow bodies that joined a full rate island drop their coarse
+				// targets, otherwise they would be pulled back to them once the
+				// island splits again.
+				for (int32 i = 0; i < island.m_bodyCount; ++i)
+				{
+					island.m_bodies[i]->m_stepsPending = 0;
+				}
+			}
+		}
 
 		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -545,10 +1554,10 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
-	m_stackAllocator.Free(stack);
+	m_stack->Free(stack);
 
 	{
-		b2Timer timer;
+		b2OptionalTimer<Policy::profile != 0> timer;
 		// Synchronize fixtures, check for out of range bodies.
 		for (b2Body* b = m_bodyList; b; b = b->GetNext())
 		{
@@ -573,10 +1582,58 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
+// Keep the end of a coarse island step as the target of its bodies and move them
+// back to the end of the first fine step. They reach the target over the
+// following steps.
+void b2World::BeginPending(b2Island& island, int32 divisor)
+{
+	float32 fraction = 1.0f / divisor;
+	for (int32 i = 0; i < island.m_bodyCount; ++i)
+	{
+		b2Body* b = island.m_bodies[i];
+		if (b->GetType() == b2_staticBody || b->IsAwake() == false)
+		{
+			continue;
+		}
+
+		b2Sweep& sweep = b->m_sweep;
+		b->m_targetCenter = sweep.c;
+		b->m_targetAngle = sweep.a;
+		b->m_stepsPending = divisor - 1;
+
+		sweep.c = sweep.c0 + fraction * (sweep.c - sweep.c0);
+		sweep.a = sweep.a0 + fraction * (sweep.a - sweep.a0);
+		b->SynchronizeTransform();
+	}
+}
+
+// Move the bodies of an island one fine step closer to their targets.
+void b2World::AdvancePending(b2Island& island)
+{
+	for (int32 i = 0; i < island.m_bodyCount; ++i)
+	{
+		b2Body* b = island.m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2Sweep& sweep = b->m_sweep;
+		float32 fraction = 1.0f / b->m_stepsPending;
+		sweep.c0 = sweep.c;
+		sweep.a0 = sweep.a;
+		sweep.c += fraction * (b->m_targetCenter - sweep.c);
+		sweep.a += fraction * (b->m_targetAngle - sweep.a);
+		b->SynchronizeTransform();
+		--b->m_stepsPending;
+	}
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, m_stack, m_contactManager.m_contactListener,
+					m_contactManager.m_contactEvents, m_hitEventThreshold);
 
 	if (m_stepComplete)
 	{
@@ -649,6 +1706,15 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					continue;
 				}
 
+				// Bodies part way through a coarse step follow a path that was
+				// already solved.
+				bool pendingA = activeA == false || bA->m_stepsPending > 0;
+				bool pendingB = activeB == false || bB->m_stepsPending > 0;
+				if (pendingA && pendingB)
+				{
+					continue;
+				}
+
 				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
 				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
 
@@ -732,7 +1798,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(m_contactManager.m_contactListener, m_contactManager.m_contactEvents);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -804,99 +1870,557 @@ void b2World::SolveTOI(const b2TimeStep& step)
 						continue;
 					}
 
-					// Tentatively advance the body to the TOI.
-					b2Sweep backup = other->m_sweep;
-					if ((other->m_flags & b2Body::e_islandFlag) == 0)
-					{
-						other->Advance(minAlpha);
-					}
+					// Tentatively advance the body to the TOI.
+					b2Sweep backup = other->m_sweep;
+					if ((other->m_flags & b2Body::e_islandFlag) == 0)
+					{
+						other->Advance(minAlpha);
+					}
+
+					// Update the contact points
+					contact->Update(m_contactManager.m_contactListener, m_contactManager.m_contactEvents);
+
+					// Was the contact disabled by the user?
+					if (contact->IsEnabled() == false)
+					{
+						other->m_sweep = backup;
+						other->SynchronizeTransform();
+						continue;
+					}
+
+					// Are there contact points?
+					if (contact->IsTouching() == false)
+					{
+						other->m_sweep = backup;
+						other->SynchronizeTransform();
+						continue;
+					}
+
+					// Add the contact to the island
+					contact->m_flags |= b2Contact::e_islandFlag;
+					island.Add(contact);
+
+					// Has the other body already been added to the island?
+					if (other->m_flags & b2Body::e_islandFlag)
+					{
+						continue;
+					}
+					
+					// Add the other body to the island.
+					other->m_flags |= b2Body::e_islandFlag;
+
+					if (other->m_type != b2_staticBody)
+					{
+						other->SetAwake(true);
+					}
+
+					island.Add(other);
+				}
+			}
+		}
+
+		b2TimeStep subStep;
+		subStep.dt = (1.0f - minAlpha) * step.dt;
+		subStep.inv_dt = 1.0f / subStep.dt;
+		subStep.dtRatio = 1.0f;
+		subStep.positionIterations = 20;
+		subStep.velocityIterations = step.velocityIterations;
+		subStep.maxPositionIterations = subStep.positionIterations;
+		subStep.maxVelocityIterations = subStep.velocityIterations;
+		subStep.warmStarting = false;
+		subStep.adaptiveIterations = false;
+		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
+
+		// Reset island flags and synchronize broad-phase proxies.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			body->m_flags &= ~b2Body::e_islandFlag;
+
+			if (body->m_type != b2_dynamicBody)
+			{
+				continue;
+			}
+
+			// The impact overrides any coarse step in progress.
+			body->m_stepsPending = 0;
+
+			body->SynchronizeFixtures();
+
+			// Invalidate all contact TOIs on this displaced body.
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				ce->contact->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			}
+		}
+
+		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
+		// Also, some contacts can be destroyed.
+		m_contactManager.FindNewContacts();
+
+		if (m_subStepping)
+		{
+			m_stepComplete = false;
+			break;
+		}
+	}
+}
+
+// Bring a world query box into the frame of a body.
+static b2AABB b2ComputeLocalAABB(const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 center = b2MulT(xf, aabb.GetCenter());
+	b2Vec2 h = aabb.GetExtents();
+	b2Vec2 r;
+	r.x = b2Abs(xf.q.c) * h.x + b2Abs(xf.q.s) * h.y;
+	r.y = b2Abs(xf.q.s) * h.x + b2Abs(xf.q.c) * h.y;
+
+	b2AABB localAABB;
+	localAABB.lowerBound = center - r;
+	localAABB.upperBound = center + r;
+	return localAABB;
+}
+
+// A fixture child near a run of rope vertices.
+struct b2RopeCandidate
+{
+	b2Fixture* fixture;
+	int32 childIndex;
+	b2AABB aabb;
+	int32 begin, end;
+};
+
+// A growable array of rope candidates.
+struct b2RopeCandidateBuffer
+{
+	b2RopeCandidateBuffer()
+	{
+		candidates = NULL;
+		count = 0;
+		capacity = 0;
+	}
+
+	~b2RopeCandidateBuffer()
+	{
+		b2Free(candidates);
+	}
+
+	void Push(b2Fixture* fixture, int32 childIndex, const b2AABB& aabb)
+	{
+		if (count == capacity)
+		{
+			b2RopeCandidate* old = candidates;
+			capacity = capacity > 0 ? 2 * capacity : 64;
+			candidates = (b2RopeCandidate*)b2Alloc(capacity * sizeof(b2RopeCandidate));
+			memcpy(candidates, old, count * sizeof(b2RopeCandidate));
+			b2Free(old);
+		}
+
+		b2RopeCandidate* candidate = candidates + count;
+		candidate->fixture = fixture;
+		candidate->childIndex = childIndex;
+		candidate->aabb = aabb;
+		candidate->begin = begin;
+		candidate->end = end;
+		++count;
+	}
+
+	b2RopeCandidate* candidates;
+	int32 count;
+	int32 capacity;
+
+	// The run of vertices being queried.
+	int32 begin, end;
+};
+
+// Gathers the mesh segments near a run of rope vertices.
+struct b2WorldRopeMeshCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		b2AABB aabb;
+		mesh->ComputeSegmentAABB(&aabb, fixture->GetBody()->GetTransform(), index);
+		buffer->Push(fixture, index, aabb);
+		return true;
+	}
+
+	const b2MeshShape* mesh;
+	b2Fixture* fixture;
+	b2RopeCandidateBuffer* buffer;
+};
+
+// Gathers the fixtures near a run of rope vertices.
+struct b2WorldRopeQueryCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		b2Body* body = fixture->GetBody();
+
+		if (fixture->IsSensor() || body == bodyA || body == bodyB)
+		{
+			return true;
+		}
+
+		if (fixture->GetType() == b2Shape::e_mesh)
+		{
+			b2WorldRopeMeshCallback meshCallback;
+			meshCallback.mesh = (b2MeshShape*)fixture->GetShape();
+			meshCallback.fixture = fixture;
+			meshCallback.buffer = buffer;
+			meshCallback.mesh->Query(&meshCallback, b2ComputeLocalAABB(body->GetTransform(), aabb));
+			return true;
+		}
+
+		buffer->Push(fixture, proxy->childIndex, fixture->GetAABB(proxy->childIndex));
+		return true;
+	}
+
+	b2BroadPhase* broadPhase;
+	b2Body* bodyA;
+	b2Body* bodyB;
+	b2AABB aabb;
+	b2RopeCandidateBuffer* buffer;
+};
+
+// Solves a range of ropes. Each thread gathers fixtures into its own buffer.
+class b2RopeSolveTask : public b2ThreadTask
+{
+public:
+	void Run(int32 begin, int32 end, int32 threadIndex)
+	{
+		for (int32 i = begin; i < end; ++i)
+		{
+			world->SolveRope(ropes[i], *step, buffers + threadIndex);
+		}
+	}
+
+	b2World* world;
+	const b2TimeStep* step;
+	b2Rope** ropes;
+	b2RopeCandidateBuffer* buffers;
+};
+
+// Gathers the bodies of a force field from the broad-phase. A body with several
+// fixtures in the region is taken once.
+struct b2ForceFieldQuery
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		b2Body* b = fixture->GetBody();
+		if (fixture->IsSensor() || b->m_type != b2_dynamicBody || (b->m_flags & b2Body::e_fieldFlag))
+		{
+			return true;
+		}
+
+		if (wake == false && (b->m_flags & b2Body::e_awakeFlag) == 0)
+		{
+			return true;
+		}
+
+		b2Assert(count < capacity);
+		b->m_flags |= b2Body::e_fieldFlag;
+		bodies[count] = b;
+		centers[count] = b->m_sweep.c;
+		++count;
+		return true;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2Body** bodies;
+	b2Vec2* centers;
+	int32 count;
+	int32 capacity;
+	bool wake;
+};
+
+// Force fields act as accelerations on the body velocities rather than through
+// the force accumulator, so they work the same with automatic clearing of forces
+// turned off. The bodies of a field are gathered first so the accelerations
+// are computed in one tight loop.
+void b2World::ApplyForceFields(const b2TimeStep& step)
+{
+	if (m_bodyCount == 0)
+	{
+		return;
+	}
+
+	// A body can only be found once per field.
+	int32 capacity = m_bodyCount;
+	b2ForceFieldQuery query;
+	query.broadPhase = &m_contactManager.m_broadPhase;
+	query.bodies = (b2Body**)m_stack->Allocate(capacity * sizeof(b2Body*));
+	query.centers = (b2Vec2*)m_stack->Allocate(capacity * sizeof(b2Vec2));
+	query.capacity = capacity;
+	b2Vec2* accelerations = (b2Vec2*)m_stack->Allocate(capacity * sizeof(b2Vec2));
+
+	for (b2ForceField* f = m_forceFieldList; f; f = f->m_next)
+	{
+		if (f->m_enabled == false)
+		{
+			continue;
+		}
+
+		// Static bodies are never moved by a field, so the static tree is skipped.
+		query.count = 0;
+		query.wake = f->m_impulse;
+		m_contactManager.m_broadPhase.QueryMovable(&query, f->GetAABB(), f->m_filter);
+
+		int32 count = query.count;
+		f->ComputeAccelerations(accelerations, query.centers, count);
+
+		// Impulse fields change the velocity once, continuous fields every step.
+		float32 h = f->m_impulse ? 1.0f : step.dt;
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2Body* b = query.bodies[i];
+			b->m_flags &= ~b2Body::e_fieldFlag;
+
+			b2Vec2 a = accelerations[i];
+			if (a.x == 0.0f && a.y == 0.0f)
+			{
+				continue;
+			}
+
+			if (f->m_impulse)
+			{
+				b->SetAwake(true);
+			}
+
+			b->m_linearVelocity += h * a;
+		}
+
+		if (f->m_impulse)
+		{
+			f->m_enabled = false;
+		}
+	}
+
+	m_stack->Free(accelerations);
+	m_stack->Free(query.centers);
+	m_stack->Free(query.bodies);
+}
+
+// All ropes are solved together after the bodies have moved. Ropes only
+// respond to the world, they don't apply impulses to bodies, so each rope
+// can be solved on its own thread.
+void b2World::SolveRopes(const b2TimeStep& step)
+{
+	if (m_ropeCount == 0)
+	{
+		return;
+	}
+
+	b2Rope** ropes = (b2Rope**)m_stack->Allocate(m_ropeCount * sizeof(b2Rope*));
+	int32 ropeCount = 0;
+	for (b2Rope* r = m_ropeList; r; r = r->m_next)
+	{
+		ropes[ropeCount++] = r;
+	}
+
+	int32 bufferCount = m_threadPool.GetThreadCount() + 1;
+	b2RopeCandidateBuffer* buffers = (b2RopeCandidateBuffer*)m_stack->Allocate(bufferCount * sizeof(b2RopeCandidateBuffer));
+	for (int32 i = 0; i < bufferCount; ++i)
+	{
+		new (buffers + i) b2RopeCandidateBuffer;
+	}
+
+	b2RopeSolveTask task;
+	task.world = this;
+	task.step = &step;
+	task.ropes = ropes;
+	task.buffers = buffers;
+	m_threadPool.Run(&task, ropeCount, 1);
+
+	for (int32 i = 0; i < bufferCount; ++i)
+	{
+		buffers[i].~b2RopeCandidateBuffer();
+	}
+
+	m_stack->Free(buffers);
+	m_stack->Free(ropes);
+}
 
-					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+// Collision is resolved inside the constraint iterations against fixtures
+// gathered once per step.
+void b2World::SolveRope(b2Rope* r, const b2TimeStep& step, b2RopeCandidateBuffer* buffer)
+{
+	// Query the broad-phase for short runs of vertices so that long ropes
+	// don't gather every fixture under their bounding box.
+	const int32 runLength = 8;
 
-					// Was the contact disabled by the user?
-					if (contact->IsEnabled() == false)
-					{
-						other->m_sweep = backup;
-						other->SynchronizeTransform();
-						continue;
-					}
+	r->Integrate(step.dt, m_gravity);
 
-					// Are there contact points?
-					if (contact->IsTouching() == false)
-					{
-						other->m_sweep = backup;
-						other->SynchronizeTransform();
-						continue;
-					}
+	if (r->m_bodyA)
+	{
+		r->m_ps[0] = b2Mul(r->m_bodyA->GetTransform(), r->m_localAnchorA);
+	}
 
-					// Add the contact to the island
-					contact->m_flags |= b2Contact::e_islandFlag;
-					island.Add(contact);
+	if (r->m_bodyB)
+	{
+		r->m_ps[r->m_count - 1] = b2Mul(r->m_bodyB->GetTransform(), r->m_localAnchorB);
+	}
 
-					// Has the other body already been added to the island?
-					if (other->m_flags & b2Body::e_islandFlag)
-					{
-						continue;
-					}
-					
-					// Add the other body to the island.
-					other->m_flags |= b2Body::e_islandFlag;
+	buffer->count = 0;
+	if (r->m_radius > 0.0f)
+	{
+		b2WorldRopeQueryCallback callback;
+		callback.broadPhase = &m_contactManager.m_broadPhase;
+		callback.buffer = buffer;
+		callback.bodyA = r->m_bodyA;
+		callback.bodyB = r->m_bodyB;
 
-					if (other->m_type != b2_staticBody)
-					{
-						other->SetAwake(true);
-					}
+		// Cover the motion over the step and some slack for the solver.
+		float32 margin = r->m_radius + b2_aabbExtension;
+		b2Vec2 extent(margin, margin);
 
-					island.Add(other);
-				}
+		for (int32 begin = 0; begin < r->m_count; begin += runLength)
+		{
+			int32 end = b2Min(begin + runLength, r->m_count);
+
+			b2AABB& aabb = callback.aabb;
+			aabb.lowerBound = b2Min(r->m_ps[begin], r->m_p0s[begin]);
+			aabb.upperBound = b2Max(r->m_ps[begin], r->m_p0s[begin]);
+			for (int32 i = begin + 1; i < end; ++i)
+			{
+				aabb.lowerBound = b2Min(aabb.lowerBound, b2Min(r->m_ps[i], r->m_p0s[i]));
+				aabb.upperBound = b2Max(aabb.upperBound, b2Max(r->m_ps[i], r->m_p0s[i]));
 			}
+			aabb.lowerBound -= extent;
+			aabb.upperBound += extent;
+
+			// The filtered query applies the default contact filter rules.
+			buffer->begin = begin;
+			buffer->end = end;
+			m_contactManager.m_broadPhase.Query(&callback, aabb, r->m_filter);
 		}
+	}
 
-		b2TimeStep subStep;
-		subStep.dt = (1.0f - minAlpha) * step.dt;
-		subStep.inv_dt = 1.0f / subStep.dt;
-		subStep.dtRatio = 1.0f;
-		subStep.positionIterations = 20;
-		subStep.velocityIterations = step.velocityIterations;
-		subStep.warmStarting = false;
-		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
+	for (int32 i = 0; i < step.positionIterations; ++i)
+	{
+		r->SolveConstraints(1);
 
-		// Reset island flags and synchronize broad-phase proxies.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		for (int32 j = 0; j < buffer->count; ++j)
 		{
-			b2Body* body = island.m_bodies[i];
-			body->m_flags &= ~b2Body::e_islandFlag;
+			CollideRope(r, buffer->candidates + j);
+		}
+	}
 
-			if (body->m_type != b2_dynamicBody)
-			{
-				continue;
-			}
+	r->UpdateVelocities(step.dt);
+}
 
-			body->SynchronizeFixtures();
+// Push a run of rope vertices out of a fixture child.
+void b2World::CollideRope(b2Rope* rope, const b2RopeCandidate* candidate)
+{
+	b2Fixture* fixture = candidate->fixture;
+	const b2AABB& childAABB = candidate->aabb;
 
-			// Invalidate all contact TOIs on this displaced body.
-			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+	b2DistanceInput input;
+	input.proxyA.Set(fixture->GetShape(), candidate->childIndex);
+	input.transformA = fixture->GetBody()->GetTransform();
+	input.transformB.SetIdentity();
+	input.useRadii = false;
+
+	float32 target = input.proxyA.m_radius + rope->m_radius;
+	b2Vec2 extent(rope->m_radius, rope->m_radius);
+
+	for (int32 i = candidate->begin; i < candidate->end; ++i)
+	{
+		if (rope->m_ims[i] == 0.0f)
+		{
+			continue;
+		}
+
+		b2Vec2 p = rope->m_ps[i];
+		b2AABB pointAABB;
+		pointAABB.lowerBound = p - extent;
+		pointAABB.upperBound = p + extent;
+		if (b2TestOverlap(pointAABB, childAABB) == false)
+		{
+			continue;
+		}
+
+		b2DistanceOutput output;
+		b2SimplexCache cache;
+		cache.count = 0;
+		input.proxyB.m_vertices = &p;
+		input.proxyB.m_count = 1;
+		input.proxyB.m_radius = 0.0f;
+		b2Distance(&output, &cache, &input);
+
+		if (output.distance > target)
+		{
+			continue;
+		}
+
+		// If the vertex reached the core of the shape, use the position at
+		// the start of the step to find the side it came from.
+		b2Vec2 p0 = rope->m_p0s[i];
+		if (output.distance < b2_epsilon)
+		{
+			cache.count = 0;
+			input.proxyB.m_vertices = &p0;
+			b2Distance(&output, &cache, &input);
+			if (output.distance < b2_epsilon)
 			{
-				ce->contact->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+				continue;
 			}
 		}
 
-		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
-		// Also, some contacts can be destroyed.
-		m_contactManager.FindNewContacts();
+		b2Vec2 normal = output.pointB - output.pointA;
+		normal.Normalize();
 
-		if (m_subStepping)
+		float32 separation = b2Dot(normal, p - output.pointA) - target;
+		if (separation >= 0.0f)
 		{
-			m_stepComplete = false;
-			break;
+			continue;
 		}
+
+		p -= separation * normal;
+
+		// Remove part of the sliding motion over the step.
+		b2Vec2 dp = p - p0;
+		p -= rope->m_friction * (dp - b2Dot(dp, normal) * normal);
+
+		rope->m_ps[i] = p;
 	}
 }
 
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
 {
-	b2Timer stepTimer;
+	StepWithPolicy<b2DefaultStepPolicy>(dt, velocityIterations, positionIterations);
+}
+
+void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations, b2StepPolicy policy)
+{
+	// The circle policy would ignore joints.
+	if (policy == b2_circleStepPolicy && m_jointCount == 0)
+	{
+		StepWithPolicy<b2CircleStepPolicy>(dt, velocityIterations, positionIterations);
+	}
+	else
+	{
+		StepWithPolicy<b2DefaultStepPolicy>(dt, velocityIterations, positionIterations);
+	}
+}
+
+template <typename Policy>
+void b2World::StepWithPolicy(float32 dt, int32 velocityIterations, int32 positionIterations)
+{
+	b2Assert(Policy::joints || m_jointCount == 0);
+
+	b2OptionalTimer<Policy::profile != 0> stepTimer;
+
+	// Let concurrent readers see that the world is changing. The barrier keeps
+	// the writes of the step after the odd epoch.
+	b2AtomicStore(&m_stepEpoch, m_stepEpoch + 1);
+	b2MemoryBarrier();
+
+	// Apply the commands recorded since the last step.
+	m_commandBuffer.Apply(this);
 
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
@@ -907,6 +2431,13 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	m_flags |= e_locked;
 
+	// Record the events of this step in contiguous arrays.
+	if (m_contactEventsEnabled)
+	{
+		m_contactEvents.Clear();
+		m_contactManager.m_contactEvents = &m_contactEvents;
+	}
+
 	b2TimeStep step;
 	step.dt = dt;
 	step.velocityIterations	= velocityIterations;
@@ -923,30 +2454,61 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+
+	step.adaptiveIterations = m_adaptiveIterations;
+	step.maxVelocityIterations = b2Max(velocityIterations, m_maxVelocityIterations);
+	step.maxPositionIterations = b2Max(positionIterations, m_maxPositionIterations);
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
-		b2Timer timer;
+		b2OptionalTimer<Policy::profile != 0> timer;
 		m_contactManager.Collide();
 		m_profile.collide = timer.GetMilliseconds();
 	}
 
+	// Force fields change the velocities before they are integrated.
+	if (m_forceFieldList && m_stepComplete && step.dt > 0.0f)
+	{
+		b2OptionalTimer<Policy::profile != 0> timer;
+		ApplyForceFields(step);
+		m_profile.forceFields = timer.GetMilliseconds();
+	}
+
 	// Integrate velocities, solve velocity constraints, and integrate positions.
 	if (m_stepComplete && step.dt > 0.0f)
 	{
-		b2Timer timer;
-		Solve(step);
+		b2OptionalTimer<Policy::profile != 0> timer;
+		Solve<Policy>(step);
 		m_profile.solve = timer.GetMilliseconds();
 	}
 
 	// Handle TOI events.
-	if (m_continuousPhysics && step.dt > 0.0f)
+	if (Policy::continuous && m_continuousPhysics && step.dt > 0.0f)
 	{
-		b2Timer timer;
+		b2OptionalTimer<Policy::profile != 0> timer;
 		SolveTOI(step);
 		m_profile.solveTOI = timer.GetMilliseconds();
 	}
 
+	// Ropes follow the bodies they are pinned to.
+	if (m_ropeList && step.dt > 0.0f)
+	{
+		b2OptionalTimer<Policy::profile != 0> timer;
+		SolveRopes(step);
+		m_profile.solveRopes = timer.GetMilliseconds();
+	}
+
+	// Particles see the bodies at the end of the step.
+	if (m_particleSystemList && step.dt > 0.0f)
+	{
+		b2OptionalTimer<Policy::profile != 0> timer;
+		for (b2ParticleSystem* ps = m_particleSystemList; ps; ps = ps->m_next)
+		{
+			ps->Solve(step, m_gravity, &m_contactManager.m_broadPhase, &m_threadPool);
+		}
+		m_profile.solveParticles = timer.GetMilliseconds();
+	}
+
 	if (step.dt > 0.0f)
 	{
 		m_inv_dt0 = step.inv_dt;
@@ -957,8 +2519,12 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 		ClearForces();
 	}
 
+	m_contactManager.m_contactEvents = NULL;
+
 	m_flags &= ~e_locked;
 
+	b2AtomicStore(&m_stepEpoch, m_stepEpoch + 1);
+
 	m_profile.step = stepTimer.GetMilliseconds();
 }
 
@@ -985,10 +2551,51 @@ struct b2WorldQueryWrapper
 
 void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
 {
+	uint32 epoch = m_queryGuardEnabled ? GetStepEpoch() : 0;
+	b2Assert((epoch & 1) == 0);
+
 	b2WorldQueryWrapper wrapper;
 	wrapper.broadPhase = &m_contactManager.m_broadPhase;
 	wrapper.callback = callback;
 	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+
+	b2Assert(m_queryGuardEnabled == false || CheckStepEpoch(epoch));
+}
+
+struct b2WorldPointQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		if (fixture->TestPoint(point) == false)
+		{
+			return true;
+		}
+
+		return callback->ReportFixture(fixture);
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2QueryCallback* callback;
+	b2Vec2 point;
+};
+
+void b2World::QueryPoint(b2QueryCallback* callback, const b2Vec2& point) const
+{
+	uint32 epoch = m_queryGuardEnabled ? GetStepEpoch() : 0;
+	b2Assert((epoch & 1) == 0);
+
+	b2WorldPointQueryWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	wrapper.point = point;
+	b2AABB aabb;
+	aabb.lowerBound = point;
+	aabb.upperBound = point;
+	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+
+	b2Assert(m_queryGuardEnabled == false || CheckStepEpoch(epoch));
 }
 
 struct b2WorldRayCastWrapper
@@ -1018,6 +2625,9 @@ struct b2WorldRayCastWrapper
 
 void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
 {
+	uint32 epoch = m_queryGuardEnabled ? GetStepEpoch() : 0;
+	b2Assert((epoch & 1) == 0);
+
 	b2WorldRayCastWrapper wrapper;
 	wrapper.broadPhase = &m_contactManager.m_broadPhase;
 	wrapper.callback = callback;
@@ -1026,6 +2636,225 @@ void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b
 	input.p1 = point1;
 	input.p2 = point2;
 	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
+
+	b2Assert(m_queryGuardEnabled == false || CheckStepEpoch(epoch));
+}
+
+// Sweeps the predicted body against the fixtures found over one sub-step and
+// keeps the earliest impact.
+struct b2WorldTrajectoryCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		if (fixture->IsSensor() || fixture->GetBody() == ignoreBody)
+		{
+			return true;
+		}
+
+		if (fixture->GetType() == b2Shape::e_mesh)
+		{
+			b2WorldTrajectoryMeshCallback meshCallback;
+			meshCallback.callback = this;
+			meshCallback.fixture = fixture;
+			const b2MeshShape* mesh = (b2MeshShape*)fixture->GetShape();
+			mesh->Query(&meshCallback, b2ComputeLocalAABB(fixture->GetBody()->GetTransform(), aabb));
+			return true;
+		}
+
+		Sweep(fixture, proxy->childIndex);
+		return true;
+	}
+
+	void Sweep(b2Fixture* fixture, int32 childIndex)
+	{
+		// The fixture holds still over the sub-step.
+		const b2Body* body = fixture->GetBody();
+		b2TOIInput input;
+		input.proxyA.Set(fixture->GetShape(), childIndex);
+		input.sweepA.localCenter = body->GetLocalCenter();
+		input.sweepA.c0 = body->GetWorldCenter();
+		input.sweepA.c = input.sweepA.c0;
+		input.sweepA.a0 = body->GetAngle();
+		input.sweepA.a = input.sweepA.a0;
+		input.sweepA.alpha0 = 0.0f;
+		input.sweepB = sweep;
+
+		for (int32 i = 0; i < childCount; ++i)
+		{
+			input.proxyB.Set(shape, i);
+			input.tMax = t;
+
+			b2TOIOutput output;
+			b2TimeOfImpact(&output, &input);
+
+			bool hit = output.state == b2TOIOutput::e_touching || output.state == b2TOIOutput::e_overlapped;
+			if (hit && (this->fixture == NULL || output.t < t))
+			{
+				t = output.t;
+				this->fixture = fixture;
+				this->childIndexA = childIndex;
+				this->childIndexB = i;
+			}
+		}
+	}
+
+	// Forwards the segments of a mesh.
+	struct b2WorldTrajectoryMeshCallback
+	{
+		bool QueryCallback(int32 index)
+		{
+			callback->Sweep(fixture, index);
+			return true;
+		}
+
+		b2WorldTrajectoryCallback* callback;
+		b2Fixture* fixture;
+	};
+
+	const b2BroadPhase* broadPhase;
+	const b2Body* ignoreBody;
+	const b2Shape* shape;
+	int32 childCount;
+	b2Sweep sweep;
+	b2AABB aabb;
+
+	// The earliest impact so far.
+	float32 t;
+	b2Fixture* fixture;
+	int32 childIndexA;
+	int32 childIndexB;
+};
+
+void b2World::PredictTrajectory(const b2TrajectoryInput& input, b2TrajectoryOutput* output) const
+{
+	b2CircleShape point;
+	point.m_radius = 0.0f;
+	const b2Shape* shape = input.shape ? input.shape : &point;
+	int32 childCount = shape->GetChildCount();
+
+	// Integrate the center of mass, like the island solver.
+	b2MassData massData;
+	shape->ComputeMass(&massData, 1.0f);
+
+	b2Sweep sweep;
+	sweep.localCenter = massData.center;
+	sweep.a = input.angle;
+	sweep.c = b2Mul(b2Transform(input.position, b2Rot(input.angle)), sweep.localCenter);
+	sweep.alpha0 = 0.0f;
+
+	b2Vec2 v = input.linearVelocity;
+	float32 w = input.angularVelocity;
+	float32 h = input.timeStep;
+	b2Vec2 gravity = input.gravityScale * m_gravity;
+
+	output->points[0] = input.position;
+	output->pointCount = 1;
+	output->fixture = NULL;
+	output->point.SetZero();
+	output->normal.SetZero();
+	output->time = 0.0f;
+
+	b2WorldTrajectoryCallback callback;
+	callback.broadPhase = &m_contactManager.m_broadPhase;
+	callback.ignoreBody = input.ignoreBody;
+	callback.shape = shape;
+	callback.childCount = childCount;
+
+	for (int32 i = 0; i < input.stepCount; ++i)
+	{
+		v += h * gravity;
+		v *= 1.0f / (1.0f + h * input.linearDamping);
+		w *= 1.0f / (1.0f + h * input.angularDamping);
+
+		b2Vec2 translation = h * v;
+		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
+		{
+			float32 ratio = b2_maxTranslation / translation.Length();
+			v *= ratio;
+		}
+
+		float32 rotation = h * w;
+		if (rotation * rotation > b2_maxRotationSquared)
+		{
+			float32 ratio = b2_maxRotation / b2Abs(rotation);
+			w *= ratio;
+		}
+
+		sweep.c0 = sweep.c;
+		sweep.a0 = sweep.a;
+		sweep.c += h * v;
+		sweep.a += h * w;
+
+		// Bound the shape over the sub-step.
+		b2Transform xf0, xf1;
+		sweep.GetTransform(&xf0, 0.0f);
+		sweep.GetTransform(&xf1, 1.0f);
+
+		b2AABB& aabb = callback.aabb;
+		shape->ComputeAABB(&aabb, xf0, 0);
+		for (int32 j = 0; j < childCount; ++j)
+		{
+			b2AABB aabb0, aabb1;
+			shape->ComputeAABB(&aabb0, xf0, j);
+			shape->ComputeAABB(&aabb1, xf1, j);
+			aabb.Combine(aabb0);
+			aabb.Combine(aabb1);
+		}
+
+		callback.sweep = sweep;
+		callback.t = 1.0f;
+		callback.fixture = NULL;
+		m_contactManager.m_broadPhase.Query(&callback, aabb, input.filter);
+
+		if (callback.fixture == NULL)
+		{
+			output->points[output->pointCount++] = xf1.p;
+			continue;
+		}
+
+		// Find the point of impact between the shapes at the time of impact.
+		b2Fixture* fixture = callback.fixture;
+		b2DistanceInput distanceInput;
+		distanceInput.proxyA.Set(fixture->GetShape(), callback.childIndexA);
+		distanceInput.proxyB.Set(shape, callback.childIndexB);
+		distanceInput.transformA = fixture->GetBody()->GetTransform();
+		sweep.GetTransform(&distanceInput.transformB, callback.t);
+		distanceInput.useRadii = false;
+
+		b2SimplexCache cache;
+		cache.count = 0;
+		b2DistanceOutput distanceOutput;
+		b2Distance(&distanceOutput, &cache, &distanceInput);
+
+		b2Vec2 normal = distanceOutput.pointB - distanceOutput.pointA;
+		if (normal.Normalize() < b2_epsilon)
+		{
+			// The cores overlap, so oppose the motion instead.
+			normal = -v;
+			normal.Normalize();
+		}
+
+		output->points[output->pointCount++] = distanceInput.transformB.p;
+		output->fixture = fixture;
+		output->point = distanceOutput.pointA + distanceInput.proxyA.m_radius * normal;
+		output->normal = normal;
+		output->time = (i + callback.t) * h;
+		return;
+	}
+}
+
+uint32 b2World::GetStepEpoch() const
+{
+	return b2AtomicLoad(&m_stepEpoch);
+}
+
+bool b2World::CheckStepEpoch(uint32 epoch) const
+{
+	// Keep the reads of the caller before the second load of the epoch.
+	b2MemoryBarrier();
+	return (epoch & 1) == 0 && b2AtomicLoad(&m_stepEpoch) == epoch;
 }
 
 void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
@@ -1085,6 +2914,54 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
 		}
 		break;
+
+	case b2Shape::e_box:
+		{
+			b2BoxShape* box = (b2BoxShape*)fixture->GetShape();
+			b2Vec2 vertices[4];
+
+			for (int32 i = 0; i < 4; ++i)
+			{
+				vertices[i] = b2Mul(xf, box->GetVertex(i));
+			}
+
+			m_debugDraw->DrawSolidPolygon(vertices, 4, color);
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* capsule = (b2CapsuleShape*)fixture->GetShape();
+			b2Vec2 v1 = b2Mul(xf, capsule->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, capsule->m_vertex2);
+			float32 radius = capsule->m_radius;
+
+			b2Vec2 axis = v2 - v1;
+			axis.Normalize();
+			b2Vec2 offset = radius * b2Cross(axis, 1.0f);
+
+			m_debugDraw->DrawSolidCircle(v1, radius, axis, color);
+			m_debugDraw->DrawSolidCircle(v2, radius, axis, color);
+			m_debugDraw->DrawSegment(v1 + offset, v2 + offset, color);
+			m_debugDraw->DrawSegment(v1 - offset, v2 - offset, color);
+		}
+		break;
+
+	case b2Shape::e_mesh:
+		{
+			b2MeshShape* mesh = (b2MeshShape*)fixture->GetShape();
+			int32 count = mesh->m_segmentCount;
+			const int32* indices = mesh->m_indices;
+			const b2Vec2* vertices = mesh->m_vertices;
+
+			for (int32 i = 0; i < count; ++i)
+			{
+				b2Vec2 v1 = b2Mul(xf, vertices[indices[2 * i + 0]]);
+				b2Vec2 v2 = b2Mul(xf, vertices[indices[2 * i + 1]]);
+				m_debugDraw->DrawSegment(v1, v2, color);
+			}
+		}
+		break;
             
     default:
         break;
@@ -1172,6 +3049,19 @@ void b2World::DrawDebugData()
 		}
 	}
 
+	if (flags & b2Draw::e_shapeBit)
+	{
+		for (b2Rope* r = m_ropeList; r; r = r->GetNext())
+		{
+			r->Draw(m_debugDraw);
+		}
+
+		for (b2ParticleSystem* ps = m_particleSystemList; ps; ps = ps->GetNext())
+		{
+			ps->Draw(m_debugDraw);
+		}
+	}
+
 	if (flags & b2Draw::e_jointBit)
 	{
 		for (b2Joint* j = m_jointList; j; j = j->GetNext())
@@ -1276,6 +3166,15 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 		j->ShiftOrigin(newOrigin);
 	}
 
+	for (b2ParticleSystem* ps = m_particleSystemList; ps; ps = ps->m_next)
+	{
+		b2Vec2* positions = ps->m_positions;
+		for (int32 i = 0; i < ps->m_count; ++i)
+		{
+			positions[i] -= newOrigin;
+		}
+	}
+
 	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
 }
 
@@ -22,18 +22,103 @@
 #include <Box2D/Common/b2Math.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2ThreadPool.h>
 #include <Box2D/Dynamics/b2ContactManager.h>
+#include <Box2D/Dynamics/b2ContactEvents.h>
+#include <Box2D/Dynamics/b2CommandBuffer.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
+struct b2FixtureDef;
+struct b2ForceFieldDef;
 struct b2JointDef;
+struct b2ParticleSystemDef;
+struct b2RopeCandidate;
+struct b2RopeCandidateBuffer;
+struct b2RopeDef;
 class b2Body;
 class b2Draw;
 class b2Fixture;
+class b2ForceField;
+class b2Island;
 class b2Joint;
+class b2ParticleSystem;
+class b2Rope;
+class b2Shape;
+
+/// Input for b2World::PredictTrajectory. This describes a body that is not
+/// in the world, for example a projectile that is about to be launched.
+struct b2TrajectoryInput
+{
+	b2TrajectoryInput()
+	{
+		shape = NULL;
+		position.SetZero();
+		angle = 0.0f;
+		linearVelocity.SetZero();
+		angularVelocity = 0.0f;
+		linearDamping = 0.0f;
+		angularDamping = 0.0f;
+		gravityScale = 1.0f;
+		ignoreBody = NULL;
+		timeStep = 1.0f / 60.0f;
+		stepCount = 60;
+	}
+
+	/// The shape of the body, or NULL to trace the body origin as a point.
+	const b2Shape* shape;
+
+	/// The initial body origin and angle.
+	b2Vec2 position;
+	float32 angle;
+
+	/// The initial velocities, as in b2BodyDef.
+	b2Vec2 linearVelocity;
+	float32 angularVelocity;
+
+	/// Damping and gravity scale, as in b2BodyDef.
+	float32 linearDamping;
+	float32 angularDamping;
+	float32 gravityScale;
+
+	/// The collision filter of the body. Sensors are never hit.
+	b2Filter filter;
+
+	/// The fixtures of this body are ignored, for example the launcher. May be NULL.
+	const b2Body* ignoreBody;
+
+	/// The length of a sub-step, usually the time step of the world.
+	float32 timeStep;
+
+	/// The maximum number of sub-steps.
+	int32 stepCount;
+};
+
+/// Output of b2World::PredictTrajectory.
+struct b2TrajectoryOutput
+{
+	/// The body origins, starting with the initial position. Provided by the
+	/// caller with room for stepCount + 1 points.
+	b2Vec2* points;
+
+	/// The number of points written. If a fixture was hit, the last point is
+	/// the body origin at the time of impact.
+	int32 pointCount;
+
+	/// The first fixture hit, or NULL.
+	b2Fixture* fixture;
+
+	/// The point of impact on the fixture and the normal pointing from the
+	/// fixture towards the body, in world coordinates.
+	b2Vec2 point;
+	b2Vec2 normal;
+
+	/// The time of impact in seconds.
+	float32 time;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -54,13 +139,56 @@ public:
 
 	/// Register a contact filter to provide specific control over collision.
 	/// Otherwise the default filter is used (b2_defaultFilter). The listener is
-	/// owned by you and must remain in scope. 
+	/// owned by you and must remain in scope. The default filter is applied
+	/// inside the broad-phase so filtered pairs are never reported; a custom
+	/// filter disables this and is called for every new pair.
 	void SetContactFilter(b2ContactFilter* filter);
 
 	/// Register a contact event listener. The listener is owned by you and must
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Enable/disable contact event buffers. When enabled, each time step records
+	/// its begin touch, end touch and hit events in contiguous arrays that can be
+	/// read after Step returns. This works alongside the contact listener.
+	/// Contacts destroyed outside of Step, for example by DestroyBody, are only
+	/// reported to the listener.
+	void SetContactEventsEnabled(bool flag);
+	bool GetContactEventsEnabled() const { return m_contactEventsEnabled; }
+
+	/// Set the normal impulse a contact must exceed to report a hit event.
+	/// The default is 1 kg*m/s.
+	void SetHitEventThreshold(float32 impulse) { m_hitEventThreshold = impulse; }
+	float32 GetHitEventThreshold() const { return m_hitEventThreshold; }
+
+	/// Get the contact events of the last time step.
+	const b2ContactEvents& GetContactEvents() const { return m_contactEvents; }
+
+	/// Exchange the contact events of the last time step with the supplied buffer.
+	/// The world keeps recording into the memory of the supplied buffer, so the
+	/// events can be handed to another thread without copying.
+	/// @warning This function is locked during callbacks.
+	void SwapContactEvents(b2ContactEvents* events);
+
+	/// Get the command buffer. Commands can be recorded from any thread and
+	/// from callbacks; they are applied at the start of the next time step.
+	b2CommandBuffer* GetCommandBuffer() { return &m_commandBuffer; }
+
+	/// Enable/disable the query guard. When enabled, the query functions assert
+	/// if a time step starts or runs while they execute on another thread.
+	void SetQueryGuardEnabled(bool flag) { m_queryGuardEnabled = flag; }
+	bool GetQueryGuardEnabled() const { return m_queryGuardEnabled; }
+
+	/// Get the step epoch. It is advanced when a time step starts and when it
+	/// ends, so it is odd while Step runs. To read the world on another thread,
+	/// get the epoch, run the queries or copy the body data, then pass the
+	/// epoch to CheckStepEpoch. The results are only valid if it returns true.
+	uint32 GetStepEpoch() const;
+
+	/// Check that no time step started or ran since GetStepEpoch returned the
+	/// supplied epoch. Reads made before this call are ordered before the check.
+	bool CheckStepEpoch(uint32 epoch) const;
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DrawDebugData method. The debug draw object is owned
 	/// by you and must remain in scope.
@@ -77,6 +205,59 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyBody(b2Body* body);
 
+	/// Create bodies in bulk. This is faster than calling CreateBody and
+	/// CreateFixture in a loop because the broad-phase proxies are inserted
+	/// as one batch. No reference to the definitions is retained.
+	/// @param defs the body definitions.
+	/// @param count the number of bodies.
+	/// @param bodies receives the new bodies, may be NULL.
+	/// @param fixtureDefs one fixture definition per body, or NULL to create bodies without fixtures.
+	/// A definition without a shape also creates a body without a fixture.
+	/// @warning This function is locked during callbacks.
+	void CreateBodies(const b2BodyDef* defs, int32 count, b2Body** bodies = NULL,
+					  const b2FixtureDef* fixtureDefs = NULL);
+
+	/// Destroy bodies in bulk. This behaves like calling DestroyBody for each
+	/// body, but the broad-phase proxies are removed as one batch. Each body
+	/// must appear once.
+	/// @warning This automatically deletes all associated shapes and joints.
+	/// @warning This function is locked during callbacks.
+	void DestroyBodies(b2Body* const* bodies, int32 count);
+
+	/// Destroy all bodies, joints, ropes, particle systems and force fields.
+	/// The gravity, listeners and settings are kept. This is much faster than
+	/// destroying the bodies one at a time, but no destruction listener or end
+	/// contact callbacks are made.
+	/// @warning This function is locked during callbacks.
+	void Clear();
+
+	/// Make this world a copy of another world, for example to simulate ahead
+	/// without touching the original. The copy steps exactly like the original.
+	/// Bodies, fixtures, joints, contacts, ropes, particle systems and force
+	/// fields are copied with their solver state, and the broad-phase is copied
+	/// as whole arrays.
+	/// User data pointers are shared. The listeners, contact filter and debug
+	/// draw of this world are kept, and pending commands are not copied.
+	/// The memory of this world is reused, so copying into the same world
+	/// repeatedly is cheap. Several threads may copy the same world at once.
+	/// @warning This function is locked during callbacks.
+	void Copy(const b2World& world);
+
+	/// Export the transforms of all bodies in one pass, in body list order.
+	/// Each body writes three floats: the origin x and y and the angle in radians.
+	/// @param transforms receives 3 * GetBodyCount() floats.
+	void GetTransforms(float32* transforms) const;
+
+	/// Export the transforms of the given bodies in one pass. The layout is
+	/// the same as above.
+	void GetTransforms(const b2Body* const* bodies, int32 count, float32* transforms) const;
+
+	/// Teleport bodies in bulk. This behaves like calling SetTransform for each
+	/// body, but each fixture AABB is computed once and the broad-phase is
+	/// updated as one batch. The transforms use the layout of GetTransforms.
+	/// @warning This function is locked during callbacks.
+	void SetTransforms(b2Body* const* bodies, const float32* transforms, int32 count);
+
 	/// Create a joint to constrain bodies together. No reference to the definition
 	/// is retained. This may cause the connected bodies to cease colliding.
 	/// @warning This function is locked during callbacks.
@@ -86,6 +267,35 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Create a rope that is simulated with the world. The ends may be pinned to
+	/// bodies, and the rope collides with fixtures if it has a radius. The rope
+	/// does not push back on the bodies. No reference to the definition is retained.
+	/// @warning This function is locked during callbacks.
+	b2Rope* CreateRope(const b2RopeDef* def);
+
+	/// Destroy a rope.
+	/// @warning This function is locked during callbacks.
+	void DestroyRope(b2Rope* rope);
+
+	/// Create a particle system that is simulated with the world. Particles
+	/// collide with fixtures and push dynamic bodies. No reference to the
+	/// definition is retained.
+	/// @warning This function is locked during callbacks.
+	b2ParticleSystem* CreateParticleSystem(const b2ParticleSystemDef* def);
+
+	/// Destroy a particle system and all of its particles.
+	/// @warning This function is locked during callbacks.
+	void DestroyParticleSystem(b2ParticleSystem* system);
+
+	/// Create a force field that accelerates the dynamic bodies inside a region
+	/// during each step. No reference to the definition is retained.
+	/// @warning This function is locked during callbacks.
+	b2ForceField* CreateForceField(const b2ForceFieldDef* def);
+
+	/// Destroy a force field.
+	/// @warning This function is locked during callbacks.
+	void DestroyForceField(b2ForceField* field);
+
 	/// Take a time step. This performs collision detection, integration,
 	/// and constraint solution.
 	/// @param timeStep the amount of time to simulate, this should not vary.
@@ -95,6 +305,15 @@ public:
 				int32 velocityIterations,
 				int32 positionIterations);
 
+	/// Take a time step with only the features of a step policy compiled in,
+	/// for example Step(timeStep, 8, 3, b2_circleStepPolicy). See b2StepPolicy.
+	/// A world that uses features the policy leaves out is stepped with the
+	/// default policy instead, so the result is always correct.
+	void Step(	float32 timeStep,
+				int32 velocityIterations,
+				int32 positionIterations,
+				b2StepPolicy policy);
+
 	/// Manually clear the force buffer on all bodies. By default, forces are cleared automatically
 	/// after each call to Step. The default behavior is modified by calling SetAutoClearForces.
 	/// The purpose of this function is to support sub-stepping. Sub-stepping is often used to maintain
@@ -111,8 +330,15 @@ public:
 	/// provided AABB.
 	/// @param callback a user implemented callback class.
 	/// @param aabb the query box.
+	/// @note The query functions only read the world, so several threads may
+	/// call them at once while no thread modifies the world.
 	void QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const;
 
+	/// Query the world for all fixtures that contain the provided point.
+	/// @param callback a user implemented callback class.
+	/// @param point the query point in world coordinates.
+	void QueryPoint(b2QueryCallback* callback, const b2Vec2& point) const;
+
 	/// Ray-cast the world for all fixtures in the path of the ray. Your callback
 	/// controls whether you get the closest point, any point, or n-points.
 	/// The ray-cast ignores shapes that contain the starting point.
@@ -121,6 +347,15 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Predict the path of a body that is not in the world, for example to
+	/// preview a shot. The body is integrated like a free dynamic body under
+	/// the world gravity, and its shape is swept against the fixtures of the
+	/// world over each sub-step until it hits one. The other bodies are held
+	/// still. This is cheap enough to call every frame and doesn't modify the world.
+	/// @param input the body and the sub-steps.
+	/// @param output receives the path and the first hit.
+	void PredictTrajectory(const b2TrajectoryInput& input, b2TrajectoryOutput* output) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A NULL body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -133,6 +368,26 @@ public:
 	b2Joint* GetJointList();
 	const b2Joint* GetJointList() const;
 
+	/// Get the world rope list. With the returned rope, use b2Rope::GetNext to get
+	/// the next rope in the world list. A NULL rope indicates the end of the list.
+	/// @return the head of the world rope list.
+	b2Rope* GetRopeList();
+	const b2Rope* GetRopeList() const;
+
+	/// Get the world particle system list. With the returned system, use
+	/// b2ParticleSystem::GetNext to get the next system in the world list.
+	/// A NULL system indicates the end of the list.
+	/// @return the head of the world particle system list.
+	b2ParticleSystem* GetParticleSystemList();
+	const b2ParticleSystem* GetParticleSystemList() const;
+
+	/// Get the world force field list. With the returned field, use
+	/// b2ForceField::GetNext to get the next field in the world list. A NULL
+	/// field indicates the end of the list.
+	/// @return the head of the world force field list.
+	b2ForceField* GetForceFieldList();
+	const b2ForceField* GetForceFieldList() const;
+
 	/// Get the world contact list. With the returned contact, use b2Contact::GetNext to get
 	/// the next contact in the world list. A NULL contact indicates the end of the list.
 	/// @return the head of the world contact list.
@@ -157,6 +412,27 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Enable/disable adaptive iterations. Each island stops iterating once its
+	/// velocities converge and its position error is small, and islands that
+	/// have not converged keep iterating up to the maximum counts. Off by default.
+	/// The iterations used are reported in the profile.
+	void SetAdaptiveIterations(bool flag) { m_adaptiveIterations = flag; }
+	bool GetAdaptiveIterations() const { return m_adaptiveIterations; }
+
+	/// Set the most iterations an island may use with adaptive iterations. The
+	/// counts passed to Step are used instead if they are larger.
+	void SetMaxIterations(int32 velocityIterations, int32 positionIterations);
+	int32 GetMaxVelocityIterations() const { return m_maxVelocityIterations; }
+	int32 GetMaxPositionIterations() const { return m_maxPositionIterations; }
+
+	/// Set the number of worker threads that help the thread calling Step
+	/// solve ropes and particle systems. Zero by default. The results do not
+	/// depend on the number of threads. Each world has its own threads and
+	/// b2World::Copy keeps the threads of the destination world.
+	/// @warning This function is locked during callbacks.
+	void SetThreadCount(int32 threadCount);
+	int32 GetThreadCount() const { return m_threadPool.GetThreadCount(); }
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -166,13 +442,22 @@ public:
 	/// Get the number of joints.
 	int32 GetJointCount() const;
 
+	/// Get the number of ropes.
+	int32 GetRopeCount() const;
+
+	/// Get the number of particle systems.
+	int32 GetParticleSystemCount() const;
+
+	/// Get the number of force fields.
+	int32 GetForceFieldCount() const;
+
 	/// Get the number of contacts (each may have 0 or more contact points).
 	int32 GetContactCount() const;
 
-	/// Get the height of the dynamic tree.
+	/// Get the height of the broad-phase trees.
 	int32 GetTreeHeight() const;
 
-	/// Get the balance of the dynamic tree.
+	/// Get the balance of the broad-phase trees.
 	int32 GetTreeBalance() const;
 
 	/// Get the quality metric of the dynamic tree. The smaller the better.
@@ -223,9 +508,21 @@ private:
 	friend class b2Fixture;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2CommandBuffer;
+	friend class b2WorldPool;
+	friend class b2RopeSolveTask;
 
+	template <typename Policy>
+	void StepWithPolicy(float32 timeStep, int32 velocityIterations, int32 positionIterations);
+	template <typename Policy>
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
+	void BeginPending(b2Island& island, int32 divisor);
+	void AdvancePending(b2Island& island);
+	void ApplyForceFields(const b2TimeStep& step);
+	void SolveRopes(const b2TimeStep& step);
+	void SolveRope(b2Rope* rope, const b2TimeStep& step, b2RopeCandidateBuffer* buffer);
+	void CollideRope(b2Rope* rope, const b2RopeCandidate* candidate);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
@@ -233,15 +530,25 @@ private:
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
+	// The stack allocator used by the step. A world pool lends the world the
+	// allocator of the thread that steps it.
+	b2StackAllocator* m_stack;
+
 	int32 m_flags;
 
 	b2ContactManager m_contactManager;
 
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
+	b2Rope* m_ropeList;
+	b2ParticleSystem* m_particleSystemList;
+	b2ForceField* m_forceFieldList;
 
 	int32 m_bodyCount;
 	int32 m_jointCount;
+	int32 m_ropeCount;
+	int32 m_particleSystemCount;
+	int32 m_forceFieldCount;
 
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
@@ -249,6 +556,17 @@ private:
 	b2DestructionListener* m_destructionListener;
 	b2Draw* m_debugDraw;
 
+	b2ContactEvents m_contactEvents;
+	bool m_contactEventsEnabled;
+	float32 m_hitEventThreshold;
+
+	b2CommandBuffer m_commandBuffer;
+
+	b2ThreadPool m_threadPool;
+
+	uint32 m_stepEpoch;
+	bool m_queryGuardEnabled;
+
 	// This is used to compute the time step ratio to
 	// support a variable time step.
 	float32 m_inv_dt0;
@@ -258,6 +576,10 @@ private:
 	bool m_continuousPhysics;
 	bool m_subStepping;
 
+	bool m_adaptiveIterations;
+	int32 m_maxVelocityIterations;
+	int32 m_maxPositionIterations;
+
 	bool m_stepComplete;
 
 	b2Profile m_profile;
@@ -283,6 +605,36 @@ inline const b2Joint* b2World::GetJointList() const
 	return m_jointList;
 }
 
+inline b2Rope* b2World::GetRopeList()
+{
+	return m_ropeList;
+}
+
+inline const b2Rope* b2World::GetRopeList() const
+{
+	return m_ropeList;
+}
+
+inline b2ParticleSystem* b2World::GetParticleSystemList()
+{
+	return m_particleSystemList;
+}
+
+inline const b2ParticleSystem* b2World::GetParticleSystemList() const
+{
+	return m_particleSystemList;
+}
+
+inline b2ForceField* b2World::GetForceFieldList()
+{
+	return m_forceFieldList;
+}
+
+inline const b2ForceField* b2World::GetForceFieldList() const
+{
+	return m_forceFieldList;
+}
+
 inline b2Contact* b2World::GetContactList()
 {
 	return m_contactManager.m_contactList;
@@ -303,6 +655,21 @@ inline int32 b2World::GetJointCount() const
 	return m_jointCount;
 }
 
+inline int32 b2World::GetRopeCount() const
+{
+	return m_ropeCount;
+}
+
+inline int32 b2World::GetParticleSystemCount() const
+{
+	return m_particleSystemCount;
+}
+
+inline int32 b2World::GetForceFieldCount() const
+{
+	return m_forceFieldCount;
+}
+
 inline int32 b2World::GetContactCount() const
 {
 	return m_contactManager.m_contactCount;
@@ -0,0 +1,204 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2WorldPool.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Common/b2Timer.h>
+#include <memory.h>
+#include <new>
+#include <algorithm>
+
+// Orders worlds by the time of their last step, slowest first.
+struct b2WorldPoolOrder
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		return worlds[a]->GetProfile().step > worlds[b]->GetProfile().step;
+	}
+
+	b2World** worlds;
+};
+
+b2WorldPool::b2WorldPool(int32 threadCount)
+{
+	b2Assert(threadCount >= 0);
+
+	// Contact types are registered on first use, which must not happen on
+	// two threads at once.
+	if (b2Contact::s_initialized == false)
+	{
+		b2Contact::InitializeRegisters();
+		b2Contact::s_initialized = true;
+	}
+
+	m_worldCapacity = 16;
+	m_worldCount = 0;
+	m_worlds = (b2World**)b2Alloc(m_worldCapacity * sizeof(b2World*));
+	m_order = (int32*)b2Alloc(m_worldCapacity * sizeof(int32));
+
+	m_next = 0;
+	m_exit = false;
+	m_timeStep = 0.0f;
+	m_velocityIterations = 0;
+	m_positionIterations = 0;
+	m_stepTime = 0.0f;
+
+	// The first worker is the thread that calls Step.
+	m_workerCount = threadCount + 1;
+	m_workers = (Worker*)b2Alloc(m_workerCount * sizeof(Worker));
+	for (int32 i = 0; i < m_workerCount; ++i)
+	{
+		Worker* worker = new (m_workers + i) Worker;
+		worker->pool = this;
+	}
+
+	m_threadCount = 0;
+	for (int32 i = 1; i < m_workerCount; ++i)
+	{
+		if (m_workers[i].thread.Start(ThreadMain, m_workers + i) == false)
+		{
+			break;
+		}
+
+		++m_threadCount;
+	}
+}
+
+b2WorldPool::~b2WorldPool()
+{
+	m_exit = true;
+	m_start.Signal(m_threadCount);
+
+	for (int32 i = 0; i < m_workerCount; ++i)
+	{
+		m_workers[i].thread.Join();
+		m_workers[i].~Worker();
+	}
+	b2Free(m_workers);
+
+	for (int32 i = 0; i < m_worldCount; ++i)
+	{
+		m_worlds[i]->~b2World();
+		b2Free(m_worlds[i]);
+	}
+	b2Free(m_order);
+	b2Free(m_worlds);
+}
+
+b2World* b2WorldPool::CreateWorld(const b2Vec2& gravity)
+{
+	if (m_worldCount == m_worldCapacity)
+	{
+		b2World** oldWorlds = m_worlds;
+		int32* oldOrder = m_order;
+		m_worldCapacity *= 2;
+		m_worlds = (b2World**)b2Alloc(m_worldCapacity * sizeof(b2World*));
+		m_order = (int32*)b2Alloc(m_worldCapacity * sizeof(int32));
+		memcpy(m_worlds, oldWorlds, m_worldCount * sizeof(b2World*));
+		b2Free(oldWorlds);
+		b2Free(oldOrder);
+	}
+
+	void* mem = b2Alloc(sizeof(b2World));
+	b2World* world = new (mem) b2World(gravity);
+	m_worlds[m_worldCount++] = world;
+	return world;
+}
+
+void b2WorldPool::DestroyWorld(b2World* world)
+{
+	for (int32 i = 0; i < m_worldCount; ++i)
+	{
+		if (m_worlds[i] == world)
+		{
+			world->~b2World();
+			b2Free(world);
+			m_worlds[i] = m_worlds[--m_worldCount];
+			return;
+		}
+	}
+
+	b2Assert(false);
+}
+
+void b2WorldPool::Step(float32 timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	b2Timer timer;
+
+	m_timeStep = timeStep;
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+
+	// Start the slowest worlds first so that a slow world picked up last does
+	// not hold up the whole step.
+	for (int32 i = 0; i < m_worldCount; ++i)
+	{
+		m_order[i] = i;
+	}
+	b2WorldPoolOrder order;
+	order.worlds = m_worlds;
+	std::sort(m_order, m_order + m_worldCount, order);
+
+	m_next = 0;
+	m_start.Signal(m_threadCount);
+	Work(&m_workers[0].allocator);
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		m_done.Wait();
+	}
+
+	m_stepTime = timer.GetMilliseconds();
+}
+
+void b2WorldPool::ThreadMain(void* data)
+{
+	Worker* worker = (Worker*)data;
+	b2WorldPool* pool = worker->pool;
+	for (;;)
+	{
+		pool->m_start.Wait();
+		if (pool->m_exit)
+		{
+			break;
+		}
+
+		pool->Work(&worker->allocator);
+		pool->m_done.Signal();
+	}
+}
+
+// Step worlds until there are none left.
+void b2WorldPool::Work(b2StackAllocator* allocator)
+{
+	for (;;)
+	{
+		m_mutex.Lock();
+		int32 index = m_next++;
+		m_mutex.Unlock();
+
+		if (index >= m_worldCount)
+		{
+			break;
+		}
+
+		b2World* world = m_worlds[m_order[index]];
+		world->m_stack = allocator;
+		world->Step(m_timeStep, m_velocityIterations, m_positionIterations);
+		world->m_stack = &world->m_stackAllocator;
+	}
+}
@@ -0,0 +1,132 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_WORLD_POOL_H
+#define B2_WORLD_POOL_H
+
+#include <Box2D/Common/b2Mutex.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2Thread.h>
+#include <Box2D/Dynamics/b2World.h>
+
+/// Owns many independent worlds and steps all of them together on a shared
+/// set of worker threads. Use this for many small worlds that are each too
+/// small to be worth splitting across threads, such as one world per match
+/// on a server. Each thread steps whole worlds with its own stack allocator,
+/// so the allocators stay warm from world to world. The time each world took
+/// to step is in its b2Profile.
+class b2WorldPool
+{
+public:
+	/// Construct a pool with the given number of worker threads. The thread
+	/// that calls Step also steps worlds, so zero threads steps serially.
+	b2WorldPool(int32 threadCount);
+
+	/// Destroys all the worlds and stops the threads.
+	~b2WorldPool();
+
+	/// Create a world in the pool.
+	b2World* CreateWorld(const b2Vec2& gravity);
+
+	/// Destroy a world of the pool. The last world moves into its index.
+	void DestroyWorld(b2World* world);
+
+	/// Get the number of worlds.
+	int32 GetWorldCount() const;
+
+	/// Get a world by index.
+	b2World* GetWorld(int32 index);
+	const b2World* GetWorld(int32 index) const;
+
+	/// Get the number of worker threads that were started.
+	int32 GetThreadCount() const;
+
+	/// Step every world once, as b2World::Step does. This blocks until all
+	/// the worlds are stepped. The slowest worlds of the previous step are
+	/// started first. Worlds must not be used by other threads during the step.
+	void Step(	float32 timeStep,
+				int32 velocityIterations,
+				int32 positionIterations);
+
+	/// Get the wall clock time of the last step in milliseconds.
+	float32 GetStepTime() const;
+
+private:
+
+	struct Worker
+	{
+		b2WorldPool* pool;
+		b2StackAllocator allocator;
+		b2Thread thread;
+	};
+
+	b2WorldPool(const b2WorldPool&);
+	b2WorldPool& operator=(const b2WorldPool&);
+
+	static void ThreadMain(void* data);
+	void Work(b2StackAllocator* allocator);
+
+	b2World** m_worlds;
+	int32* m_order;
+	int32 m_worldCount;
+	int32 m_worldCapacity;
+
+	Worker* m_workers;
+	int32 m_workerCount;
+	int32 m_threadCount;
+
+	b2Semaphore m_start;
+	b2Semaphore m_done;
+	b2Mutex m_mutex;
+	int32 m_next;
+	bool m_exit;
+
+	float32 m_timeStep;
+	int32 m_velocityIterations;
+	int32 m_positionIterations;
+	float32 m_stepTime;
+};
+
+inline int32 b2WorldPool::GetWorldCount() const
+{
+	return m_worldCount;
+}
+
+inline b2World* b2WorldPool::GetWorld(int32 index)
+{
+	b2Assert(0 <= index && index < m_worldCount);
+	return m_worlds[index];
+}
+
+inline const b2World* b2WorldPool::GetWorld(int32 index) const
+{
+	b2Assert(0 <= index && index < m_worldCount);
+	return m_worlds[index];
+}
+
+inline int32 b2WorldPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+inline float32 b2WorldPool::GetStepTime() const
+{
+	return m_stepTime;
+}
+
+#endif
@@ -0,0 +1,788 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Particle/b2ParticleSystem.h>
+#include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2MeshShape.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <algorithm>
+#include <memory.h>
+
+// Particles stop pushing apart once they are this crowded. The weight of a
+// particle is the sum of 1 - distance / diameter over its neighbors.
+#define b2_maxParticleWeight	5.0f
+
+// The pressure is clamped to this fraction of the critical pressure.
+#define b2_maxParticlePressure	0.25f
+
+// The particles are solved in ranges of this many particles. The ranges
+// don't depend on the number of threads, so neither do the results.
+#define b2_particleRangeSize	4096
+
+b2ParticleSystem::b2ParticleSystem(const b2ParticleSystemDef* def, b2World* world)
+{
+	b2Assert(def->radius > 0.0f);
+	b2Assert(def->density > 0.0f);
+
+	m_count = 0;
+	m_capacity = 0;
+	m_positions = NULL;
+	m_velocities = NULL;
+	m_weights = NULL;
+	m_pressures = NULL;
+	m_proxies = NULL;
+	m_buffer = NULL;
+
+	m_ranges = NULL;
+	m_rangeCount = 0;
+	m_rangeCapacity = 0;
+	m_pairCount = 0;
+
+	m_radius = def->radius;
+	m_diameter = 2.0f * def->radius;
+	m_inverseDiameter = 1.0f / m_diameter;
+	m_density = def->density;
+	m_gravityScale = def->gravityScale;
+	m_pressureStrength = def->pressureStrength;
+	m_viscosityStrength = def->viscosityStrength;
+	m_dampingStrength = def->dampingStrength;
+	m_friction = def->friction;
+	m_filter = def->filter;
+
+	m_world = world;
+
+	m_prev = NULL;
+	m_next = NULL;
+}
+
+b2ParticleSystem::~b2ParticleSystem()
+{
+	b2Free(m_positions);
+	b2Free(m_velocities);
+	b2Free(m_weights);
+	b2Free(m_pressures);
+	b2Free(m_proxies);
+	b2Free(m_buffer);
+
+	for (int32 i = 0; i < m_rangeCapacity; ++i)
+	{
+		b2Free(m_ranges[i].pairs);
+		b2Free(m_ranges[i].spills);
+	}
+	b2Free(m_ranges);
+}
+
+// Grow an array, keeping the first count elements.
+template <typename T>
+static T* b2ReallocParticleArray(T* oldArray, int32 count, int32 capacity)
+{
+	T* newArray = (T*)b2Alloc(capacity * sizeof(T));
+	if (oldArray)
+	{
+		memcpy(newArray, oldArray, count * sizeof(T));
+		b2Free(oldArray);
+	}
+	return newArray;
+}
+
+void b2ParticleSystem::Reserve(int32 capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	m_positions = b2ReallocParticleArray(m_positions, m_count, capacity);
+	m_velocities = b2ReallocParticleArray(m_velocities, m_count, capacity);
+	m_weights = b2ReallocParticleArray(m_weights, m_count, capacity);
+	m_pressures = b2ReallocParticleArray(m_pressures, m_count, capacity);
+	m_proxies = b2ReallocParticleArray(m_proxies, m_count, capacity);
+	m_buffer = b2ReallocParticleArray(m_buffer, 0, capacity);
+	m_capacity = capacity;
+}
+
+void b2ParticleSystem::Copy(const b2ParticleSystem* system)
+{
+	Reserve(system->m_count);
+	m_count = system->m_count;
+	memcpy(m_positions, system->m_positions, m_count * sizeof(b2Vec2));
+	memcpy(m_velocities, system->m_velocities, m_count * sizeof(b2Vec2));
+	memcpy(m_weights, system->m_weights, m_count * sizeof(float32));
+	memcpy(m_pressures, system->m_pressures, m_count * sizeof(float32));
+	memcpy(m_proxies, system->m_proxies, m_count * sizeof(Proxy));
+
+	// The pairs are found again at the start of the next step.
+	m_pairCount = system->m_pairCount;
+
+	m_radius = system->m_radius;
+	m_diameter = system->m_diameter;
+	m_inverseDiameter = system->m_inverseDiameter;
+	m_density = system->m_density;
+	m_gravityScale = system->m_gravityScale;
+	m_pressureStrength = system->m_pressureStrength;
+	m_viscosityStrength = system->m_viscosityStrength;
+	m_dampingStrength = system->m_dampingStrength;
+	m_friction = system->m_friction;
+	m_filter = system->m_filter;
+}
+
+int32 b2ParticleSystem::CreateParticle(const b2ParticleDef& def)
+{
+	b2Assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked())
+	{
+		return b2_nullParticle;
+	}
+
+	if (m_count == m_capacity)
+	{
+		Reserve(m_capacity > 0 ? 2 * m_capacity : 256);
+	}
+
+	int32 index = m_count;
+	m_positions[index] = def.position;
+	m_velocities[index] = def.velocity;
+	m_weights[index] = 0.0f;
+	m_pressures[index] = 0.0f;
+	++m_count;
+
+	return index;
+}
+
+void b2ParticleSystem::DestroyParticle(int32 index)
+{
+	b2Assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked())
+	{
+		return;
+	}
+
+	b2Assert(0 <= index && index < m_count);
+	--m_count;
+	m_positions[index] = m_positions[m_count];
+	m_velocities[index] = m_velocities[m_count];
+	m_weights[index] = m_weights[m_count];
+	m_pressures[index] = m_pressures[m_count];
+
+	m_pairCount = 0;
+}
+
+// Cells are ordered by row, then by column. The sign bit is flipped so that
+// negative cells sort before positive ones.
+inline uint64 b2ParticleSystem::ComputeTag(int32 cellX, int32 cellY)
+{
+	uint32 x = (uint32)cellX ^ 0x80000000;
+	uint32 y = (uint32)cellY ^ 0x80000000;
+	return (uint64)y << 32 | (uint64)x;
+}
+
+inline uint64 b2ParticleSystem::ComputeTag(float32 x, float32 y) const
+{
+	int32 cellX = (int32)floorf(m_inverseDiameter * x);
+	int32 cellY = (int32)floorf(m_inverseDiameter * y);
+	return ComputeTag(cellX, cellY);
+}
+
+inline void b2ParticleSystem::AddPair(PairRange* range, int32 indexA, int32 indexB)
+{
+	b2Vec2 d = m_positions[indexB] - m_positions[indexA];
+	float32 distanceSquared = b2Dot(d, d);
+	if (distanceSquared >= m_diameter * m_diameter)
+	{
+		return;
+	}
+
+	if (range->pairCount == range->pairCapacity)
+	{
+		int32 capacity = range->pairCapacity > 0 ? 2 * range->pairCapacity : 1024;
+		range->pairs = b2ReallocParticleArray(range->pairs, range->pairCount, capacity);
+		range->pairCapacity = capacity;
+	}
+
+	float32 distance = b2Sqrt(distanceSquared);
+
+	Pair* pair = range->pairs + range->pairCount;
+	pair->indexA = indexA;
+	pair->indexB = indexB;
+	pair->weight = 1.0f - distance * m_inverseDiameter;
+	if (distance > b2_epsilon)
+	{
+		pair->normal = (1.0f / distance) * d;
+	}
+	else
+	{
+		pair->normal.Set(0.0f, 1.0f);
+	}
+	++range->pairCount;
+}
+
+// Runs a range function of a particle system on the thread pool.
+class b2ParticleSolveTask : public b2ThreadTask
+{
+public:
+	void Run(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+		(system->*function)(*step, begin, end);
+	}
+
+	b2ParticleSystem* system;
+	void (b2ParticleSystem::*function)(const b2TimeStep& step, int32 begin, int32 end);
+	const b2TimeStep* step;
+};
+
+void b2ParticleSystem::RunRanges(RangeFunction function, const b2TimeStep& step, b2ThreadPool* threadPool)
+{
+	b2ParticleSolveTask task;
+	task.system = this;
+	task.function = function;
+	task.step = &step;
+	threadPool->Run(&task, m_count, b2_particleRangeSize);
+}
+
+void b2ParticleSystem::TagRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	B2_NOT_USED(step);
+	for (int32 i = begin; i < end; ++i)
+	{
+		const b2Vec2& p = m_positions[i];
+		m_proxies[i].tag = ComputeTag(p.x, p.y);
+		m_proxies[i].index = i;
+	}
+}
+
+// Store the particles in cell order so that neighbors are close in memory.
+// The pair and collision loops are bound by these loads.
+void b2ParticleSystem::ReorderPositionsRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	B2_NOT_USED(step);
+	for (int32 i = begin; i < end; ++i)
+	{
+		m_buffer[i] = m_positions[m_proxies[i].index];
+	}
+}
+
+void b2ParticleSystem::ReorderVelocitiesRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	B2_NOT_USED(step);
+	for (int32 i = begin; i < end; ++i)
+	{
+		m_buffer[i] = m_velocities[m_proxies[i].index];
+		m_proxies[i].index = i;
+	}
+}
+
+// Pair each particle with the particles in the next cell of its row and the
+// three cells of the next row. Together this covers every neighbor exactly
+// once. The weights of the particles in the range are summed here. Weights
+// of particles in later ranges are left to UpdatePairs.
+void b2ParticleSystem::FindPairsRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	B2_NOT_USED(step);
+	PairRange* range = m_ranges + begin / b2_particleRangeSize;
+	range->pairCount = 0;
+	range->spillCount = 0;
+
+	// The next row is after the particle, so the search can start at the
+	// range. From there it only moves forward.
+	int32 nextRow = begin;
+	for (int32 a = begin; a < end; ++a)
+	{
+		uint64 tag = m_proxies[a].tag;
+		int32 cellX = (int32)((uint32)tag ^ 0x80000000);
+		int32 cellY = (int32)((uint32)(tag >> 32) ^ 0x80000000);
+
+		uint64 rightTag = ComputeTag(cellX + 1, cellY);
+		for (int32 b = a + 1; b < m_count && m_proxies[b].tag <= rightTag; ++b)
+		{
+			AddPair(range, a, b);
+		}
+
+		uint64 bottomLeftTag = ComputeTag(cellX - 1, cellY + 1);
+		while (nextRow < m_count && m_proxies[nextRow].tag < bottomLeftTag)
+		{
+			++nextRow;
+		}
+
+		uint64 bottomRightTag = ComputeTag(cellX + 1, cellY + 1);
+		for (int32 b = nextRow; b < m_count && m_proxies[b].tag <= bottomRightTag; ++b)
+		{
+			AddPair(range, a, b);
+		}
+	}
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		m_weights[i] = 0.0f;
+	}
+
+	for (int32 i = 0; i < range->pairCount; ++i)
+	{
+		const Pair& pair = range->pairs[i];
+		m_weights[pair.indexA] += pair.weight;
+		if (pair.indexB < end)
+		{
+			m_weights[pair.indexB] += pair.weight;
+			continue;
+		}
+
+		if (range->spillCount == range->spillCapacity)
+		{
+			int32 capacity = range->spillCapacity > 0 ? 2 * range->spillCapacity : 256;
+			range->spills = b2ReallocParticleArray(range->spills, range->spillCount, capacity);
+			range->spillCapacity = capacity;
+		}
+
+		Spill* spill = range->spills + range->spillCount;
+		spill->index = pair.indexB;
+		spill->weight = pair.weight;
+		++range->spillCount;
+	}
+}
+
+// Sort the particles into cells one diameter wide and find the pairs closer
+// than one diameter. The ranges are searched in parallel. Read in range order,
+// their pairs are in the order of a serial search.
+void b2ParticleSystem::UpdatePairs(const b2TimeStep& step, b2ThreadPool* threadPool)
+{
+	RunRanges(&b2ParticleSystem::TagRange, step, threadPool);
+
+	// The order barely changes between steps.
+	std::sort(m_proxies, m_proxies + m_count);
+
+	RunRanges(&b2ParticleSystem::ReorderPositionsRange, step, threadPool);
+	b2Swap(m_positions, m_buffer);
+	RunRanges(&b2ParticleSystem::ReorderVelocitiesRange, step, threadPool);
+	b2Swap(m_velocities, m_buffer);
+
+	m_rangeCount = (m_count + b2_particleRangeSize - 1) / b2_particleRangeSize;
+	if (m_rangeCount > m_rangeCapacity)
+	{
+		m_ranges = b2ReallocParticleArray(m_ranges, m_rangeCapacity, m_rangeCount);
+		memset(m_ranges + m_rangeCapacity, 0, (m_rangeCount - m_rangeCapacity) * sizeof(PairRange));
+		m_rangeCapacity = m_rangeCount;
+	}
+
+	RunRanges(&b2ParticleSystem::FindPairsRange, step, threadPool);
+
+	// Add the weights that were left out, in range order.
+	m_pairCount = 0;
+	for (int32 r = 0; r < m_rangeCount; ++r)
+	{
+		const PairRange* range = m_ranges + r;
+		m_pairCount += range->pairCount;
+
+		for (int32 i = 0; i < range->spillCount; ++i)
+		{
+			const Spill& spill = range->spills[i];
+			m_weights[spill.index] += spill.weight;
+		}
+	}
+}
+
+// Crowded particles push each other apart. The pressure is scaled by the
+// critical velocity, the speed that crosses one diameter per step.
+void b2ParticleSystem::ComputePressuresRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	float32 criticalVelocity = m_diameter * step.inv_dt;
+	float32 criticalPressure = m_density * criticalVelocity * criticalVelocity;
+	float32 pressurePerWeight = m_pressureStrength * criticalPressure;
+	float32 maxPressure = b2_maxParticlePressure * criticalPressure;
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		float32 w = m_weights[i];
+		float32 h = pressurePerWeight * b2Max(0.0f, b2Min(w, b2_maxParticleWeight) - 1.0f);
+		m_pressures[i] = b2Min(h, maxPressure);
+	}
+}
+
+void b2ParticleSystem::ApplyPressuresRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	PairRange* range = m_ranges + begin / b2_particleRangeSize;
+	Spill* spill = range->spills;
+
+	float32 velocityPerPressure = step.dt / (m_density * m_diameter);
+	for (int32 i = 0; i < range->pairCount; ++i)
+	{
+		const Pair& pair = range->pairs[i];
+		float32 h = m_pressures[pair.indexA] + m_pressures[pair.indexB];
+		b2Vec2 f = (velocityPerPressure * pair.weight * h) * pair.normal;
+		m_velocities[pair.indexA] -= f;
+		if (pair.indexB < end)
+		{
+			m_velocities[pair.indexB] += f;
+		}
+		else
+		{
+			spill->force = f;
+			++spill;
+		}
+	}
+}
+
+void b2ParticleSystem::SolvePressure(const b2TimeStep& step, b2ThreadPool* threadPool)
+{
+	RunRanges(&b2ParticleSystem::ComputePressuresRange, step, threadPool);
+	RunRanges(&b2ParticleSystem::ApplyPressuresRange, step, threadPool);
+
+	// Push the particles that were left out, in range order.
+	for (int32 r = 0; r < m_rangeCount; ++r)
+	{
+		const PairRange* range = m_ranges + r;
+		for (int32 i = 0; i < range->spillCount; ++i)
+		{
+			const Spill& spill = range->spills[i];
+			m_velocities[spill.index] += spill.force;
+		}
+	}
+}
+
+// Neighbors share their relative velocity and stop approaching each other.
+// Each pair sees the velocities updated by the pairs before it, so this runs
+// on the calling thread.
+void b2ParticleSystem::SolveViscosity()
+{
+	float32 damping = 0.5f * m_dampingStrength;
+	for (int32 r = 0; r < m_rangeCount; ++r)
+	{
+		const PairRange* range = m_ranges + r;
+		for (int32 i = 0; i < range->pairCount; ++i)
+		{
+			const Pair& pair = range->pairs[i];
+			b2Vec2 dv = m_velocities[pair.indexB] - m_velocities[pair.indexA];
+			b2Vec2 f = (m_viscosityStrength * pair.weight) * dv;
+
+			float32 vn = b2Dot(dv, pair.normal);
+			if (vn < 0.0f)
+			{
+				f += (damping * pair.weight * vn) * pair.normal;
+			}
+
+			m_velocities[pair.indexA] += f;
+			m_velocities[pair.indexB] -= f;
+		}
+	}
+}
+
+// Particles move at most b2_maxTranslation per step, like bodies.
+void b2ParticleSystem::LimitVelocitiesRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	float32 maxSpeed = b2_maxTranslation * step.inv_dt;
+	float32 maxSpeedSquared = maxSpeed * maxSpeed;
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2Vec2 v = m_velocities[i];
+		float32 speedSquared = b2Dot(v, v);
+		if (speedSquared > maxSpeedSquared)
+		{
+			m_velocities[i] = (maxSpeed / b2Sqrt(speedSquared)) * v;
+		}
+	}
+}
+
+void b2ParticleSystem::IntegrateRange(const b2TimeStep& step, int32 begin, int32 end)
+{
+	for (int32 i = begin; i < end; ++i)
+	{
+		m_positions[i] += step.dt * m_velocities[i];
+	}
+}
+
+// A fixture child near the particles.
+struct b2ParticleCandidate
+{
+	b2Fixture* fixture;
+	int32 childIndex;
+	b2AABB aabb;
+};
+
+// A growable array of particle candidates.
+struct b2ParticleCandidateBuffer
+{
+	b2ParticleCandidateBuffer()
+	{
+		candidates = NULL;
+		count = 0;
+		capacity = 0;
+	}
+
+	~b2ParticleCandidateBuffer()
+	{
+		b2Free(candidates);
+	}
+
+	void Push(b2Fixture* fixture, int32 childIndex, const b2AABB& aabb)
+	{
+		if (count == capacity)
+		{
+			capacity = capacity > 0 ? 2 * capacity : 64;
+			candidates = b2ReallocParticleArray(candidates, count, capacity);
+		}
+
+		b2ParticleCandidate* candidate = candidates + count;
+		candidate->fixture = fixture;
+		candidate->childIndex = childIndex;
+		candidate->aabb = aabb;
+		++count;
+	}
+
+	b2ParticleCandidate* candidates;
+	int32 count;
+	int32 capacity;
+};
+
+// Gathers the mesh segments near the particles.
+struct b2ParticleMeshCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		b2AABB aabb;
+		mesh->ComputeSegmentAABB(&aabb, fixture->GetBody()->GetTransform(), index);
+		buffer->Push(fixture, index, aabb);
+		return true;
+	}
+
+	const b2MeshShape* mesh;
+	b2Fixture* fixture;
+	b2ParticleCandidateBuffer* buffer;
+};
+
+// Gathers the fixtures near the particles.
+struct b2ParticleQueryCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		if (fixture->IsSensor())
+		{
+			return true;
+		}
+
+		if (fixture->GetType() == b2Shape::e_mesh)
+		{
+			// Bring the query box into the mesh frame.
+			const b2Transform& xf = fixture->GetBody()->GetTransform();
+			b2Vec2 center = b2MulT(xf, aabb.GetCenter());
+			b2Vec2 h = aabb.GetExtents();
+			b2Vec2 r;
+			r.x = b2Abs(xf.q.c) * h.x + b2Abs(xf.q.s) * h.y;
+			r.y = b2Abs(xf.q.s) * h.x + b2Abs(xf.q.c) * h.y;
+
+			b2AABB localAABB;
+			localAABB.lowerBound = center - r;
+			localAABB.upperBound = center + r;
+
+			b2ParticleMeshCallback meshCallback;
+			meshCallback.mesh = (b2MeshShape*)fixture->GetShape();
+			meshCallback.fixture = fixture;
+			meshCallback.buffer = buffer;
+			meshCallback.mesh->Query(&meshCallback, localAABB);
+			return true;
+		}
+
+		buffer->Push(fixture, proxy->childIndex, fixture->GetAABB(proxy->childIndex));
+		return true;
+	}
+
+	b2BroadPhase* broadPhase;
+	b2AABB aabb;
+	b2ParticleCandidateBuffer* buffer;
+};
+
+// Particles are pushed out of fixtures after the fluid forces are applied.
+// Each fixture child only visits the particles in the cells under its box,
+// found with a binary search on the sorted proxies. Contacts are speculative:
+// a particle that can reach the surface this step may only close the gap,
+// so fast particles don't tunnel. Dynamic bodies receive the opposite impulse.
+void b2ParticleSystem::SolveCollision(const b2TimeStep& step, b2BroadPhase* broadPhase)
+{
+	b2ParticleCandidateBuffer buffer;
+	b2ParticleQueryCallback callback;
+	callback.broadPhase = broadPhase;
+	callback.buffer = &buffer;
+
+	// Cover the particles and their motion over the step.
+	b2AABB& aabb = callback.aabb;
+	aabb.lowerBound.Set(b2_maxFloat, b2_maxFloat);
+	aabb.upperBound.Set(-b2_maxFloat, -b2_maxFloat);
+	float32 maxSpeedSquared = 0.0f;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2Vec2 p = m_positions[i];
+		b2Vec2 v = m_velocities[i];
+		aabb.lowerBound = b2Min(aabb.lowerBound, p);
+		aabb.upperBound = b2Max(aabb.upperBound, p);
+		maxSpeedSquared = b2Max(maxSpeedSquared, b2Dot(v, v));
+	}
+
+	// Particles that can reach a fixture child this step.
+	float32 margin = m_radius + step.dt * b2Sqrt(maxSpeedSquared);
+	b2Vec2 extent(margin, margin);
+	aabb.lowerBound -= extent;
+	aabb.upperBound += extent;
+
+	// Filtered queries skip subtrees that can't collide with the particles.
+	broadPhase->Query(&callback, aabb, m_filter);
+
+	float32 particleMass = m_density * m_diameter * m_diameter;
+
+	for (int32 c = 0; c < buffer.count; ++c)
+	{
+		const b2ParticleCandidate* candidate = buffer.candidates + c;
+		b2Fixture* fixture = candidate->fixture;
+		b2Body* body = fixture->GetBody();
+
+		b2DistanceInput input;
+		input.proxyA.Set(fixture->GetShape(), candidate->childIndex);
+		input.transformA = body->GetTransform();
+		input.transformB.SetIdentity();
+		input.useRadii = false;
+
+		float32 target = input.proxyA.m_radius + m_radius;
+
+		b2Vec2 lower = candidate->aabb.lowerBound - extent;
+		b2Vec2 upper = candidate->aabb.upperBound + extent;
+		int32 lowerX = (int32)floorf(m_inverseDiameter * lower.x);
+		int32 lowerY = (int32)floorf(m_inverseDiameter * lower.y);
+		int32 upperX = (int32)floorf(m_inverseDiameter * upper.x);
+		int32 upperY = (int32)floorf(m_inverseDiameter * upper.y);
+
+		for (int32 y = lowerY; y <= upperY; ++y)
+		{
+			Proxy lowerProxy;
+			lowerProxy.tag = ComputeTag(lowerX, y);
+			uint64 upperTag = ComputeTag(upperX, y);
+
+			const Proxy* proxy = std::lower_bound(m_proxies, m_proxies + m_count, lowerProxy);
+			const Proxy* proxyEnd = m_proxies + m_count;
+			for (; proxy < proxyEnd && proxy->tag <= upperTag; ++proxy)
+			{
+				int32 i = proxy->index;
+				b2Vec2 p = m_positions[i];
+				if (p.x < lower.x || upper.x < p.x || p.y < lower.y || upper.y < p.y)
+				{
+					continue;
+				}
+
+				b2Vec2 v = m_velocities[i];
+				float32 reach = target + step.dt * v.Length() + b2_linearSlop;
+
+				b2DistanceOutput output;
+				b2SimplexCache cache;
+				cache.count = 0;
+				input.proxyB.m_vertices = &p;
+				input.proxyB.m_count = 1;
+				input.proxyB.m_radius = 0.0f;
+				b2Distance(&output, &cache, &input);
+
+				// Particles that reached the core are left alone.
+				if (output.distance > reach || output.distance < b2_epsilon)
+				{
+					continue;
+				}
+
+				b2Vec2 normal = (1.0f / output.distance) * (p - output.pointA);
+				float32 separation = output.distance - target;
+
+				// Allow the particle to close the gap this step, or push it out
+				// no faster than the position solver would.
+				float32 limit;
+				if (separation < 0.0f)
+				{
+					limit = b2Min(-separation, b2_maxLinearCorrection) * step.inv_dt;
+				}
+				else
+				{
+					limit = -separation * step.inv_dt;
+				}
+
+				b2Vec2 vr = v - body->GetLinearVelocityFromWorldPoint(output.pointA);
+				float32 vn = b2Dot(vr, normal);
+				if (vn >= limit)
+				{
+					continue;
+				}
+
+				b2Vec2 dv = (limit - vn) * normal;
+				if (separation < b2_linearSlop)
+				{
+					b2Vec2 vt = vr - vn * normal;
+					dv -= m_friction * vt;
+				}
+
+				m_velocities[i] = v + dv;
+
+				if (body->GetType() == b2_dynamicBody)
+				{
+					body->ApplyLinearImpulse(-particleMass * dv, p, true);
+				}
+			}
+		}
+	}
+}
+
+// The sorted-cell pass, the pressure and the per particle loops run in ranges
+// on the thread pool. Viscosity and collision run on the calling thread.
+void b2ParticleSystem::Solve(const b2TimeStep& step, const b2Vec2& gravity, b2BroadPhase* broadPhase, b2ThreadPool* threadPool)
+{
+	if (m_count == 0 || step.dt == 0.0f)
+	{
+		return;
+	}
+
+	b2Vec2 dv = (step.dt * m_gravityScale) * gravity;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_velocities[i] += dv;
+	}
+
+	UpdatePairs(step, threadPool);
+
+	if (m_pressureStrength > 0.0f)
+	{
+		SolvePressure(step, threadPool);
+	}
+
+	if (m_viscosityStrength > 0.0f || m_dampingStrength > 0.0f)
+	{
+		SolveViscosity();
+	}
+
+	RunRanges(&b2ParticleSystem::LimitVelocitiesRange, step, threadPool);
+
+	SolveCollision(step, broadPhase);
+
+	RunRanges(&b2ParticleSystem::IntegrateRange, step, threadPool);
+}
+
+void b2ParticleSystem::Draw(b2Draw* draw) const
+{
+	b2Color color(0.5f, 0.7f, 1.0f);
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		draw->DrawSolidCircle(m_positions[i], m_radius, b2Vec2(0.0f, 0.0f), color);
+	}
+}
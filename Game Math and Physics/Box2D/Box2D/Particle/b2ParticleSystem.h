@@ -0,0 +1,301 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PARTICLE_SYSTEM_H
+#define B2_PARTICLE_SYSTEM_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Collision/b2Collision.h>
+
+class b2BroadPhase;
+class b2Draw;
+class b2ThreadPool;
+class b2World;
+struct b2TimeStep;
+
+#define b2_nullParticle (-1)
+
+/// A particle system definition holds the properties shared by all particles
+/// of a system.
+struct b2ParticleSystemDef
+{
+	b2ParticleSystemDef()
+	{
+		radius = 0.05f;
+		density = 1.0f;
+		gravityScale = 1.0f;
+		pressureStrength = 0.05f;
+		viscosityStrength = 0.25f;
+		dampingStrength = 0.5f;
+		friction = 0.2f;
+	}
+
+	/// The particle radius. Particles interact with neighbors closer than
+	/// one diameter, so this also sets the spatial hash cell size.
+	float32 radius;
+
+	/// The particle density, usually in kg/m^2. Sets the impulse applied
+	/// to bodies.
+	float32 density;
+
+	/// Scale the world gravity applied to the particles.
+	float32 gravityScale;
+
+	/// Pushes crowded particles apart, which makes the fluid incompressible.
+	/// Values above 0.2 may become unstable.
+	float32 pressureStrength;
+
+	/// Smooths the relative velocity of neighbors, from zero (inviscid) to
+	/// 0.5 (neighbors move together).
+	float32 viscosityStrength;
+
+	/// Removes the approach velocity of neighbors, from zero to one.
+	float32 dampingStrength;
+
+	/// Friction against fixtures, from zero (slippery) to one (sticky).
+	float32 friction;
+
+	/// Contact filtering data against fixtures.
+	b2Filter filter;
+};
+
+/// A particle definition is used to create a particle.
+struct b2ParticleDef
+{
+	b2ParticleDef()
+	{
+		position.SetZero();
+		velocity.SetZero();
+	}
+
+	/// The world position of the particle.
+	b2Vec2 position;
+
+	/// The linear velocity of the particle in world co-ordinates.
+	b2Vec2 velocity;
+};
+
+/// A particle system simulates many small circles, such as water, sand or
+/// debris, without creating bodies. Particle data is stored in flat arrays
+/// that can be read and written directly. Neighbors are found each step by
+/// sorting the particles into a spatial hash. Particles collide with
+/// fixtures and push dynamic bodies, but bodies do not see the particles as
+/// contacts. Particle systems are created by b2World::CreateParticleSystem.
+/// @warning particles are reordered by b2World::Step, so particle indices
+/// are only valid until the next step.
+class b2ParticleSystem
+{
+public:
+
+	/// Create a particle. The particle index is returned, or b2_nullParticle
+	/// if the world is locked.
+	/// @warning This function is locked during callbacks.
+	int32 CreateParticle(const b2ParticleDef& def);
+
+	/// Destroy a particle. The last particle is moved into the freed index.
+	/// @warning This function is locked during callbacks.
+	void DestroyParticle(int32 index);
+
+	/// Get the number of particles.
+	int32 GetParticleCount() const;
+
+	/// Get the particle positions. The array has GetParticleCount elements.
+	b2Vec2* GetPositionBuffer();
+	const b2Vec2* GetPositionBuffer() const;
+
+	/// Get the particle velocities. The array has GetParticleCount elements.
+	b2Vec2* GetVelocityBuffer();
+	const b2Vec2* GetVelocityBuffer() const;
+
+	/// Get the particle radius.
+	float32 GetRadius() const;
+
+	/// Get the number of neighbor pairs found in the last step.
+	int32 GetPairCount() const;
+
+	/// Draw the particles.
+	void Draw(b2Draw* draw) const;
+
+	/// Get the next particle system in the world list.
+	b2ParticleSystem* GetNext();
+	const b2ParticleSystem* GetNext() const;
+
+private:
+
+	friend class b2World;
+
+	// A particle sorted by its spatial hash cell.
+	struct Proxy
+	{
+		uint64 tag;
+		int32 index;
+
+		bool operator<(const Proxy& other) const
+		{
+			return tag < other.tag;
+		}
+	};
+
+	// Two particles closer than one diameter.
+	struct Pair
+	{
+		int32 indexA;
+		int32 indexB;
+		float32 weight;
+		b2Vec2 normal;
+	};
+
+	// A pair whose second particle is in a later range. Its updates of the
+	// second particle are stored and applied after the ranges are solved.
+	struct Spill
+	{
+		int32 index;
+		float32 weight;
+		b2Vec2 force;
+	};
+
+	// The pairs found for a range of particles. The first particle of each
+	// pair is in the range.
+	struct PairRange
+	{
+		Pair* pairs;
+		int32 pairCount;
+		int32 pairCapacity;
+
+		Spill* spills;
+		int32 spillCount;
+		int32 spillCapacity;
+	};
+
+	// Solves the particles in [begin, end).
+	typedef void (b2ParticleSystem::*RangeFunction)(const b2TimeStep& step, int32 begin, int32 end);
+
+	b2ParticleSystem(const b2ParticleSystemDef* def, b2World* world);
+	~b2ParticleSystem();
+
+	void Solve(const b2TimeStep& step, const b2Vec2& gravity, b2BroadPhase* broadPhase, b2ThreadPool* threadPool);
+	void RunRanges(RangeFunction function, const b2TimeStep& step, b2ThreadPool* threadPool);
+
+	void UpdatePairs(const b2TimeStep& step, b2ThreadPool* threadPool);
+	void SolvePressure(const b2TimeStep& step, b2ThreadPool* threadPool);
+	void SolveViscosity();
+	void SolveCollision(const b2TimeStep& step, b2BroadPhase* broadPhase);
+
+	void TagRange(const b2TimeStep& step, int32 begin, int32 end);
+	void ReorderPositionsRange(const b2TimeStep& step, int32 begin, int32 end);
+	void ReorderVelocitiesRange(const b2TimeStep& step, int32 begin, int32 end);
+	void FindPairsRange(const b2TimeStep& step, int32 begin, int32 end);
+	void ComputePressuresRange(const b2TimeStep& step, int32 begin, int32 end);
+	void ApplyPressuresRange(const b2TimeStep& step, int32 begin, int32 end);
+	void LimitVelocitiesRange(const b2TimeStep& step, int32 begin, int32 end);
+	void IntegrateRange(const b2TimeStep& step, int32 begin, int32 end);
+
+	uint64 ComputeTag(float32 x, float32 y) const;
+	static uint64 ComputeTag(int32 cellX, int32 cellY);
+
+	// Copy the particles and settings of another system.
+	void Copy(const b2ParticleSystem* system);
+
+	void Reserve(int32 capacity);
+	void AddPair(PairRange* range, int32 indexA, int32 indexB);
+
+	int32 m_count;
+	int32 m_capacity;
+
+	// Particle arrays
+	b2Vec2* m_positions;
+	b2Vec2* m_velocities;
+	float32* m_weights;
+	float32* m_pressures;
+
+	// Spatial hash, sorted by tag
+	Proxy* m_proxies;
+
+	// Scratch space used to reorder the particles
+	b2Vec2* m_buffer;
+
+	// Neighbor pairs of the current step, stored by particle range
+	PairRange* m_ranges;
+	int32 m_rangeCount;
+	int32 m_rangeCapacity;
+	int32 m_pairCount;
+
+	float32 m_radius;
+	float32 m_diameter;
+	float32 m_inverseDiameter;
+	float32 m_density;
+	float32 m_gravityScale;
+	float32 m_pressureStrength;
+	float32 m_viscosityStrength;
+	float32 m_dampingStrength;
+	float32 m_friction;
+	b2Filter m_filter;
+
+	b2World* m_world;
+
+	// World particle systems
+	b2ParticleSystem* m_prev;
+	b2ParticleSystem* m_next;
+};
+
+inline int32 b2ParticleSystem::GetParticleCount() const
+{
+	return m_count;
+}
+
+inline b2Vec2* b2ParticleSystem::GetPositionBuffer()
+{
+	return m_positions;
+}
+
+inline const b2Vec2* b2ParticleSystem::GetPositionBuffer() const
+{
+	return m_positions;
+}
+
+inline b2Vec2* b2ParticleSystem::GetVelocityBuffer()
+{
+	return m_velocities;
+}
+
+inline const b2Vec2* b2ParticleSystem::GetVelocityBuffer() const
+{
+	return m_velocities;
+}
+
+inline float32 b2ParticleSystem::GetRadius() const
+{
+	return m_radius;
+}
+
+inline int32 b2ParticleSystem::GetPairCount() const
+{
+	return m_pairCount;
+}
+
+inline b2ParticleSystem* b2ParticleSystem::GetNext()
+{
+	return m_next;
+}
+
+inline const b2ParticleSystem* b2ParticleSystem::GetNext() const
+{
+	return m_next;
+}
+
+#endif
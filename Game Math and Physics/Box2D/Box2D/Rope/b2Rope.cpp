@@ -18,6 +18,7 @@
 
 #include <Box2D/Rope/b2Rope.h>
 #include <Box2D/Common/b2Draw.h>
+#include <string.h>
 
 b2Rope::b2Rope()
 {
@@ -31,6 +32,16 @@ b2Rope::b2Rope()
 	m_gravity.SetZero();
 	m_k2 = 1.0f;
 	m_k3 = 0.1f;
+	m_prev = NULL;
+	m_next = NULL;
+	m_bodyA = NULL;
+	m_bodyB = NULL;
+	m_localAnchorA.SetZero();
+	m_localAnchorB.SetZero();
+	m_imA = 0.0f;
+	m_imB = 0.0f;
+	m_radius = 0.0f;
+	m_friction = 0.0f;
 }
 
 b2Rope::~b2Rope()
@@ -43,6 +54,44 @@ b2Rope::~b2Rope()
 	b2Free(m_as);
 }
 
+void b2Rope::Copy(const b2Rope* rope)
+{
+	b2Assert(m_ps == NULL);
+	m_count = rope->m_count;
+	int32 count2 = m_count - 1;
+	int32 count3 = m_count - 2;
+
+	m_ps = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
+	m_p0s = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
+	m_vs = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
+	m_ims = (float32*)b2Alloc(m_count * sizeof(float32));
+	m_Ls = (float32*)b2Alloc(count2 * sizeof(float32));
+	m_as = (float32*)b2Alloc(count3 * sizeof(float32));
+
+	memcpy(m_ps, rope->m_ps, m_count * sizeof(b2Vec2));
+	memcpy(m_p0s, rope->m_p0s, m_count * sizeof(b2Vec2));
+	memcpy(m_vs, rope->m_vs, m_count * sizeof(b2Vec2));
+	memcpy(m_ims, rope->m_ims, m_count * sizeof(float32));
+	memcpy(m_Ls, rope->m_Ls, count2 * sizeof(float32));
+	memcpy(m_as, rope->m_as, count3 * sizeof(float32));
+
+	m_gravity = rope->m_gravity;
+	m_damping = rope->m_damping;
+	m_k2 = rope->m_k2;
+	m_k3 = rope->m_k3;
+
+	m_bodyA = rope->m_bodyA;
+	m_bodyB = rope->m_bodyB;
+	m_localAnchorA = rope->m_localAnchorA;
+	m_localAnchorB = rope->m_localAnchorB;
+	m_imA = rope->m_imA;
+	m_imB = rope->m_imB;
+
+	m_radius = rope->m_radius;
+	m_friction = rope->m_friction;
+	m_filter = rope->m_filter;
+}
+
 void b2Rope::Initialize(const b2RopeDef* def)
 {
 	b2Assert(def->count >= 3);
@@ -100,6 +149,16 @@ void b2Rope::Initialize(const b2RopeDef* def)
 	m_damping = def->damping;
 	m_k2 = def->k2;
 	m_k3 = def->k3;
+
+	m_bodyA = def->bodyA;
+	m_bodyB = def->bodyB;
+	m_localAnchorA = def->localAnchorA;
+	m_localAnchorB = def->localAnchorB;
+	m_imA = m_ims[0];
+	m_imB = m_ims[m_count - 1];
+	m_radius = def->radius;
+	m_friction = def->friction;
+	m_filter = def->filter;
 }
 
 void b2Rope::Step(float32 h, int32 iterations)
@@ -109,6 +168,13 @@ void b2Rope::Step(float32 h, int32 iterations)
 		return;
 	}
 
+	Integrate(h, m_gravity);
+	SolveConstraints(iterations);
+	UpdateVelocities(h);
+}
+
+void b2Rope::Integrate(float32 h, const b2Vec2& gravity)
+{
 	float32 d = expf(- h * m_damping);
 
 	for (int32 i = 0; i < m_count; ++i)
@@ -116,20 +182,26 @@ void b2Rope::Step(float32 h, int32 iterations)
 		m_p0s[i] = m_ps[i];
 		if (m_ims[i] > 0.0f)
 		{
-			m_vs[i] += h * m_gravity;
+			m_vs[i] += h * gravity;
 		}
 		m_vs[i] *= d;
 		m_ps[i] += h * m_vs[i];
 
 	}
+}
 
+void b2Rope::SolveConstraints(int32 iterations)
+{
 	for (int32 i = 0; i < iterations; ++i)
 	{
 		SolveC2();
 		SolveC3();
 		SolveC2();
 	}
+}
 
+void b2Rope::UpdateVelocities(float32 h)
+{
 	float32 inv_h = 1.0f / h;
 	for (int32 i = 0; i < m_count; ++i)
 	{
@@ -20,7 +20,9 @@
 #define B2_ROPE_H
 
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2Fixture.h>
 
+class b2Body;
 class b2Draw;
 
 /// 
@@ -35,6 +37,12 @@ struct b2RopeDef
 		damping = 0.1f;
 		k2 = 0.9f;
 		k3 = 0.1f;
+		bodyA = NULL;
+		localAnchorA.SetZero();
+		bodyB = NULL;
+		localAnchorB.SetZero();
+		radius = 0.0f;
+		friction = 0.2f;
 	}
 
 	///
@@ -57,6 +65,30 @@ struct b2RopeDef
 
 	/// Bending stiffness. Values above 0.5 can make the simulation blow up.
 	float32 k3;
+
+	/// The body the first vertex is pinned to, or NULL for a free end.
+	/// Only used by b2World::CreateRope.
+	b2Body* bodyA;
+
+	/// The local anchor point relative to bodyA's origin.
+	b2Vec2 localAnchorA;
+
+	/// The body the last vertex is pinned to, or NULL for a free end.
+	/// Only used by b2World::CreateRope.
+	b2Body* bodyB;
+
+	/// The local anchor point relative to bodyB's origin.
+	b2Vec2 localAnchorB;
+
+	/// The thickness of the rope. Ropes owned by a world collide with
+	/// fixtures when this is positive.
+	float32 radius;
+
+	/// Friction against fixtures, from zero (slippery) to one (sticky).
+	float32 friction;
+
+	/// Contact filtering data against fixtures.
+	b2Filter filter;
 };
 
 /// 
@@ -90,8 +122,28 @@ public:
 	///
 	void SetAngle(float32 angle);
 
+	/// Get the next rope in the world rope list.
+	b2Rope* GetNext();
+	const b2Rope* GetNext() const;
+
+	/// Get the body the first vertex is pinned to, if any.
+	b2Body* GetBodyA();
+
+	/// Get the body the last vertex is pinned to, if any.
+	b2Body* GetBodyB();
+
 private:
 
+	friend class b2World;
+
+	// Copy the vertices and settings of another rope. The pinned bodies are
+	// copied as is.
+	void Copy(const b2Rope* rope);
+
+	void Integrate(float32 h, const b2Vec2& gravity);
+	void SolveConstraints(int32 iterations);
+	void UpdateVelocities(float32 h);
+
 	void SolveC2();
 	void SolveC3();
 
@@ -110,6 +162,42 @@ private:
 
 	float32 m_k2;
 	float32 m_k3;
+
+	// World ropes
+	b2Rope* m_prev;
+	b2Rope* m_next;
+
+	b2Body* m_bodyA;
+	b2Body* m_bodyB;
+	b2Vec2 m_localAnchorA;
+	b2Vec2 m_localAnchorB;
+
+	// Inverse masses of the end vertices, restored when a body goes away.
+	float32 m_imA, m_imB;
+
+	float32 m_radius;
+	float32 m_friction;
+	b2Filter m_filter;
 };
 
+inline b2Rope* b2Rope::GetNext()
+{
+	return m_next;
+}
+
+inline const b2Rope* b2Rope::GetNext() const
+{
+	return m_next;
+}
+
+inline b2Body* b2Rope::GetBodyA()
+{
+	return m_bodyA;
+}
+
+inline b2Body* b2Rope::GetBodyB()
+{
+	return m_bodyB;
+}
+
 #endif
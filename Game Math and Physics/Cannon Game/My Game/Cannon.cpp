@@ -324,6 +324,41 @@ BOOL CCannon::Fire(){
   return FALSE;
 } //Fire
 
+/// Predict the path that a cannonball would take if the cannon were fired now.
+/// The cannonball is set up the same way as in Fire(), and its path is
+/// followed until it hits something or runs out of points.
+/// \param points Array in which to store the path in Physics World units.
+/// \param n Size of the points array.
+/// \return Number of points stored.
+
+int CCannon::PredictShot(b2Vec2* points, int n){
+  if(m_bExploded || m_pBarrel == nullptr || n < 2)return 0;
+  const int w = g_cRenderWorld.GetWidth(BALL_OBJECT); //cannonball diameter
+
+  //shape
+  b2CircleShape s;
+  s.m_radius = RW2PW(w)/2.0f;
+
+  //the impulse in Fire() gives the ball this velocity
+  b2MassData md;
+  s.ComputeMass(&md, 0.5f);
+  b2Vec2 vImpulse = b2Mul(b2Rot(m_pBarrel->GetAngle()), b2Vec2(200, 0));
+
+  //hypothetical cannonball
+  b2TrajectoryInput in;
+  in.shape = &s;
+  in.position = m_pBarrel->GetPosition() +
+    b2Mul(b2Rot(m_pBarrel->GetAngle()), b2Vec2(RW2PW(70),0));
+  in.linearVelocity = (1.0f/md.mass) * vImpulse;
+  in.ignoreBody = m_pBarrel;
+  in.stepCount = n - 1;
+
+  b2TrajectoryOutput out;
+  out.points = points;
+  g_b2dPhysicsWorld.PredictTrajectory(in, &out);
+  return out.pointCount;
+} //PredictShot
+
 /// Return the number of cannonballs fired in this level of the game.
 /// \return Number of cannonballs fired.
 
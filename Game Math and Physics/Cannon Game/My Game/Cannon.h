@@ -58,6 +58,7 @@ class CCannon{
 
     //user control over cannon
     BOOL Fire(); ///< Fire the cannon.
+    int PredictShot(b2Vec2* points, int n); ///< Predict the path of the next cannonball.
     void BarrelUp(float a); ///< Rotate the cannon barrel.
     void StartMovingLeft(float speed); ///< Start the cannon moving.
 
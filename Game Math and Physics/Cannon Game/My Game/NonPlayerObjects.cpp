@@ -28,7 +28,7 @@ extern CRenderWorld g_cRenderWorld;
 extern CObjectWorld g_cObjectWorld;
 
 /// Create world edges in Physics World.
-/// Place Box2D edge shapes in the Physics World in places that correspond to the
+/// Place a Box2D mesh shape in the Physics World in places that correspond to the
 /// top, bottom, right, and left edges of the screen in Render World, and a
 /// ledge for the cannon to sit upon. The left and  right edges continue upwards
 /// for a distance. There is no top to the world.
@@ -44,47 +44,25 @@ void CreateWorldEdges(){
   const b2Vec2 vTopLeft = b2Vec2(0, h);
   const b2Vec2 vTopRight = b2Vec2(w, h);
 
-  //Box2D ground
-  b2BodyDef bd;
-  b2Body* edge = g_b2dPhysicsWorld.CreateBody(&bd);
-  b2EdgeShape shape;  
-  shape.Set(vBottomLeft, vBottomRight);
-  edge->CreateFixture(&shape, 0);
+  const float lh = RW2PW(62); //ledge height
 
-  //Box2D left edge of screen
-  shape.Set(vBottomLeft, vTopLeft);
-  edge->CreateFixture(&shape, 0);
+  //Box2D ground, left and right edges of screen, and ledge in a single mesh
+  const b2Vec2 vertices[] = {
+    vTopLeft, vBottomLeft, vBottomRight, vTopRight,
+    b2Vec2(0, lh), b2Vec2(w/2, lh)
+  };
 
-  //Box2D right edge of screen
-  shape.Set(vBottomRight, vTopRight);
-  edge->CreateFixture(&shape, 0); 
+  const int32 indices[] = {0, 1,  1, 2,  2, 3,  4, 5};
 
-  //ledge
-  const float lh = RW2PW(62); //ledge height
-  shape.Set(b2Vec2(0, lh), b2Vec2(w/2, lh));
+  b2BodyDef bd;
+  b2Body* edge = g_b2dPhysicsWorld.CreateBody(&bd);
+  b2MeshShape shape;
+  shape.Create(vertices, 6, indices, 4);
   edge->CreateFixture(&shape, 0);
 } //CreateWorldEdges
 
-/// Place a crate in Physics World and Object World.
-/// \param x Horizontal coordinate in Physics World units.
-/// \param y  Vertical coordinate in Physics World units.
-/// \param fd Crate fixture definition.
-
-void PlaceCrate(float x, float y, const b2FixtureDef& fd){  
-  //Object World
-  CObject* pObj = g_cObjectWorld.create(CRATE_OBJECT);
-
-  //Physics World
-  b2BodyDef bd; //Physics World body definition
-  bd.type = b2_dynamicBody;
-  bd.position.Set(x, y);
-
-  b2Body* p = g_b2dPhysicsWorld.CreateBody(&bd);
-  pObj->SetPhysicsBody(p); //tell object world body about physics world body
-  p->CreateFixture(&fd);
-} //PlaceCrate
-
 /// Create a tower of crates at the default location.
+/// The crates are created in Physics World in a single batch.
 
 void CreateTower(){
   float w, h; //Object World width and height of world
@@ -97,7 +75,7 @@ void CreateTower(){
   const float ch2 = RW2PW(ch - 4.0f)/2.0f; //crate half height in Physics World
 
   //Box2D crate shape and fixture
-  b2PolygonShape s;
+  b2BoxShape s;
   s.SetAsBox(cw2, ch2);
 
   b2FixtureDef fd;
@@ -105,16 +83,37 @@ void CreateTower(){
   fd.density = 1.0f;
   fd.restitution = 0.3f;
 
+  //Physics World body definitions, one per crate
+  const int MAXCRATES = 18; //crates in a 12 layer tower
+  b2BodyDef bd[MAXCRATES];
+  b2FixtureDef fds[MAXCRATES];
+  int n = 0; //number of crates
+
   //build tower
   for(int i=0; i<12; i++){
     float x = RW2PW(0.7f*w);
     float y = ch2 + 2.0f*ch2*i;
     if(i&1) //single block at odd-numbered layers   
-      PlaceCrate(x + cw2, y, fd);
+      bd[n++].position.Set(x + cw2, y);
     else{ //pair of blocks at even-numbered layers
       const float d = RW2PW(2);
-      PlaceCrate(x - d, y, fd);
-      PlaceCrate(x + 2.0f*cw2 + d, y, fd);
+      bd[n++].position.Set(x - d, y);
+      bd[n++].position.Set(x + 2.0f*cw2 + d, y);
     } //else
   } //for
+
+  for(int i=0; i<n; i++){
+    bd[i].type = b2_dynamicBody;
+    fds[i] = fd;
+  } //for
+
+  //Physics World
+  b2Body* bodies[MAXCRATES];
+  g_b2dPhysicsWorld.CreateBodies(bd, n, bodies, fds);
+
+  //Object World
+  for(int i=0; i<n; i++){
+    CObject* pObj = g_cObjectWorld.create(CRATE_OBJECT);
+    pObj->SetPhysicsBody(bodies[i]); //tell object world body about physics world body
+  } //for
 } //CreateTower
\ No newline at end of file
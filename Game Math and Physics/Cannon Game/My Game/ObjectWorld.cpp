@@ -84,12 +84,18 @@ BOOL CObjectWorld::PlayerHasWon(float level){
   return result;
 } //PlayerHasWon
 
-/// Clear objects.
+/// Clear objects. Physics World is reset in one shot instead of
+/// destroying the bodies one at a time, which also removes the world
+/// edges and the cannon.
 
 void CObjectWorld::clear(){
-  for(auto i=m_stdList.begin(); i!=m_stdList.end(); i++)
+  for(auto i=m_stdList.begin(); i!=m_stdList.end(); i++){
+    (*i)->m_pBody = nullptr; //Physics World reset below takes care of it
     delete *i;
+  } //for
   m_stdList.clear();
+
+  g_b2dPhysicsWorld.Clear();
 } //clear
 
 /// Draw the game objects, then the HUD in that order using Painter's Algorithm.
@@ -104,6 +110,14 @@ void CObjectWorld::draw(){
     g_cRenderWorld.draw(p->m_nObjectType, v3, a);
   } //for
 
+  //draw the predicted path of the next cannonball as small balls
+  b2Vec2 path[121];
+  const int n = m_cCannon.PredictShot(path, 121);
+  for(int i=4; i<n; i+=4){
+    Vector3 v3 = Vector3(PW2RW(path[i].x), PW2RW(path[i].y), (float)depth--);
+    g_cRenderWorld.draw(BALL_OBJECT, v3, 0, 0.3f, 0.3f);
+  } //for
+
   m_pHeadsUpDisplay->draw( //draw HUD on top of that
     g_cTimer.GetLevelElapsedTime()/1000, //time
     m_cCannon.m_fTemp, m_cCannon.m_fMaxTemp); //temperature
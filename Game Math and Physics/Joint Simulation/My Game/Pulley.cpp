@@ -23,16 +23,6 @@ extern b2World g_b2dPhysicsWorld;
 extern CObjectWorld g_cObjectWorld;
 extern CRenderWorld g_cRenderWorld;
 
-/// \brief Set the orientation of a b2Body.
-/// Set the angle of a b2Body using the SetTransform function,
-/// because b2Body apparently no longer has a SetAngle function.
-/// \param p Pointer to a b2Body.
-/// \param a An angle in radians.
-
-void b2SetAngle(b2Body* p, const float a){
-  p->SetTransform(p->GetPosition(), a);
-} //b2SetAngle
-
 /// \param x X coordinate in Physics World units.
 /// \param y Y coordinate in Physics World units.
 /// \param w Pulley wheel horizontal separation in Physics World units.
@@ -194,8 +184,8 @@ b2Body* CPulley::CreateCrate(float x, float y){
   float ch = RW2PW(g_cRenderWorld.GetHeight(CRATE_OBJECT))/2.0f; //crate half height 
   const float sh = RW2PW(17)/2.0f; //half height of crate floor
 
-  b2PolygonShape s; //shape for crate floor fixture
-  s.SetAsBox(cw, sh, b2Vec2(0.0f, sh - ch), 0.0f); //align with bottom of sprite
+  b2BoxShape s; //shape for crate floor fixture
+  s.SetAsBox(cw, sh, b2Vec2(0.0f, sh - ch)); //align with bottom of sprite
 
   b2FixtureDef fd; 
   fd.shape = &s;
@@ -225,7 +215,7 @@ b2Body* CPulley::CreateObject(float x, float y, float d, ObjectType t){
   bd.position.Set(x, y);
 
   //shape
-  b2PolygonShape shape;
+  b2BoxShape shape;
   shape.SetAsBox(RW2PW(w)/2.0f, RW2PW(h)/2.0f);
 
   //fixture
@@ -249,11 +239,21 @@ void CPulley::move(){
   const float theta = (fLenA - m_fJointLenA)/m_fWheelRad; //new wheel orientation
   const float theta2 = (fLenA - m_fJointLenA) / m_fWheel2Rad; //new wheel orientation
 
-  b2SetAngle(m_pWheel0, theta); //left wheel
-  b2SetAngle(m_pWheel1, theta2 + 2.4f); //right wheel is offset so it is oriented differently
-  b2SetAngle(m_pWheel2, -(theta2 + 2.4f)); //right wheel is offset so it is oriented differently
-  b2SetAngle(m_pWheel3, theta2 + 2.4f); //right wheel is offset so it is oriented differently
-  b2SetAngle(m_pWheel4, theta2 + 2.4f); //right wheel is offset so it is oriented differently
+  b2Body* pWheels[5] = {m_pWheel0, m_pWheel1, m_pWheel2, m_pWheel3, m_pWheel4};
+  const float angles[5] = {
+    theta, //left wheel
+    theta2 + 2.4f, //right wheels are offset so they are oriented differently
+    -(theta2 + 2.4f),
+    theta2 + 2.4f,
+    theta2 + 2.4f
+  };
+
+  //set the wheel orientations in Physics World in one batch
+  float transforms[15]; //x, y, and angle for each wheel
+  g_b2dPhysicsWorld.GetTransforms(pWheels, 5, transforms);
+  for(int i=0; i<5; i++)
+    transforms[3*i + 2] = angles[i];
+  g_b2dPhysicsWorld.SetTransforms(pWheels, transforms, 5);
 } //move
 
 /// Make the elephant disappear or reappear. Uses m_bElephant
@@ -30,7 +30,7 @@ extern CObjectWorld g_cObjectWorld;
 extern CRenderWorld g_cRenderWorld;
 
 /// Create world edges in Physics World.
-/// Place Box2D edge shapes in the Physics World in places that correspond to the
+/// Place a Box2D mesh shape in the Physics World in places that correspond to the
 /// top, bottom, right, and left edges of the screen in Render World. The left and
 /// right edges continue upwards for a distance. There is no top to the world.
 
@@ -45,20 +45,14 @@ void CreateWorldEdges(){
   const b2Vec2 vTopLeft = b2Vec2(0, h);
   const b2Vec2 vTopRight = b2Vec2(w, h);
 
-  //Box2D ground
+  //Box2D ground, left and right edges of screen in a single mesh
+  const b2Vec2 vertices[] = {vTopLeft, vBottomLeft, vBottomRight, vTopRight};
+
   b2BodyDef bd;
-	b2Body* edge = g_b2dPhysicsWorld.CreateBody(&bd);
-  b2EdgeShape shape;
-	shape.Set(vBottomLeft, vBottomRight);
-	edge->CreateFixture(&shape, 0);
-
-  //Box2D left edge of screen
-  shape.Set(vBottomLeft, vTopLeft);
-	edge->CreateFixture(&shape, 0);
-
-  //Box2D right edge of screen
-  shape.Set(vBottomRight, vTopRight);
-	edge->CreateFixture(&shape, 0); 
+  b2Body* edge = g_b2dPhysicsWorld.CreateBody(&bd);
+  b2MeshShape shape;
+  shape.CreateChain(vertices, 4);
+  edge->CreateFixture(&shape, 0);
 } //CreateWorldEdges
 
 /// Place a crate in Physics World and Object World.
@@ -76,7 +70,7 @@ void CreateCrate(float x, float y){
   //shape
   int w, h; //crate width and height in Render World
   g_cRenderWorld.GetSize(w, h, CRATE_OBJECT);
-  b2PolygonShape s;
+  b2BoxShape s;
   s.SetAsBox(RW2PW(w)/2.0f, RW2PW(h)/2.0f);
 
   //fixture